@@ -0,0 +1,10 @@
+#version 330 core
+
+out vec4 FragColor;
+
+void main()
+{
+    // blended additively, red goes up by exactly 8 (of 255) per fragment
+    // so the count can be read back
+    FragColor = vec4(8.0 / 255.0, 4.0 / 255.0, 2.0 / 255.0, 1.0);
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #version 330 core
 
+// compiled without any of these a draw doesn't need (see Shader::Feature)
+#pragma keywords DIFFUSE_TEX SPECULAR_TEX SUN POINT_LIGHTS FOG
+
 out vec4 FragColor;
 
 in vec2 texCoords;
@@ -9,9 +12,15 @@ in vec3 normal;
 
 uniform sampler2D diffuseTex;
 uniform sampler2D specularTex;
+#ifdef INDIRECT
+flat in vec3 diffuseColor;
+flat in vec3 specularColor;
+flat in float shininess;
+#else
 uniform vec3 diffuseColor;
 uniform vec3 specularColor;
 uniform float shininess;
+#endif
 
 // fog parameters
 in float depth; 
@@ -24,56 +33,83 @@ uniform float ambientIntensity;
 
 uniform vec3 cameraPos;
 
-struct PointLight {
-    vec3 pos;
-
-    float linAttenuate;
-    float quadAttenuate;
-
-    vec3 color;
-};
 struct DirectionalLight {
     vec3 dir;
     vec3 color;
 };
-uniform PointLight lights[16];
 uniform DirectionalLight sun;
-uniform sampler2DShadow sunShadow;
-in vec4 sunSpacePos;
+// cascaded shadow maps (see scene/shadowCascades.h)
+uniform sampler2DArrayShadow sunShadow;
+uniform mat4 sunViewProjection[4];
+uniform vec4 cascadeSplits;    // far distance of each cascade
+uniform vec4 cascadeTexelSize; // world size of a shadow texel in each cascade
+uniform int cascadeCount;
+
+// clustered point lights (see scene/lightClusters.h)
+// lightData: 2 texels per light, (pos, linear attenuation) (color, quadratic attenuation)
+// lightGrid: per cluster (offset, count) into lightIndices
+uniform samplerBuffer lightData;
+uniform usamplerBuffer lightGrid;
+uniform usamplerBuffer lightIndices;
+uniform uvec3 clusterDims;
+uniform vec2 screenSize;
+uniform float clusterScale;
+uniform float clusterBias;
 
 void main()
 {
-    // material diffuse and specular color (branchless)
-    vec3 dColor = diffuseColor + texture(diffuseTex, texCoords).rgb;
-    vec3 sColor = specularColor + texture(specularTex, texCoords).rgb;
+    // material diffuse and specular color (branchless), an unbound
+    // texture reads 0 so the variants without one just skip the fetch
+    vec3 dColor = diffuseColor;
+    vec3 sColor = specularColor;
+#ifdef DIFFUSE_TEX
+    dColor += texture(diffuseTex, texCoords).rgb;
+#endif
+#ifdef SPECULAR_TEX
+    sColor += texture(specularTex, texCoords).rgb;
+#endif
 
     vec3 ambient = ambientColor * ambientIntensity * dColor;
     vec3 finalColor = ambient;
     vec3 viewDirection = normalize(cameraPos - cPos);
 
-    // calculate all point lights
-    for (int i = 0; i < 16; i++)
+#ifdef POINT_LIGHTS
+    // find the cluster this fragment is in
+    uvec3 cluster = uvec3(
+        uvec2(gl_FragCoord.xy / screenSize * vec2(clusterDims.xy)),
+        uint(max(log(depth) * clusterScale + clusterBias, 0.0))
+    );
+    cluster = min(cluster, clusterDims - 1u);
+    uvec2 lightList = texelFetch(lightGrid, int(cluster.x + clusterDims.x * (cluster.y + clusterDims.y * cluster.z))).xy;
+
+    // calculate the point lights that reach this cluster
+    for (uint i = 0u; i < lightList.y; i++)
     {
-        vec3 lightDirection = normalize(lights[i].pos - cPos);
+        int light = int(texelFetch(lightIndices, int(lightList.x + i)).r);
+        vec4 posLinear = texelFetch(lightData, light * 2);
+        vec4 colorQuad = texelFetch(lightData, light * 2 + 1);
+        vec3 lightDirection = normalize(posLinear.xyz - cPos);
 
         // calculate diffuse and specular coefficients
         float diffuseCoefficient = max(dot(normal, lightDirection), 0);
         float specularCoefficient = pow(max(dot(viewDirection, reflect(-lightDirection, normal)), 0),shininess);
 
         // calculate diffuse and specular lighting
-        vec3 diffuse = lights[i].color * diffuseCoefficient * dColor;
-        vec3 specular = lights[i].color * specularCoefficient * sColor;
+        vec3 diffuse = colorQuad.rgb * diffuseCoefficient * dColor;
+        vec3 specular = colorQuad.rgb * specularCoefficient * sColor;
 
         // attenuation (combine linear and quadratic branchless)
-        float dist = length(lights[i].pos - cPos);
-        float attenuation = 1.0 / (1 + lights[i].linAttenuate * dist + lights[i].quadAttenuate * pow(dist, 2));
+        float dist = length(posLinear.xyz - cPos);
+        float attenuation = 1.0 / (1 + posLinear.w * dist + colorQuad.w * pow(dist, 2));
         diffuse *= attenuation;
         specular *= attenuation;
         
         // combine into finalColor
         finalColor += diffuse + specular;
     }
+#endif
 
+#ifdef SUN
     // calculate the one directional light (sun)
     if (vec3(sun.color) != vec3(0.0f, 0.0f, 0.0f))
     {
@@ -84,17 +120,26 @@ void main()
         vec3 sunDiffuse = sun.color * sunDiffuseCoefficient * dColor;
         vec3 sunSpecular = sun.color * sunSpecularCoefficient * sColor;
 
-        // calculate shadows
+        // calculate shadows, using the cascade this fragment's depth falls in
+        int cascade = 0;
+        for (int i = 0; i < cascadeCount - 1; ++i)
+            if (depth > cascadeSplits[i])
+                cascade = i + 1;
+        // push the lookup out along the normal by about a texel to avoid acne
+        vec3 shadowPos = cPos + normalize(normal) * cascadeTexelSize[cascade] * 1.5;
+        vec4 sunSpacePos = sunViewProjection[cascade] * vec4(shadowPos, 1.0f);
         vec3 sunProjection = sunSpacePos.xyz / sunSpacePos.w; // perspective divide
         sunProjection = sunProjection * 0.5 + 0.5;
-        float bias = max(0.001 * (1.0 - dot(normal, sunDirection)), 0.001);
-        float shadowCoefficient = texture(sunShadow, vec3(sunProjection.xy, sunProjection.z - bias));
+        float shadowCoefficient = texture(sunShadow, vec4(sunProjection.xy, cascade, sunProjection.z - 0.0005));
 
         finalColor += shadowCoefficient * (sunDiffuse + sunSpecular);
     }
+#endif
 
+#ifdef FOG
     // "fog"
     finalColor = mix(finalColor, backgroundColor, smoothstep(farPlane-fogOffset,farPlane,depth));
+#endif
 
     FragColor = vec4(finalColor, 1.0);
 }
\ No newline at end of file
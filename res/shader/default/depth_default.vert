@@ -2,10 +2,36 @@
 
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 sunViewProjection;
+uniform mat4 lightViewProjection; // or the camera's, for the depth pre-pass
+
+// same maths as the forward shaders, the pre-pass has to match them exactly
+invariant gl_Position;
+
+#ifdef INDIRECT
+// multi-draw indirect (see scene/indirectDraws.h), the model matrix and
+// material come out of the instance buffer, baseInstance picks the record
+layout (location = 3) in float aDrawIndex;
+struct Instance {
+    mat4 model;
+    mat4 normalMat;
+    vec4 diffuse;  // rgb, shininess
+    vec4 specular;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uvec4 draw;
+};
+layout (std430, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+#else
 uniform mat4 model;
+#endif
 
 void main()
 {
-    gl_Position = sunViewProjection * model * vec4(aPos, 1.0);
+#ifdef INDIRECT
+    mat4 model = instances[int(aDrawIndex)].model;
+#endif
+    vec3 cPos = vec3(model * vec4(aPos, 1.0f));
+    gl_Position = lightViewProjection * vec4(cPos, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec2 texCoords;
+out vec3 normal;
+
+uniform mat4 cameraMat;
+
+#ifdef INDIRECT
+// multi-draw indirect (see scene/indirectDraws.h), the model matrix and
+// material come out of the instance buffer, baseInstance picks the record
+layout (location = 3) in float aDrawIndex;
+struct Instance {
+    mat4 model;
+    mat4 normalMat;
+    vec4 diffuse;  // rgb, shininess
+    vec4 specular;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uvec4 draw;
+};
+layout (std430, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+flat out vec3 diffuseColor;
+flat out vec3 specularColor;
+flat out float shininess;
+#else
+uniform mat4 model;
+uniform mat3 normalMat;
+#endif
+
+void main()
+{
+#ifdef INDIRECT
+    Instance instance = instances[int(aDrawIndex)];
+    mat4 model = instance.model;
+    mat3 normalMat = mat3(instance.normalMat);
+    diffuseColor = instance.diffuse.rgb;
+    shininess = instance.diffuse.a;
+    specularColor = instance.specular.rgb;
+#endif
+    vec3 cPos = vec3(model * vec4(aPos, 1.0f));
+    gl_Position = cameraMat * vec4(cPos, 1.0f);
+    normal = normalize(normalMat * aNormal);
+    texCoords = aTexCoords;
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#version 330 core
+
+// deferred lighting pass, same lighting as the default shader but
+// reading the material from the g-buffer so every pixel is lit once
+
+// lights the scene doesn't have are compiled out (see Shader::Feature)
+#pragma keywords SUN POINT_LIGHTS
+
+out vec4 FragColor;
+
+in vec2 screenCoords;
+
+// g-buffer
+uniform sampler2D gAlbedo;
+uniform sampler2D gSpecular;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+uniform mat4 inverseCameraMat;
+
+// fog parameters
+uniform mat4 view;
+uniform vec3 backgroundColor;
+uniform float farPlane;
+uniform float fogOffset;
+
+uniform vec3 ambientColor;
+uniform float ambientIntensity;
+
+uniform vec3 cameraPos;
+
+struct DirectionalLight {
+    vec3 dir;
+    vec3 color;
+};
+uniform DirectionalLight sun;
+// cascaded shadow maps (see scene/shadowCascades.h)
+uniform sampler2DArrayShadow sunShadow;
+uniform mat4 sunViewProjection[4];
+uniform vec4 cascadeSplits;    // far distance of each cascade
+uniform vec4 cascadeTexelSize; // world size of a shadow texel in each cascade
+uniform int cascadeCount;
+
+// clustered point lights (see scene/lightClusters.h)
+uniform samplerBuffer lightData;
+uniform usamplerBuffer lightGrid;
+uniform usamplerBuffer lightIndices;
+uniform uvec3 clusterDims;
+uniform vec2 screenSize;
+uniform float clusterScale;
+uniform float clusterBias;
+
+void main()
+{
+    float zBuffer = texture(gDepth, screenCoords).r;
+    if (zBuffer == 1.0)
+        discard; // nothing drawn here, keep the clear color
+
+    // rebuild world position from depth
+    vec4 ndc = vec4(screenCoords * 2.0 - 1.0, zBuffer * 2.0 - 1.0, 1.0);
+    vec4 world = inverseCameraMat * ndc;
+    vec3 cPos = world.xyz / world.w;
+    float depth = -(view * vec4(cPos, 1.0f)).z;
+
+    vec3 dColor = texture(gAlbedo, screenCoords).rgb;
+    vec4 specularShininess = texture(gSpecular, screenCoords);
+    vec3 sColor = specularShininess.rgb;
+    float shininess = specularShininess.a;
+    vec3 normal = texture(gNormal, screenCoords).xyz;
+
+    vec3 ambient = ambientColor * ambientIntensity * dColor;
+    vec3 finalColor = ambient;
+    vec3 viewDirection = normalize(cameraPos - cPos);
+
+#ifdef POINT_LIGHTS
+    // find the cluster this pixel is in, the light lists are bounded by
+    // each light's range so only lights whose volume reaches it are shaded
+    uvec3 cluster = uvec3(
+        uvec2(gl_FragCoord.xy / screenSize * vec2(clusterDims.xy)),
+        uint(max(log(depth) * clusterScale + clusterBias, 0.0))
+    );
+    cluster = min(cluster, clusterDims - 1u);
+    uvec2 lightList = texelFetch(lightGrid, int(cluster.x + clusterDims.x * (cluster.y + clusterDims.y * cluster.z))).xy;
+
+    for (uint i = 0u; i < lightList.y; i++)
+    {
+        int light = int(texelFetch(lightIndices, int(lightList.x + i)).r);
+        vec4 posLinear = texelFetch(lightData, light * 2);
+        vec4 colorQuad = texelFetch(lightData, light * 2 + 1);
+        vec3 lightDirection = normalize(posLinear.xyz - cPos);
+
+        // calculate diffuse and specular coefficients
+        float diffuseCoefficient = max(dot(normal, lightDirection), 0);
+        float specularCoefficient = pow(max(dot(viewDirection, reflect(-lightDirection, normal)), 0),shininess);
+
+        // calculate diffuse and specular lighting
+        vec3 diffuse = colorQuad.rgb * diffuseCoefficient * dColor;
+        vec3 specular = colorQuad.rgb * specularCoefficient * sColor;
+
+        // attenuation (combine linear and quadratic branchless)
+        float dist = length(posLinear.xyz - cPos);
+        float attenuation = 1.0 / (1 + posLinear.w * dist + colorQuad.w * pow(dist, 2));
+        diffuse *= attenuation;
+        specular *= attenuation;
+
+        // combine into finalColor
+        finalColor += diffuse + specular;
+    }
+#endif
+
+#ifdef SUN
+    // calculate the one directional light (sun)
+    if (vec3(sun.color) != vec3(0.0f, 0.0f, 0.0f))
+    {
+        // calculate diffuse + specular
+        vec3 sunDirection = normalize(-sun.dir);
+        float sunDiffuseCoefficient = max(dot(normal, sunDirection), 0);
+        float sunSpecularCoefficient = pow(max(dot(viewDirection, reflect(-sunDirection, normal)), 0),shininess);
+        vec3 sunDiffuse = sun.color * sunDiffuseCoefficient * dColor;
+        vec3 sunSpecular = sun.color * sunSpecularCoefficient * sColor;
+
+        // calculate shadows, using the cascade this fragment's depth falls in
+        int cascade = 0;
+        for (int i = 0; i < cascadeCount - 1; ++i)
+            if (depth > cascadeSplits[i])
+                cascade = i + 1;
+        // push the lookup out along the normal by about a texel to avoid acne
+        vec3 shadowPos = cPos + normalize(normal) * cascadeTexelSize[cascade] * 1.5;
+        vec4 sunSpacePos = sunViewProjection[cascade] * vec4(shadowPos, 1.0f);
+        vec3 sunProjection = sunSpacePos.xyz / sunSpacePos.w; // perspective divide
+        sunProjection = sunProjection * 0.5 + 0.5;
+        float shadowCoefficient = texture(sunShadow, vec4(sunProjection.xy, cascade, sunProjection.z - 0.0005));
+
+        finalColor += shadowCoefficient * (sunDiffuse + sunSpecular);
+    }
+#endif
+
+    // "fog"
+    finalColor = mix(finalColor, backgroundColor, smoothstep(farPlane-fogOffset,farPlane,depth));
+
+    FragColor = vec4(finalColor, 1.0);
+    gl_FragDepth = zBuffer;
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #version 330 core
 
+// unlit, only the texture can go (see Shader::Feature)
+#pragma keywords DIFFUSE_TEX
+
 out vec4 FragColor;
 
 in vec2 texCoords;
@@ -24,28 +27,21 @@ uniform float ambientIntensity;
 
 uniform vec3 cameraPos;
 
-struct PointLight {
-    vec3 pos;
-
-    float linAttenuate;
-    float quadAttenuate;
-
-    vec3 color;
-};
 struct DirectionalLight {
     vec3 dir;
     vec3 color;
 };
-uniform PointLight lights[16];
 uniform DirectionalLight sun;
-uniform sampler2DShadow sunShadow;
-in vec4 sunSpacePos;
+uniform sampler2DArrayShadow sunShadow;
 
 uniform float time;
 
 void main()
 {
     // material diffuse and specular color (branchless)
-    vec3 dColor = diffuseColor + texture(diffuseTex, texCoords).rgb;
+    vec3 dColor = diffuseColor;
+#ifdef DIFFUSE_TEX
+    dColor += texture(diffuseTex, texCoords).rgb;
+#endif
     FragColor = vec4(mix(dColor, vec3(1.0,1.0,1.0), sin(time * 10)), 1.0);
 }
\ No newline at end of file
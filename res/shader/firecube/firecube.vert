@@ -7,21 +7,21 @@ layout (location = 2) in vec2 aTexCoords;
 out vec2 texCoords;
 
 out vec3 cPos;
-out vec4 sunSpacePos;
 out vec3 normal;
 
 out float depth;
 
+// bit for bit the same depth as the depth pre-pass, it tests GL_EQUAL
+invariant gl_Position;
+
 uniform mat4 cameraMat;
 uniform mat4 model;
 uniform mat4 view;
-uniform mat4 sunViewProjection;
 uniform mat3 normalMat;
 
 void main()
 {
     cPos = vec3(model * vec4(aPos, 1.0f));
-    sunSpacePos = sunViewProjection * vec4(cPos, 1.0f);
     gl_Position = cameraMat * vec4(cPos, 1.0f);
     normal = normalize(normalMat * aNormal);
     depth = -(view * vec4(cPos, 1.0f)).z;
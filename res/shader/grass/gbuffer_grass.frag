@@ -0,0 +1,34 @@
+#version 330 core
+
+// material only, the textures can go (see Shader::Feature)
+#pragma keywords DIFFUSE_TEX SPECULAR_TEX
+
+// g-buffer layout (see Scene::render deferred path)
+layout (location = 0) out vec4 gAlbedo;   // diffuse color
+layout (location = 1) out vec4 gSpecular; // specular color, shininess
+layout (location = 2) out vec4 gNormal;   // world space normal
+
+in vec2 texCoords;
+in vec3 normal;
+
+uniform sampler2D diffuseTex;
+uniform sampler2D specularTex;
+uniform vec3 diffuseColor;
+uniform vec3 specularColor;
+uniform float shininess;
+
+void main()
+{
+    // material diffuse and specular color (branchless)
+    vec3 dColor = diffuseColor;
+    vec3 sColor = specularColor;
+#ifdef DIFFUSE_TEX
+    dColor += texture(diffuseTex, texCoords).rgb;
+#endif
+#ifdef SPECULAR_TEX
+    sColor += texture(specularTex, texCoords).rgb;
+#endif
+    gAlbedo = vec4(dColor, 1.0);
+    gSpecular = vec4(sColor, shininess);
+    gNormal = vec4(normalize(normal), 0.0);
+}
\ No newline at end of file
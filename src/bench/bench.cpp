@@ -0,0 +1,1758 @@
+#include "bench.h"
+
+#include <scene/scene.h>
+#include <util/profiler.h>
+#include <util/jobSystem.h>
+#include <util/pool.h>
+#include <util/geometryArena.h>
+#include <util/frustum.h>
+#include <util/shader.h>
+#include <util/shaderCache.h>
+#include <util/textureStreamer.h>
+#include <scene/object/components/transform.h>
+#include <scene/object/components/camera.h>
+#include <scene/object/components/light.h>
+#include <scene/object/components/renderer/cubeRenderer.h>
+#include <scene/object/scripts/bobAndSpin.h>
+
+#include <GLFW/glfw3.h>
+#include <glm/gtc/quaternion.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <random>
+#include <fstream>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#ifdef __unix__
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <cstring>
+#endif
+
+// frames rendered before timing starts (shader compiles, buffer growth etc.)
+static const int WARMUP_FRAMES = 10;
+
+// one full main loop iteration minus the UI. beforeSwap can read the frame back
+static void frame(std::shared_ptr<Scene> s, std::function<void()> beforeSwap = nullptr)
+{
+    Profiler::get().beginFrame();
+    glfwPollEvents();
+    glClearColor(s->backgroundColor.r, s->backgroundColor.g, s->backgroundColor.b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    JobSystem::get().runMainThreadJobs();
+    s->update();
+    s->render();
+    JobSystem::get().publishStats();
+    if (beforeSwap)
+        beforeSwap();
+    glfwSwapBuffers(s->window);
+}
+
+static void printProfile(double wallMs)
+{
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  frame: " << wallMs << " ms" << std::endl;
+    for (auto& it : Profiler::get().stats())
+    {
+        const Profiler::Stat& stat = it.second;
+        if (stat.counter)
+        {
+            if (stat.cpuSamples)
+                std::cout << "  " << it.first << ": " << stat.totalCount / stat.cpuSamples << std::endl;
+            continue;
+        }
+        if (!stat.cpuSamples) continue;
+        std::cout << "  " << it.first << ": cpu " << stat.totalCpuMs / stat.cpuSamples << " ms";
+        if (stat.gpuSamples)
+            std::cout << ", gpu " << stat.totalGpuMs / stat.gpuSamples << " ms";
+        std::cout << std::endl;
+    }
+}
+
+// times the same scene through every render path
+static bool benchRender(std::shared_ptr<Scene> s, int frames)
+{
+    Scene::RenderPath previous = s->renderPath;
+    const Scene::RenderPath paths[] = { Scene::RenderPath::FORWARD, Scene::RenderPath::DEFERRED };
+    const char* names[] = { "forward", "deferred" };
+    for (int p = 0; p < 2; ++p)
+    {
+        s->renderPath = paths[p];
+        for (int i = 0; i < WARMUP_FRAMES; ++i)
+            frame(s);
+        glFinish();
+        // drain the timer queries from the warmup before resetting
+        Profiler::get().beginFrame();
+        Profiler::get().reset();
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; ++i)
+            frame(s);
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Profiler::get().beginFrame(); // collect the last gpu timings
+
+        std::cout << "BENCH::RENDER::" << names[p] << " (" << frames << " frames, "
+            << s->lightClusters->lightCount << " point lights)" << std::endl;
+        printProfile(ms / frames);
+    }
+    auto shadows = s->sunShadows;
+    for (unsigned int i = 0; i < shadows->cascadeCount; ++i)
+        std::cout << "  shadow cascade " << i << ": to " << shadows->splits[i] << ", "
+            << shadows->texelSize[i] << " units/texel, " << shadows->casterCount[i] << " casters" << std::endl;
+    s->renderPath = previous;
+    return true;
+}
+
+// job system scaling, the same work with 1 to N threads (main + workers).
+// the scene is copied out in a ring first so there's enough to split up
+static bool benchJobs(std::shared_ptr<Scene> s, int frames)
+{
+    const int COPIES = 8;
+    std::vector<std::shared_ptr<Object>> roots = s->objects;
+    for (int c = 1; c <= COPIES; ++c)
+        for (auto obj : roots)
+        {
+            if (obj->getComponent<Camera>())
+                continue;
+            std::shared_ptr<Object> copy = obj->clone();
+            std::shared_ptr<Transform> t = copy->getComponent<Transform>();
+            if (t)
+                t->position() += glm::vec3(glm::cos(c * 0.785f), 0.0f, glm::sin(c * 0.785f)) * 60.0f;
+            s->addObject(copy);
+        }
+
+    int previous = JobSystem::get().workerCount();
+    // 1 to N threads, N is one per core (or more if --workers asked for more)
+    unsigned int cores = std::max(std::max(1u, std::thread::hardware_concurrency()), (unsigned int)previous + 1);
+    double singleLoadMs = 0.0, singleForMs = 0.0, singleMs = 0.0;
+    for (unsigned int threads = 1; threads <= cores; ++threads)
+    {
+        JobSystem::get().start(threads - 1);
+
+        // asset import into a throwaway scene (decode is the parallel part)
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::shared_ptr<Scene> assets(new Scene(s->window));
+            assets->loadAssets();
+        }
+        glfwSetWindowUserPointer(s->window, s.get());
+        double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // raw scheduling throughput, lots of tiny chunks
+        std::vector<float> data(1 << 20, 1.0f);
+        start = std::chrono::steady_clock::now();
+        JobSystem::get().parallelFor(data.size(), 1024, [&data](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                data[i] = glm::sqrt(data[i] * 2.0f + 1.0f);
+        });
+        double forMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        for (int i = 0; i < WARMUP_FRAMES; ++i)
+            frame(s);
+        glFinish();
+        Profiler::get().beginFrame();
+        Profiler::get().reset();
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; ++i)
+            frame(s);
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Profiler::get().beginFrame();
+
+        std::cout << "BENCH::JOBS::" << threads << " thread(s) (" << frames << " frames, "
+            << s->drawList.size() << " draw items)" << std::endl;
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "  load assets: " << loadMs << " ms" << std::endl;
+        std::cout << "  parallel for (1M items): " << forMs << " ms" << std::endl;
+        printProfile(ms / frames);
+        if (threads == 1)
+        {
+            singleLoadMs = loadMs;
+            singleForMs = forMs;
+            singleMs = ms;
+        }
+        else
+            std::cout << "  speed-up over 1 thread: load " << singleLoadMs / loadMs << "x, parallel for " << singleForMs / forMs
+                << "x, frame " << singleMs / ms << "x" << std::endl;
+    }
+    JobSystem::get().start(previous);
+
+    // a wait from a thread that isn't ours (the asset watcher, say) helps
+    // with the jobs but leaves the main thread's GL jobs to it
+    std::thread::id ranOn;
+    JobSystem::get().runOnMainThread([&ranOn]() { ranOn = std::this_thread::get_id(); });
+    std::thread outside([]() {
+        JobSystem::get().wait(JobSystem::get().run([]() {}));
+    });
+    outside.join();
+    JobSystem::get().runMainThreadJobs();
+    bool mainOnly = ranOn == std::this_thread::get_id();
+    std::cout << "  main thread jobs from an outside wait: " << (mainOnly ? "left to the main thread" : "RUN ON THE OUTSIDE THREAD") << std::endl;
+    return mainOnly;
+}
+
+// 100k bobbing objects (50k pairs, the child reads its bobbing parent)
+// updated serially and in parallel batches, with 1 to N threads. the
+// parallel result has to match the serial one exactly
+static bool benchScripts(std::shared_ptr<Scene> s, int frames)
+{
+    const int PAIRS = 50000;
+    std::shared_ptr<Object> root(new Object(s));
+    root->setName("Script Bench");
+    root->components.push_back(std::shared_ptr<Component>(new Transform(root)));
+    std::vector<std::shared_ptr<Transform>> transforms;
+    std::vector<std::shared_ptr<Script>> bobs;
+    for (int i = 0; i < PAIRS; ++i)
+    {
+        std::shared_ptr<Object> parent = root;
+        for (int level = 0; level < 2; ++level)
+        {
+            std::shared_ptr<Object> obj(new Object(s));
+            obj->components.push_back(std::shared_ptr<Component>(new Transform(obj, glm::vec3(i % 500, 0.0f, i / 500), glm::vec3(0.0f), glm::vec3(1.0f))));
+            obj->reparent(parent, true);
+            obj->scripts.push_back(std::shared_ptr<Script>(new BobAndSpin(obj, 1.0f + (i % 7) * 0.25f, 1.0f, 0.5f, 10.0f + i % 13)));
+            bobs.push_back(obj->scripts.back());
+            transforms.push_back(obj->getComponent<Transform>());
+            parent = obj;
+        }
+    }
+    s->addObject(root);
+
+    // fixed inputs so runs can be compared
+    auto snapshot = [&transforms]() {
+        std::vector<glm::vec3> values;
+        for (auto t : transforms)
+        {
+            values.push_back(t->position());
+            values.push_back(t->rotation());
+        }
+        return values;
+    };
+    auto restore = [&transforms](const std::vector<glm::vec3>& values) {
+        for (size_t i = 0; i < transforms.size(); ++i)
+        {
+            transforms[i]->position() = values[i * 2];
+            transforms[i]->rotation() = values[i * 2 + 1];
+        }
+    };
+    auto run = [&s](bool parallel, int count) {
+        s->parallelScripts = parallel;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; ++i)
+        {
+            s->time = 1.0 + i / 60.0;
+            s->dTime = 1.0 / 60.0;
+            s->updateScripts();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / count;
+    };
+    std::vector<glm::vec3> initial = snapshot();
+
+    bool previousParallel = s->parallelScripts;
+    int previous = JobSystem::get().workerCount();
+    unsigned int cores = std::max(std::max(1u, std::thread::hardware_concurrency()), (unsigned int)previous + 1);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::SCRIPTS::" << transforms.size() << " scripted objects (" << frames << " updates)" << std::endl;
+
+    restore(initial);
+    double serialMs = run(false, frames);
+    std::vector<glm::vec3> serial = snapshot();
+    std::cout << "  serial: " << serialMs << " ms" << std::endl;
+    bool pass = true;
+    for (unsigned int threads = 1; threads <= cores; ++threads)
+    {
+        JobSystem::get().start(threads - 1);
+        restore(initial);
+        Profiler::get().beginFrame();
+        double ms = run(true, frames);
+        Profiler::get().beginFrame();
+        bool same = snapshot() == serial;
+        auto steps = Profiler::get().stats().find("script steps");
+        std::cout << "  parallel, " << threads << " thread(s): " << ms << " ms, ";
+        if (steps != Profiler::get().stats().end() && steps->second.count > 0)
+            std::cout << steps->second.count / frames << " steps, ";
+        else
+            std::cout << "no workers (serial walk), ";
+        std::cout << (same ? "matches serial" : "DIFFERS FROM SERIAL") << std::endl;
+        pass = pass && same;
+    }
+    JobSystem::get().start(previous);
+
+    // every 4 ticks, the phases spread them out so each tick gets a quarter
+    for (auto bob : bobs)
+        bob->runEvery(4);
+    ScriptStats& stats = s->scriptStats["BobAndSpin"];
+    stats.calls = 0;
+    stats.ns = 0;
+    unsigned int minCalls = ~0u, maxCalls = 0;
+    double total = 0.0;
+    for (int i = 0; i < frames; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        s->updateScripts();
+        total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        s->tickIndex++;
+        unsigned int calls = stats.calls.exchange(0);
+        minCalls = std::min(minCalls, calls);
+        maxCalls = std::max(maxCalls, calls);
+    }
+    std::cout << "  every 4 ticks: " << total / frames << " ms, " << minCalls << " to " << maxCalls << " calls a tick" << std::endl;
+    for (auto bob : bobs)
+        bob->runEvery(1);
+    s->parallelScripts = previousParallel;
+    return pass;
+}
+
+// headless simulation, scripts only with no clock or rendering. frames is
+// the number of simulated seconds
+static bool benchSim(std::shared_ptr<Scene> s, int frames)
+{
+    double seconds = frames;
+    auto start = std::chrono::steady_clock::now();
+    s->simulate(seconds);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::SIM::" << seconds << " s at " << s->tickRate << " Hz" << std::endl;
+    std::cout << "  wall: " << ms << " ms (" << seconds * 1000.0 / ms << "x real time)" << std::endl;
+    std::cout << "  per tick: " << ms / (seconds * s->tickRate) << " ms" << std::endl;
+    return true;
+}
+
+// resident memory in kB, 0 where we can't tell
+static long residentKb()
+{
+#ifdef __GLIBC__
+    malloc_trim(0); // hand freed pages back so the numbers mean something
+#endif
+#ifdef __unix__
+    std::ifstream statm("/proc/self/statm");
+    long size = 0, resident = 0;
+    if (statm >> size >> resident)
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+    return 0;
+}
+
+// create and delete a million objects a few times. every object, component
+// and script has to be freed (checked through weak pointers) and memory has
+// to come back to where it was after the first round. frames is the number
+// of rounds
+static bool benchLeaks(std::shared_ptr<Scene> s, int frames)
+{
+    const int PARENTS = 100000, CHILDREN = 9;
+    int rounds = std::max(frames, 2);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::LEAKS::" << PARENTS * (CHILDREN + 1) << " objects, " << rounds << " rounds" << std::endl;
+
+    std::vector<std::weak_ptr<Object>> objects;
+    std::vector<std::weak_ptr<Component>> components;
+    std::vector<std::weak_ptr<Script>> scripts;
+    objects.reserve(PARENTS * (CHILDREN + 1) + 1);
+    components.reserve(PARENTS * (CHILDREN + 1) * 2 + 1);
+    scripts.reserve(PARENTS);
+
+    long before = residentKb(), baseline = 0;
+    bool ok = true;
+    for (int round = 0; round < rounds; ++round)
+    {
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::shared_ptr<Object> root(new Object(s));
+            root->setName("Leak Bench");
+            root->components.push_back(std::shared_ptr<Component>(new Transform(root)));
+            s->addObject(root);
+            objects.push_back(root);
+            for (int i = 0; i < PARENTS; ++i)
+            {
+                std::shared_ptr<Object> parent(new Object(s));
+                parent->components.push_back(std::shared_ptr<Component>(new Transform(parent, glm::vec3(i % 300, 0.0f, i / 300), glm::vec3(0.0f), glm::vec3(1.0f))));
+                parent->reparent(root, true);
+                objects.push_back(parent);
+                for (int j = 0; j < CHILDREN; ++j)
+                {
+                    std::shared_ptr<Object> child(new Object(s));
+                    child->components.push_back(std::shared_ptr<Component>(new Transform(child, glm::vec3(0.0f, j, 0.0f), glm::vec3(0.0f), glm::vec3(0.25f))));
+                    if (j % 3 == 0)
+                        child->components.push_back(std::shared_ptr<Component>(new CubeRenderer(child)));
+                    child->reparent(parent, true);
+                    objects.push_back(child);
+                    for (auto c : child->components)
+                        components.push_back(c);
+                }
+                if (i % 10 == 0)
+                    parent->scripts.push_back(std::shared_ptr<Script>(new BobAndSpin(parent)));
+                if (i % 1000 == 0)
+                    parent->components.push_back(std::shared_ptr<Component>(new Light(parent)));
+                for (auto c : parent->components)
+                    components.push_back(c);
+                for (auto c : parent->scripts)
+                    scripts.push_back(c);
+            }
+        }
+        double createMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        long peak = residentKb();
+
+        start = std::chrono::steady_clock::now();
+        objects.front().lock()->remove();
+        double removeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        size_t alive = 0;
+        for (auto& o : objects)
+            alive += !o.expired();
+        for (auto& c : components)
+            alive += !c.expired();
+        for (auto& c : scripts)
+            alive += !c.expired();
+        // the weak pointers keep the control blocks around, drop them too
+        objects.clear();
+        components.clear();
+        scripts.clear();
+        long after = residentKb();
+        if (round == 0)
+            baseline = after;
+        std::cout << "  round " << round << ": create " << createMs << " ms, remove " << removeMs << " ms, "
+            << alive << " still alive, rss " << before << " -> " << peak << " -> " << after << " kB" << std::endl;
+        ok = ok && alive == 0;
+        // later rounds must land where the first did (allocator slack aside)
+        if (round > 0 && after > baseline + baseline / 20 + 1024)
+            ok = false;
+    }
+    std::cout << "  " << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok;
+}
+
+// hardware cache misses of this thread, where the kernel lets us count them
+class CacheMisses {
+public:
+    CacheMisses()
+    {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+    ~CacheMisses()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+    bool available() { return fd >= 0; }
+    void start()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    long long stop()
+    {
+        long long misses = 0;
+#ifdef __linux__
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &misses, sizeof(misses)) != sizeof(misses))
+                misses = 0;
+        }
+#endif
+        return misses;
+    }
+private:
+    int fd = -1;
+};
+
+// instantiate a blueprint over and over (Object::clone) and time the update
+// pass over the copies. frames is the number of clones
+static bool benchClone(std::shared_ptr<Scene> s, int frames)
+{
+    // 1 + 10 + 100 objects, transforms everywhere, cubes and scripts on the leaves
+    std::shared_ptr<Object> blueprint = makePooled<Object>(s);
+    blueprint->setName("Clone Bench");
+    blueprint->components.push_back(makePooled<Transform>(blueprint));
+    for (int i = 0; i < 10; ++i)
+    {
+        std::shared_ptr<Object> branch = makePooled<Object>(s);
+        branch->components.push_back(makePooled<Transform>(branch, glm::vec3(i, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(1.0f)));
+        branch->reparent(blueprint, true);
+        for (int j = 0; j < 10; ++j)
+        {
+            std::shared_ptr<Object> leaf = makePooled<Object>(s);
+            leaf->components.push_back(makePooled<Transform>(leaf, glm::vec3(0.0f, j, 0.0f), glm::vec3(0.0f), glm::vec3(0.25f)));
+            leaf->components.push_back(makePooled<CubeRenderer>(leaf));
+            leaf->scripts.push_back(makePooled<BobAndSpin>(leaf));
+            leaf->reparent(branch, true);
+        }
+    }
+
+    Pool::Stats before = Pool::stats();
+    std::vector<std::shared_ptr<Object>> clones;
+    clones.reserve(frames);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i)
+        clones.push_back(blueprint->clone());
+    double cloneMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    Pool::Stats after = Pool::stats();
+
+    for (auto clone : clones)
+        s->addObject(clone);
+    const int UPDATES = 20;
+    CacheMisses misses;
+    frame(s); // start scripts, first tick
+    misses.start();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < UPDATES; ++i)
+    {
+        s->simulate(1.0 / s->tickRate);
+        s->updateWorldMatrices();
+    }
+    double updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / UPDATES;
+    long long missCount = misses.stop();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::CLONE::" << frames << " clones of a 111 object blueprint" << std::endl;
+    std::cout << "  clone: " << cloneMs << " ms (" << frames * 111.0 / cloneMs << " objects/ms)" << std::endl;
+    std::cout << "  pool: " << after.blocks - before.blocks << " blocks in " << after.slabs - before.slabs << " new slabs" << std::endl;
+    std::cout << "  update: " << updateMs << " ms a tick, cache misses: ";
+    if (misses.available())
+        std::cout << missCount / UPDATES << " a tick" << std::endl;
+    else
+        std::cout << "n/a (no hardware counters)" << std::endl;
+
+    for (auto clone : clones)
+        clone->remove();
+    clones.clear();
+    blueprint->remove();
+    std::cout << "  trim: " << Pool::trim() << " slabs released, " << Pool::stats().blocks << " blocks still live" << std::endl;
+    return true;
+}
+
+// editor style bulk edits on a big flat scene: reparent and remove objects
+// in random order through handles. frames is the object count in thousands
+static bool benchEdit(std::shared_ptr<Scene> s, int frames)
+{
+    const size_t COUNT = std::max(frames, 1) * 1000;
+    std::vector<ObjectHandle> handles;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        std::shared_ptr<Object> obj = makePooled<Object>(s);
+        obj->components.push_back(makePooled<Transform>(obj));
+        s->addObject(obj);
+        handles.push_back(obj->getHandle());
+    }
+    double createMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // fixed shuffle so runs compare
+    unsigned int seed = 12345;
+    for (size_t i = handles.size() - 1; i > 0; --i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        std::swap(handles[i], handles[seed % (i + 1)]);
+    }
+
+    // every tenth object becomes a group, a third of the rest move under
+    // one, then half of everything is deleted (groups take their children)
+    std::vector<ObjectHandle> groups, moved, removed;
+    for (size_t i = 0; i < handles.size(); ++i)
+        if (i % 10 == 0)
+            groups.push_back(handles[i]);
+        else if (i % 3 == 0)
+            moved.push_back(handles[i]);
+    for (size_t i = 0; i < handles.size(); i += 2)
+        removed.push_back(handles[i]);
+
+    size_t roots = s->objects.size();
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < moved.size(); i += 16)
+    {
+        std::vector<ObjectHandle> batch(moved.begin() + i, moved.begin() + std::min(i + 16, moved.size()));
+        s->reparentObjects(batch, groups[(i / 16) % groups.size()]);
+    }
+    double reparentMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    s->removeObjects(removed);
+    double removeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t stale = 0, alive = 0;
+    for (auto handle : handles)
+        if (s->find(handle))
+            alive++;
+        else
+            stale++;
+    for (auto handle : removed)
+        if (s->find(handle))
+            alive = ~(size_t)0; // a removed object still resolves
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::EDIT::" << COUNT << " objects (" << roots << " scene roots)" << std::endl;
+    std::cout << "  create: " << createMs << " ms" << std::endl;
+    std::cout << "  reparent " << moved.size() << ": " << reparentMs << " ms" << std::endl;
+    std::cout << "  remove " << removed.size() << ": " << removeMs << " ms" << std::endl;
+    if (alive == ~(size_t)0)
+        std::cout << "  FAIL, a removed handle still resolves" << std::endl;
+    else
+        std::cout << "  " << alive << " handles resolve, " << stale << " stale" << std::endl;
+
+    std::vector<ObjectHandle> rest;
+    for (auto handle : handles)
+        if (s->find(handle))
+            rest.push_back(handle);
+    s->removeObjects(rest);
+    return alive != ~(size_t)0;
+}
+
+// the scene systems over the object tree vs the world's columns. frames is
+// the entity count in thousands (1000 = 1M)
+static bool benchEcs(std::shared_ptr<Scene> s, int frames)
+{
+    const int CHILDREN = 9;
+    size_t count = std::max(frames, 1) * 1000;
+    std::shared_ptr<Object> root = makePooled<Object>(s);
+    root->setName("ECS Bench");
+    root->components.push_back(makePooled<Transform>(root));
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count / (CHILDREN + 1); ++i)
+    {
+        std::shared_ptr<Object> parent = makePooled<Object>(s);
+        parent->components.push_back(makePooled<Transform>(parent, glm::vec3(i % 1000, 0.0f, i / 1000), glm::vec3(0.0f, i % 360, 0.0f), glm::vec3(1.0f)));
+        if (i % 1000 == 0)
+            parent->components.push_back(makePooled<Light>(parent, glm::vec3(1.0f), 0.1f, 0.01f));
+        parent->reparent(root);
+        for (int j = 0; j < CHILDREN; ++j)
+        {
+            std::shared_ptr<Object> child = makePooled<Object>(s);
+            child->components.push_back(makePooled<Transform>(child, glm::vec3(0.0f, j, 0.0f), glm::vec3(0.0f), glm::vec3(0.25f)));
+            child->components.push_back(makePooled<CubeRenderer>(child));
+            child->reparent(parent);
+        }
+    }
+    s->addObject(root);
+    double createMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::ECS::" << s->world.size() << " entities, " << s->world.archetypes().size() << " archetypes (create " << createMs << " ms)" << std::endl;
+
+    auto time = [](std::function<void()> fn, int runs) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; ++i)
+            fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+    };
+    const int RUNS = 5;
+    bool previous = s->ecsSystems;
+    bool pass = true;
+    std::vector<DrawItem> treeDraws;
+    for (int ecs = 0; ecs <= 1; ++ecs)
+    {
+        s->ecsSystems = ecs == 1;
+        double levelsMs = 0.0;
+        if (s->ecsSystems)
+            levelsMs = time([&s]() { s->buildTransformLevels(); }, 1);
+        double transformMs = time([&s]() { s->savePreviousTransforms(); s->updateWorldMatrices(); }, RUNS);
+        double lightMs = time([&s]() { s->gatherLights(); }, RUNS);
+        double drawMs = time([&s]() { s->collectDrawList(); }, RUNS);
+        std::cout << "  " << (s->ecsSystems ? "world columns" : "object tree") << ": transforms " << transformMs
+            << " ms, lights " << lightMs << " ms (" << s->lights.size() << "), draw list " << drawMs << " ms (" << s->drawList.size() << ")";
+        if (s->ecsSystems)
+            std::cout << ", level build " << levelsMs << " ms";
+        std::cout << std::endl;
+
+        // same draws with the same matrices either way
+        if (!s->ecsSystems)
+            treeDraws = s->drawList;
+        else
+        {
+            std::map<Renderer*, glm::mat4> models;
+            for (auto& item : treeDraws)
+                models[item.renderer] = item.model;
+            bool same = models.size() == s->drawList.size();
+            for (auto& item : s->drawList)
+                same = same && models.count(item.renderer) && models[item.renderer] == item.model;
+            std::cout << "  " << (same ? "matches the object tree" : "DIFFERS FROM THE OBJECT TREE") << std::endl;
+            pass = same;
+        }
+    }
+    s->ecsSystems = previous;
+    root->remove();
+    s->drawList.clear();
+    return pass;
+}
+
+// a tree the way the model importer builds blueprints: transforms and mesh
+// style renderers only, 1 + 1 + 4 + 12 objects and 17 draws
+static std::shared_ptr<Object> treeBlueprint(std::shared_ptr<Scene> s)
+{
+    std::shared_ptr<Object> tree = makePooled<Object>(s);
+    tree->setName("Prefab Bench Tree");
+    tree->components.push_back(makePooled<Transform>(tree));
+    std::shared_ptr<Object> trunk = makePooled<Object>(s);
+    trunk->setName("trunk");
+    trunk->components.push_back(makePooled<Transform>(trunk, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.3f, 2.0f, 0.3f)));
+    trunk->components.push_back(makePooled<CubeRenderer>(trunk));
+    trunk->reparent(tree, true);
+    for (int i = 0; i < 4; ++i)
+    {
+        std::shared_ptr<Object> branch = makePooled<Object>(s);
+        branch->setName("branch" + std::to_string(i));
+        branch->components.push_back(makePooled<Transform>(branch, glm::vec3(0.0f, 0.4f, 0.0f), glm::vec3(40.0f, i * 90.0f, 0.0f), glm::vec3(0.5f)));
+        branch->components.push_back(makePooled<CubeRenderer>(branch));
+        branch->reparent(trunk, true);
+        for (int j = 0; j < 3; ++j)
+        {
+            std::shared_ptr<Object> leaves = makePooled<Object>(s);
+            leaves->setName("leaves" + std::to_string(j));
+            leaves->components.push_back(makePooled<Transform>(leaves, glm::vec3(0.0f, 0.5f + j, 0.0f), glm::vec3(0.0f), glm::vec3(1.5f)));
+            leaves->components.push_back(makePooled<CubeRenderer>(leaves));
+            leaves->reparent(branch, true);
+        }
+    }
+    tree->reparent(nullptr, true);
+    return tree;
+}
+
+// prefab instances vs deep copies of the same blueprint: time, memory, draw
+// list and save size. frames is the number of trees in thousands
+static bool benchPrefab(std::shared_ptr<Scene> s, int frames)
+{
+    const size_t COUNT = std::max(frames, 1) * 1000;
+    std::shared_ptr<Object> blueprint = treeBlueprint(s);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::PREFAB::" << COUNT << " trees of 18 objects" << std::endl;
+
+    std::vector<size_t> drawCounts;
+    std::vector<glm::mat4> firstModels;
+    bool pass = true;
+    for (int instances = 0; instances <= 1; ++instances)
+    {
+        std::vector<std::shared_ptr<Object>> trees;
+        trees.reserve(COUNT);
+        long rssBefore = residentKb();
+        Pool::Stats before = Pool::stats();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < COUNT; ++i)
+        {
+            std::shared_ptr<Object> tree = instances ? blueprint->instantiate() : blueprint->clone();
+            tree->getComponent<Transform>()->position() = glm::vec3(i % 316, 0.0f, i / 316) * 4.0f;
+            s->addObject(tree);
+            trees.push_back(tree);
+        }
+        double createMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Pool::Stats after = Pool::stats();
+        long rssAfter = residentKb();
+
+        s->updateWorldMatrices();
+        start = std::chrono::steady_clock::now();
+        s->collectDrawList();
+        double drawMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        drawCounts.push_back(s->drawList.size());
+        std::vector<glm::mat4> models;
+        for (auto& item : s->drawList)
+            models.push_back(item.model);
+        std::sort(models.begin(), models.end(), [](const glm::mat4& a, const glm::mat4& b) {
+            return memcmp(&a, &b, sizeof(glm::mat4)) < 0;
+        });
+
+        YAML::Emitter saved;
+        saved << *trees[0];
+
+        std::cout << "  " << (instances ? "instantiate" : "clone") << ": " << createMs << " ms, "
+            << after.blocks - before.blocks << " pool blocks, " << (rssAfter - rssBefore) / 1024 << " MB, "
+            << s->world.size() << " entities, draw list " << drawMs << " ms (" << s->drawList.size() << " draws), "
+            << saved.size() << " bytes of yaml a tree" << std::endl;
+
+        if (!instances)
+            firstModels = models;
+        else
+        {
+            bool same = drawCounts[0] == drawCounts[1] && models == firstModels;
+            std::cout << "  " << (same ? "same draws as the clones" : "DRAWS DIFFER FROM THE CLONES") << std::endl;
+            pass = pass && same;
+
+            // copy on write: override one branch of the first tree and move it,
+            // the rest of the tree still comes from the blueprint
+            std::shared_ptr<Object> trunk = trees[0]->overridePrefabChild(blueprint->children[0]);
+            std::shared_ptr<Object> branch = trunk->overridePrefabChild(blueprint->children[0]->children[0]);
+            branch->getComponent<Transform>()->rotation().x += 20.0f;
+            s->updateWorldMatrices();
+            s->collectDrawList();
+            YAML::Emitter overridden;
+            overridden << *trees[0];
+            std::cout << "  one branch overridden: " << s->drawList.size() << " draws, " << trees[0]->prefabChildren().size()
+                << " children left on the blueprint, " << overridden.size() << " bytes of yaml" << std::endl;
+
+            // and back, only the overrides come out of the file, each still
+            // standing in for its part of the blueprint (the branch too, or it
+            // draws twice)
+            std::shared_ptr<Object> loaded = Object::deserialise(YAML::Load(overridden.c_str()), s);
+            bool restored = loaded->getPrefab() == blueprint && loaded->children.size() == 1
+                && loaded->children[0]->getPrefab() == blueprint->children[0] && loaded->children[0]->children.size() == 1
+                && loaded->children[0]->children[0]->getPrefab() == blueprint->children[0]->children[0];
+            std::cout << "  reloaded: " << (restored ? "overrides restored" : "OVERRIDES LOST") << std::endl;
+            pass = pass && restored;
+        }
+
+        for (auto tree : trees)
+            tree->remove();
+        s->drawList.clear();
+    }
+    blueprint->remove();
+    return pass;
+}
+
+// Scene::scatter onto a ground object. frames is the instance count in
+// thousands
+static bool benchScatter(std::shared_ptr<Scene> s, int frames)
+{
+    std::shared_ptr<Object> blueprint = treeBlueprint(s);
+    std::shared_ptr<Object> ground = makePooled<Object>(s);
+    ground->setName("Scatter Bench Ground");
+    ground->components.push_back(makePooled<Transform>(ground, glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(1000.0f, 1.0f, 1000.0f)));
+    ground->components.push_back(makePooled<CubeRenderer>(ground));
+    s->addObject(ground);
+
+    Scene::Scatter settings;
+    settings.count = std::max(frames, 1) * 1000;
+    settings.seed = 7;
+    settings.surface = ground->getHandle();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::SCATTER::" << settings.count << " trees" << std::endl;
+    std::vector<glm::vec3> placed[2];
+    for (int run = 0; run < 2; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<Object> group = s->scatter(blueprint, settings);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  scatter: " << ms << " ms (" << settings.count / ms << " instances/ms)" << std::endl;
+
+        AABB bounds;
+        for (auto tree : group->children)
+        {
+            std::shared_ptr<Transform> t = tree->getComponent<Transform>();
+            placed[run].push_back(t->position());
+            placed[run].push_back(glm::vec3(t->rotation().y, t->scale().x, 0.0f));
+            bounds.expand(t->position());
+        }
+        if (run == 0)
+            std::cout << "  placed over " << bounds.min.x << "," << bounds.min.z << " to " << bounds.max.x << "," << bounds.max.z
+                << " at height " << bounds.max.y << std::endl;
+        group->remove();
+    }
+    bool same = placed[0] == placed[1];
+    std::cout << "  " << (same ? "same seed, same placement" : "SAME SEED PLACED DIFFERENTLY") << std::endl;
+
+    ground->remove();
+    blueprint->remove();
+    return same;
+}
+
+// a field of static cubes in a few materials, drawn with and without the
+// static batches. frames is the cube count in hundreds
+static bool benchBatching(std::shared_ptr<Scene> s, int frames)
+{
+    const int COUNT = std::max(frames, 1) * 100;
+    const glm::vec3 colors[] = { glm::vec3(0.8f, 0.2f, 0.2f), glm::vec3(0.2f, 0.8f, 0.2f), glm::vec3(0.2f, 0.2f, 0.8f), glm::vec3(0.8f, 0.8f, 0.2f) };
+    std::shared_ptr<Object> field = makePooled<Object>(s);
+    field->setName("Batching Bench");
+    field->isStatic = true;
+    field->components.push_back(makePooled<Transform>(field, glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(0.0f), glm::vec3(1.0f)));
+    s->addObject(field);
+    int side = (int)std::ceil(std::sqrt((float)COUNT));
+    for (int i = 0; i < COUNT; ++i)
+    {
+        std::shared_ptr<Object> cube = makePooled<Object>(s);
+        cube->components.push_back(makePooled<Transform>(cube, glm::vec3((i % side - side / 2) * 1.5f, 0.0f, (i / side) * -1.5f), glm::vec3(0.0f, i * 7.0f, 0.0f), glm::vec3(0.5f)));
+        std::shared_ptr<CubeRenderer> r = makePooled<CubeRenderer>(cube);
+        r->diffuseColor = colors[i % 4];
+        cube->components.push_back(r);
+        cube->reparent(field);
+    }
+
+    bool previous = s->staticBatching;
+    const char* names[] = { "off", "on" };
+    for (int on = 0; on < 2; ++on)
+    {
+        s->staticBatching = on;
+        s->staticBatches->dirty = true;
+        for (int i = 0; i < WARMUP_FRAMES; ++i)
+            frame(s);
+        glFinish();
+        Profiler::get().beginFrame();
+        Profiler::get().reset();
+
+        const int FRAMES = 30;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; ++i)
+            frame(s);
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Profiler::get().beginFrame();
+
+        std::cout << "BENCH::BATCHING::" << names[on] << " (" << COUNT << " static cubes)" << std::endl;
+        if (on)
+            std::cout << "  batches: " << s->staticBatches->batchCount << " from " << s->staticBatches->sourceCount << " renderers, "
+                << s->staticBatches->vertexCount << " vertices, built in " << s->staticBatches->buildMs << " ms" << std::endl;
+        printProfile(ms / FRAMES);
+    }
+    s->staticBatching = previous;
+    field->remove();
+    return true;
+}
+
+// add / remove churn on a small arena: how often it grows or compacts and
+// how fragmented it gets, on an arena of its own (the scene isn't used).
+// frames is the operation count in thousands
+static bool benchArena(std::shared_ptr<Scene>, int frames)
+{
+    const int OPS = std::max(frames, 1) * 1000;
+    GeometryArena arena("bench", { 3, 3, 2 }, 4096, 4096 * 3);
+    std::mt19937 rng(11);
+    std::vector<GLfloat> vertices(8 * 4096, 0.0f);
+    std::vector<GLuint> indices(3 * 4096, 0);
+    std::vector<std::pair<GeometryArena::Handle, GLuint>> live; // handle, tag written into its first vertex and index
+
+    auto print = [&](const char* when) {
+        GeometryArena::Stats st = arena.stats();
+        std::cout << "  " << when << ": " << st.allocations << " allocations, vertices " << st.vertexUsed << " / " << st.vertexCapacity
+            << ", indices " << st.indexUsed << " / " << st.indexCapacity << ", " << st.freeBlocks << " free blocks (largest "
+            << st.largestFreeVertices << " vertices), grown " << st.grows << "x, compacted " << st.defrags << "x" << std::endl;
+    };
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::ARENA::" << OPS << " operations" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < OPS; ++i)
+    {
+        // grows towards ~500 live meshes then hovers there
+        if (live.empty() || rng() % 1000 < (live.size() < 500 ? 700u : 500u))
+        {
+            size_t count = 24 + rng() % 2000;
+            GLuint tag = i;
+            vertices[0] = (GLfloat)tag;
+            indices[0] = tag;
+            live.push_back({ arena.add(vertices.data(), count, indices.data(), count * 3 / 2), tag });
+        }
+        else
+        {
+            size_t victim = rng() % live.size();
+            arena.remove(live[victim].first);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+    }
+    glFinish();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  churn: " << ms << " ms (" << ms * 1000.0 / OPS << " us an operation)" << std::endl;
+    print("after churn");
+
+    start = std::chrono::steady_clock::now();
+    arena.defragment();
+    glFinish();
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  defragment: " << ms << " ms" << std::endl;
+    print("after defragment");
+
+    // everything still where the handles say after all the moving
+    std::vector<GLfloat> v;
+    std::vector<GLuint> ix;
+    bool intact = true;
+    for (auto& it : live)
+    {
+        arena.read(it.first, v, ix);
+        intact = intact && !v.empty() && v[0] == (GLfloat)it.second && ix[0] == it.second;
+    }
+    std::cout << "  " << (intact ? "ranges intact" : "RANGES BROKEN") << std::endl;
+    return intact;
+}
+
+// the editor windows over a big flat scene. frames is the object count in
+// thousands
+// moving cubes (so static batching can't take them) drawn one by one and
+// through multi-draw indirect, and the gpu cull checked against the cpu one
+static bool benchIndirect(std::shared_ptr<Scene> s, int frames)
+{
+    const int COUNT = std::max(frames, 1) * 100;
+    if (!s->indirectDraws->supported(s.get()))
+        std::cout << "WARN::BENCH::INDIRECT::no GL 4.3, both runs take the one by one path" << std::endl;
+    const glm::vec3 colors[] = { glm::vec3(0.8f, 0.2f, 0.2f), glm::vec3(0.2f, 0.8f, 0.2f), glm::vec3(0.2f, 0.2f, 0.8f), glm::vec3(0.8f, 0.8f, 0.2f) };
+    std::shared_ptr<Object> field = makePooled<Object>(s);
+    field->setName("Indirect Bench");
+    field->components.push_back(makePooled<Transform>(field, glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(0.0f), glm::vec3(1.0f)));
+    s->addObject(field);
+    int side = (int)std::ceil(std::sqrt((float)COUNT));
+    for (int i = 0; i < COUNT; ++i)
+    {
+        std::shared_ptr<Object> cube = makePooled<Object>(s);
+        cube->components.push_back(makePooled<Transform>(cube, glm::vec3((i % side - side / 2) * 1.5f, 0.0f, (i / side) * -1.5f), glm::vec3(0.0f, i * 7.0f, 0.0f), glm::vec3(0.5f)));
+        std::shared_ptr<CubeRenderer> r = makePooled<CubeRenderer>(cube);
+        r->diffuseColor = colors[i % 4];
+        cube->components.push_back(r);
+        cube->reparent(field);
+    }
+
+    bool previous = s->indirectDraws->enabled;
+    bool pass = true;
+    const char* names[] = { "off", "on" };
+    for (int on = 0; on < 2; ++on)
+    {
+        s->indirectDraws->enabled = on;
+        for (int i = 0; i < WARMUP_FRAMES; ++i)
+            frame(s);
+        glFinish();
+        Profiler::get().beginFrame();
+        Profiler::get().reset();
+
+        const int FRAMES = 30;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; ++i)
+            frame(s);
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Profiler::get().beginFrame();
+
+        std::cout << "BENCH::INDIRECT::" << names[on] << " (" << COUNT << " moving cubes)" << std::endl;
+        if (on && s->indirectDraws->instanceCount)
+        {
+            Frustum frustum(s->activeCamera->getMatrix());
+            unsigned int cpu = 0;
+            for (auto& item : s->drawList)
+                cpu += item.indirect && !item.occluded && frustum.intersects(item.bounds);
+            std::cout << "  " << s->indirectDraws->instanceCount << " instances in " << s->indirectDraws->groupCount << " groups, "
+                << s->indirectDraws->multiDraws << " multi-draws" << std::endl;
+            unsigned int gpu = s->indirectDraws->readVisible(0);
+            std::cout << "  gpu culled visible: " << gpu << ", cpu frustum and occlusion: " << cpu
+                << (gpu == cpu ? ", same" : ", GPU AND CPU DIFFER") << std::endl;
+            pass = gpu == cpu;
+        }
+        printProfile(ms / FRAMES);
+    }
+    s->indirectDraws->enabled = previous;
+    field->remove();
+    return pass;
+}
+
+// a wall in front of the camera with cubes hidden behind it, and more in
+// front of and beside it that must stay visible
+static bool benchOcclusion(std::shared_ptr<Scene> s, int frames)
+{
+    const int HIDDEN = std::max(frames, 1) * 100;
+    const int SHOWN = 100;
+    // up in the sky looking level, so nothing of the scene's gets in the way
+    auto camera = s->activeCamera->transform;
+    glm::vec3 cameraPosition = camera->position(), cameraRotation = camera->rotation();
+    camera->position() = glm::vec3(0.0f, 1000.0f, 0.0f);
+    camera->rotation() = glm::vec3(0.0f);
+    camera->savePrevious(); // no interpolating from where it was
+    frame(s);
+    glm::mat4 eye = glm::inverse(s->activeCamera->getView());
+    glm::vec3 pos = glm::vec3(eye[3]), forward = -glm::normalize(glm::vec3(eye[2]));
+    glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 up = glm::cross(right, forward);
+    glm::vec3 facing = glm::degrees(glm::eulerAngles(glm::quat_cast(glm::mat3(right, up, -forward))));
+    auto at = [&](float x, float y, float d) { return pos + right * x + up * y + forward * d; };
+
+    std::shared_ptr<Object> root = makePooled<Object>(s);
+    root->setName("Occlusion Bench");
+    root->components.push_back(makePooled<Transform>(root, glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f)));
+    s->addObject(root);
+    const float WALL_DISTANCE = 30.0f;
+    const glm::vec2 WALL_HALF(12.0f, 7.0f);
+    std::shared_ptr<Object> wall = makePooled<Object>(s);
+    wall->isStatic = true;
+    wall->components.push_back(makePooled<Transform>(wall, at(0.0f, 0.0f, WALL_DISTANCE), facing, glm::vec3(WALL_HALF * 2.0f, 1.0f)));
+    wall->components.push_back(makePooled<CubeRenderer>(wall));
+    wall->reparent(root);
+
+    std::map<Renderer*, bool> expectHidden;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    auto addCube = [&](glm::vec3 p, bool hidden) {
+        std::shared_ptr<Object> cube = makePooled<Object>(s);
+        cube->components.push_back(makePooled<Transform>(cube, p, facing, glm::vec3(0.5f)));
+        std::shared_ptr<CubeRenderer> r = makePooled<CubeRenderer>(cube);
+        r->diffuseColor = hidden ? glm::vec3(0.8f, 0.2f, 0.2f) : glm::vec3(0.2f, 0.8f, 0.2f);
+        cube->components.push_back(r);
+        cube->reparent(root);
+        expectHidden[r.get()] = hidden;
+    };
+    for (int i = 0; i < HIDDEN; ++i)
+    {
+        // well inside the wall's silhouette
+        float d = WALL_DISTANCE + 10.0f + 30.0f * (unit(rng) * 0.5f + 0.5f);
+        float scale = d / WALL_DISTANCE * 0.6f;
+        addCube(at(unit(rng) * WALL_HALF.x * scale, unit(rng) * WALL_HALF.y * scale, d), true);
+    }
+    for (int i = 0; i < SHOWN; ++i)
+    {
+        // half between us and the wall, half beside it
+        if (i % 2)
+            addCube(at(unit(rng) * WALL_HALF.x * 0.5f, unit(rng) * WALL_HALF.y * 0.5f, WALL_DISTANCE * 0.4f), false);
+        else
+        {
+            float d = WALL_DISTANCE + 10.0f;
+            float side = (i % 4 ? 1.0f : -1.0f) * WALL_HALF.x * d / WALL_DISTANCE * 1.4f;
+            addCube(at(side, unit(rng) * WALL_HALF.y, d), false);
+        }
+    }
+
+    bool previous = s->occlusion->enabled;
+    const char* names[] = { "off", "on" };
+    bool pass = true;
+    for (int on = 0; on < 2; ++on)
+    {
+        s->occlusion->enabled = on;
+        for (int i = 0; i < WARMUP_FRAMES; ++i)
+            frame(s);
+        glFinish();
+        Profiler::get().beginFrame();
+        Profiler::get().reset();
+
+        const int FRAMES = 30;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; ++i)
+            frame(s);
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Profiler::get().beginFrame();
+
+        std::cout << "BENCH::OCCLUSION::" << names[on] << " (" << HIDDEN << " cubes behind a wall, " << SHOWN << " in view)" << std::endl;
+        if (on)
+        {
+            auto occlusion = s->occlusion;
+            int culled = 0, wrong = 0;
+            unsigned int indirect = 0;
+            Frustum frustum(s->activeCamera->getMatrix());
+            for (auto& item : s->drawList)
+            {
+                auto found = expectHidden.find(item.renderer);
+                if (found != expectHidden.end())
+                {
+                    culled += found->second && item.occluded;
+                    wrong += !found->second && item.occluded;
+                }
+                indirect += item.indirect && !item.occluded && frustum.intersects(item.bounds);
+            }
+            std::cout << "  " << occlusion->occluderCount << " occluders, " << occlusion->triangleCount << " triangles at "
+                << occlusion->width << "x" << occlusion->height << ", raster " << occlusion->rasterMs << " ms, test " << occlusion->testMs << " ms" << std::endl;
+            std::cout << "  behind the wall culled: " << culled << " / " << HIDDEN << ", in view culled: " << wrong << " / " << SHOWN << std::endl;
+            if (s->indirectDraws->instanceCount)
+                std::cout << "  gpu culled visible: " << s->indirectDraws->readVisible(0) << ", cpu frustum and occlusion: " << indirect << std::endl;
+            pass = wrong == 0 && culled > HIDDEN * 9 / 10;
+        }
+        printProfile(ms / FRAMES);
+    }
+    std::cout << (pass ? "  PASS" : "  FAIL") << std::endl;
+    s->occlusion->enabled = previous;
+    root->remove();
+    camera->position() = cameraPosition;
+    camera->rotation() = cameraRotation;
+    camera->savePrevious();
+    return pass;
+}
+
+// rows of overlapping cubes drawn back to front, through the forward path
+// unsorted, sorted and with the depth pre-pass. overdraw is read back from
+// the overdraw view
+static bool benchPrepass(std::shared_ptr<Scene> s, int frames)
+{
+    const int COUNT = std::max(frames, 1) * 100;
+    // up in the sky looking level, only the cubes in view
+    auto camera = s->activeCamera->transform;
+    glm::vec3 cameraPosition = camera->position(), cameraRotation = camera->rotation();
+    camera->position() = glm::vec3(0.0f, 1000.0f, 0.0f);
+    camera->rotation() = glm::vec3(0.0f);
+    camera->savePrevious();
+
+    std::shared_ptr<Object> root = makePooled<Object>(s);
+    root->setName("Prepass Bench");
+    root->components.push_back(makePooled<Transform>(root, glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f)));
+    s->addObject(root);
+    const int ACROSS = 20, UP = 10;
+    for (int i = 0; i < COUNT; ++i)
+    {
+        // farthest row first
+        int row = COUNT / (ACROSS * UP) - i / (ACROSS * UP);
+        int x = i % ACROSS - ACROSS / 2, y = (i / ACROSS) % UP - UP / 2;
+        std::shared_ptr<Object> cube = makePooled<Object>(s);
+        glm::vec3 p(x * 1.5f + (row % 2) * 0.75f, 1000.0f + y * 1.5f, -20.0f - row * 2.0f);
+        cube->components.push_back(makePooled<Transform>(cube, p, glm::vec3(0.0f, i * 7.0f, 0.0f), glm::vec3(1.4f)));
+        cube->components.push_back(makePooled<CubeRenderer>(cube));
+        cube->reparent(root);
+    }
+
+    struct Setup {
+        const char* name;
+        bool sort, prepass;
+    };
+    const Setup setups[] = { { "unsorted", false, false }, { "front to back", true, false }, { "depth prepass", true, true } };
+    Scene::RenderPath previousPath = s->renderPath;
+    bool previousSort = s->sortFrontToBack, previousPrepass = s->depthPrepass;
+    s->renderPath = Scene::RenderPath::FORWARD;
+    for (auto& setup : setups)
+    {
+        s->sortFrontToBack = setup.sort;
+        s->depthPrepass = setup.prepass;
+        for (int i = 0; i < WARMUP_FRAMES; ++i)
+            frame(s);
+        glFinish();
+        Profiler::get().beginFrame();
+        Profiler::get().reset();
+
+        const int FRAMES = 30;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; ++i)
+            frame(s);
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Profiler::get().beginFrame();
+
+        // fragments shaded per covered pixel
+        s->overdrawView = true;
+        double layers = 0.0;
+        size_t covered = 0;
+        frame(s, [&layers, &covered, s]() {
+            int width, height;
+            glfwGetFramebufferSize(s->window, &width, &height);
+            std::vector<unsigned char> red(width * height);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadPixels(0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, red.data());
+            for (unsigned char r : red)
+                if (r)
+                {
+                    layers += r / 8.0;
+                    covered++;
+                }
+        });
+        s->overdrawView = false;
+
+        std::cout << "BENCH::PREPASS::" << setup.name << " (" << COUNT << " cubes)" << std::endl;
+        std::cout << "  overdraw: " << (covered ? layers / covered : 0.0) << " fragments shaded per covered pixel" << std::endl;
+        printProfile(ms / FRAMES);
+    }
+    s->renderPath = previousPath;
+    s->sortFrontToBack = previousSort;
+    s->depthPrepass = previousPrepass;
+    root->remove();
+    camera->position() = cameraPosition;
+    camera->rotation() = cameraRotation;
+    camera->savePrevious();
+    return true;
+}
+
+static bool benchShaders(std::shared_ptr<Scene> s, int frames)
+{
+    // this launch first, run it twice to compare an empty cache with a warm one
+    ShaderCache::Stats launch = ShaderCache::stats;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::SHADERS::" << (ShaderCache::available ? "program binaries available" : "no program binaries, everything compiles") << std::endl;
+    std::cout << "  startup: " << launch.buildMs << " ms building programs, " << launch.hits << " hits, " << launch.misses << " misses ("
+        << launch.stale << " stale, " << launch.rejected << " rejected), " << launch.stored << " stored" << std::endl;
+
+    // then every program again in process, compiled and from the cache
+    std::vector<std::shared_ptr<Shader>> all(s->shaders.begin(), s->shaders.end());
+    all.insert(all.end(), s->computeShaders.begin(), s->computeShaders.end());
+    auto rebuild = [&all](bool cached, unsigned int& linked) {
+        bool previous = ShaderCache::enabled;
+        ShaderCache::enabled = cached;
+        linked = 0;
+        std::vector<std::shared_ptr<Shader>> built;
+        auto start = std::chrono::steady_clock::now();
+        for (auto shader : all)
+            if (!shader->computePath.empty())
+                built.push_back(std::shared_ptr<Shader>(new Shader(shader->name, shader->computePath.c_str())));
+            else
+                built.push_back(std::shared_ptr<Shader>(new Shader(shader->name, shader->vertPath.c_str(), shader->fragPath.c_str(), shader->header)));
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        for (auto shader : built)
+        {
+            GLint status = GL_FALSE;
+            glGetProgramiv(shader->id, GL_LINK_STATUS, &status);
+            linked += status != GL_FALSE;
+        }
+        ShaderCache::enabled = previous;
+        return ms;
+    };
+    for (int i = 0; i < std::max(frames, 1); ++i)
+    {
+        unsigned int compiledLinked, cachedLinked;
+        ShaderCache::Stats before = ShaderCache::stats;
+        double compiledMs = rebuild(false, compiledLinked);
+        double cachedMs = rebuild(true, cachedLinked);
+        std::cout << "  " << all.size() << " programs: compiled " << compiledMs << " ms (" << compiledLinked << " linked), cached "
+            << cachedMs << " ms (" << cachedLinked << " linked, " << ShaderCache::stats.hits - before.hits << " hits)" << std::endl;
+    }
+
+    // a changed source can't come back from the cache
+    bool pass = true;
+    if (ShaderCache::available && !all.empty())
+    {
+        std::string source = "// changed\n";
+        unsigned int stale = ShaderCache::stats.stale;
+        GLuint program = ShaderCache::fetch(all[0]->name, ShaderCache::key(&source, 1));
+        bool invalidated = program == 0 && ShaderCache::stats.stale == stale + 1;
+        glDeleteProgram(program);
+        std::cout << "  changed source: " << (invalidated ? "stale, rebuilt" : "FAIL, served from the cache") << std::endl;
+        pass = invalidated;
+    }
+    return pass;
+}
+
+// untextured cubes filling the view away from the point lights and the
+// fog, drawn with the full shaders and with the variants built for them.
+// both should give the same picture
+static bool benchVariants(std::shared_ptr<Scene> s, int frames)
+{
+    const int COUNT = std::max(frames, 1) * 100;
+    auto camera = s->activeCamera->transform;
+    glm::vec3 cameraPosition = camera->position(), cameraRotation = camera->rotation();
+    camera->position() = glm::vec3(0.0f, 1000.0f, 0.0f);
+    camera->rotation() = glm::vec3(0.0f);
+    camera->savePrevious();
+
+    const glm::vec3 colors[] = { glm::vec3(0.8f, 0.2f, 0.2f), glm::vec3(0.2f, 0.8f, 0.2f), glm::vec3(0.2f, 0.2f, 0.8f), glm::vec3(0.8f, 0.8f, 0.2f) };
+    std::shared_ptr<Object> root = makePooled<Object>(s);
+    root->setName("Variants Bench");
+    root->components.push_back(makePooled<Transform>(root, glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f)));
+    s->addObject(root);
+    const int ACROSS = 20, UP = 10;
+    for (int i = 0; i < COUNT; ++i)
+    {
+        int row = i / (ACROSS * UP);
+        int x = i % ACROSS - ACROSS / 2, y = (i / ACROSS) % UP - UP / 2;
+        std::shared_ptr<Object> cube = makePooled<Object>(s);
+        glm::vec3 p(x * 1.5f + (row % 2) * 0.75f, 1000.0f + y * 1.5f, -20.0f - row * 2.0f);
+        cube->components.push_back(makePooled<Transform>(cube, p, glm::vec3(0.0f, i * 7.0f, 0.0f), glm::vec3(1.4f)));
+        std::shared_ptr<CubeRenderer> r = makePooled<CubeRenderer>(cube);
+        r->diffuseColor = colors[i % 4];
+        cube->components.push_back(r);
+        cube->reparent(root);
+    }
+
+    bool previous = s->shaderVariants;
+    const char* names[] = { "full shaders", "variants" };
+    for (int on = 0; on < 2; ++on)
+    {
+        s->shaderVariants = on;
+        unsigned int built = s->variantCount;
+        auto start = std::chrono::steady_clock::now();
+        frame(s);
+        glFinish();
+        double firstMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        for (int i = 0; i < WARMUP_FRAMES; ++i)
+            frame(s);
+        glFinish();
+        Profiler::get().beginFrame();
+        Profiler::get().reset();
+
+        const int FRAMES = 30;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; ++i)
+            frame(s);
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Profiler::get().beginFrame();
+
+        std::cout << "BENCH::VARIANTS::" << names[on] << " (" << COUNT << " cubes)" << std::endl;
+        std::cout << "  first frame " << firstMs << " ms, " << s->variantCount - built << " variants built" << std::endl;
+        printProfile(ms / FRAMES);
+    }
+
+    // the same moment drawn both ways, the sky and sun move between frames
+    std::vector<unsigned char> pictures[2];
+    s->shaderVariants = false;
+    frame(s, [&pictures, s]() {
+        int width, height;
+        glfwGetFramebufferSize(s->window, &width, &height);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        for (int on = 0; on < 2; ++on)
+        {
+            if (on)
+            {
+                s->shaderVariants = true;
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                s->render();
+            }
+            pictures[on].resize(width * height * 3);
+            glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pictures[on].data());
+        }
+    });
+    int maxDiff = 0;
+    size_t differing = 0;
+    for (size_t i = 0; i < pictures[0].size() && i < pictures[1].size(); ++i)
+    {
+        int d = std::abs((int)pictures[0][i] - (int)pictures[1][i]);
+        maxDiff = std::max(maxDiff, d);
+        differing += d > 1;
+    }
+    std::cout << "  picture: max difference " << maxDiff << ", " << differing << " values off by more than 1" << std::endl;
+
+    s->shaderVariants = previous;
+    root->remove();
+    camera->position() = cameraPosition;
+    camera->rotation() = cameraRotation;
+    camera->savePrevious();
+    return differing == 0;
+}
+
+static void copyFile(const std::string& from, const std::string& to, const std::string& append = "")
+{
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    out << in.rdbuf() << append;
+}
+
+// files added, changed, broken and removed in a watched folder, each step
+// checked once the reloader has applied it. frames is how many frames a
+// step gets to come through
+static bool benchReload(std::shared_ptr<Scene> s, int frames)
+{
+#ifdef __unix__
+    // a scratch folder of its own, the real assets are left alone
+    const std::string dir = "./reloadbench";
+    mkdir(dir.c_str(), 0755);
+    std::shared_ptr<AssetReloader> reloader(new AssetReloader());
+    std::shared_ptr<AssetReloader> previous = s->assetReloader;
+    s->assetReloader = reloader;
+    if (!reloader->start(dir))
+    {
+        s->assetReloader = previous;
+        rmdir(dir.c_str());
+        return true; // nothing to check
+    }
+    usleep(100000); // watch in place
+
+    // frames until count more files have been handed over (or frames of
+    // them, whatever didn't come through by then fails the step)
+    auto settle = [s, reloader, frames](unsigned int count) {
+        unsigned int target = reloader->reloaded + reloader->failed + reloader->removed + count;
+        for (int i = 0; i < std::max(frames, 1) && reloader->reloaded + reloader->failed + reloader->removed < target; ++i)
+        {
+            frame(s);
+            usleep(5000);
+        }
+    };
+    auto findShader = [s]() -> std::shared_ptr<Shader> {
+        for (auto shader : s->shaders)
+            if (shader->name == "benchshader")
+                return shader;
+        return nullptr;
+    };
+    auto findTexture = [s]() -> std::shared_ptr<Texture> {
+        for (auto texture : s->textures)
+            if (texture->name == "benchtex_nearest")
+                return texture;
+        return nullptr;
+    };
+    // benchrock-big is only there to be mixed up with benchrock
+    auto findMesh = [s](const std::string& model) -> std::shared_ptr<Mesh> {
+        std::string prefix = "importedmodel_" + model + "-";
+        for (auto mesh : s->meshes)
+            if (mesh->name.compare(0, prefix.size(), prefix) == 0 && mesh->name.size() > prefix.size()
+                && (mesh->name[prefix.size()] == 'c' || mesh->name[prefix.size()] == 'm')) // node path, -c<i>/-m<i>
+                return mesh;
+        return nullptr;
+    };
+    auto findBlueprint = [s]() -> std::shared_ptr<Object> {
+        for (auto blueprint : s->blueprints)
+            if (blueprint->getName() == "importedmodel_benchrock")
+                return blueprint;
+        return nullptr;
+    };
+    auto report = [reloader](const char* step, size_t from) {
+        std::cout << "  " << step << ":" << std::endl;
+        for (size_t i = from; i < reloader->history.size(); ++i)
+        {
+            auto& r = reloader->history[i];
+            std::cout << "    " << r.file << " " << (r.removed ? "removed" : r.ok ? "reloaded" : "FAILED")
+                << ", " << r.decodeMs << " ms decode, " << r.applyMs << " ms apply, " << r.latencyMs << " ms latency" << std::endl;
+        }
+    };
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "BENCH::RELOAD::debounce " << reloader->debounceMs << " ms" << std::endl;
+    bool pass = true;
+
+    // new files, imported like loadAssets would
+    copyFile("./res/shader/default/default.vert", dir + "/benchshader.vert");
+    copyFile("./res/shader/default/default.frag", dir + "/benchshader.frag");
+    copyFile("./res/tex/container-diffuse_nearest_border.png", dir + "/benchtex_nearest.png");
+    copyFile("./res/obj/Rock_1.fbx", dir + "/benchrock.fbx");
+    copyFile("./res/obj/Rock_1.fbx", dir + "/benchrock-big.fbx");
+    settle(5);
+    report("added", 0);
+    std::shared_ptr<Shader> shader = findShader();
+    std::shared_ptr<Texture> texture = findTexture();
+    std::shared_ptr<Mesh> mesh = findMesh("benchrock");
+    bool added = shader && shader->valid && texture && mesh && findBlueprint() && findMesh("benchrock-big");
+    std::cout << "  new assets in the scene: " << (added ? "yes" : "NO") << std::endl;
+    pass = pass && added;
+    if (added)
+    {
+        // changed, swapped inside the objects already holding them
+        size_t from = reloader->history.size();
+        GLuint program = shader->id, textureId = texture->ID;
+        GeometryArena::Handle geometry = mesh->getGeometry();
+        copyFile("./res/shader/default/default.frag", dir + "/benchshader.frag", "\n// changed\n");
+        copyFile("./res/tex/MarcDekamps_nearest_border.png", dir + "/benchtex_nearest.png");
+        copyFile("./res/obj/Rock_1.fbx", dir + "/benchrock.fbx");
+        settle(3);
+        s->textureStreamer->finish();
+        report("changed", from);
+        bool swapped = findShader() == shader && shader->id != program && findTexture() == texture && texture->resident && texture->ID != textureId
+            && findMesh("benchrock") == mesh && mesh->getGeometry() != geometry && mesh->indices() > 0;
+        std::cout << "  swapped in place: " << (swapped ? "yes" : "NO") << std::endl;
+        pass = pass && swapped;
+
+        // doesn't compile, the last good program stays
+        from = reloader->history.size();
+        program = shader->id;
+        unsigned int failed = reloader->failed;
+        std::ofstream(dir + "/benchshader.frag") << "#version 330 core\nvoid main() { not glsl }\n";
+        settle(1);
+        report("broken", from);
+        bool kept = reloader->failed == failed + 1 && shader->id == program && shader->valid;
+        std::cout << "  broken shader kept the old program: " << (kept ? "yes" : "NO") << std::endl;
+        pass = pass && kept;
+    }
+
+    // gone, they leave the asset lists. the texture is drawn with until
+    // the removal is queued and its user deleted just before the frame that
+    // applies it, the last frame's draws still hold it then
+    std::shared_ptr<Object> user;
+    if (texture)
+    {
+        user = makePooled<Object>(s);
+        user->components.push_back(makePooled<Transform>(user, glm::vec3(0.0f, 0.0f, -3.0f), glm::vec3(0.0f), glm::vec3(1.0f)));
+        std::shared_ptr<CubeRenderer> r = makePooled<CubeRenderer>(user);
+        r->mode = CubeRenderer::Mode::TEX_MAP;
+        r->diffuseTex = texture;
+        user->components.push_back(r);
+        s->addObject(user);
+        frame(s);
+    }
+    size_t from = reloader->history.size();
+    shader = nullptr;
+    texture = nullptr;
+    mesh = nullptr;
+    const char* files[] = { "benchshader.vert", "benchshader.frag", "benchtex_nearest.png", "benchrock.fbx" };
+    for (auto file : files)
+        unlink((dir + "/" + file).c_str());
+    if (user)
+    {
+        usleep((reloader->debounceMs + 200) * 1000); // queued, not applied
+        user->remove();
+        user = nullptr;
+    }
+    settle(4);
+    report("removed", from);
+    bool removed = !findShader() && !findTexture() && !findMesh("benchrock") && !findBlueprint();
+    std::shared_ptr<Mesh> big = findMesh("benchrock-big");
+    bool neighbour = big && big->indices() > 0;
+    big = nullptr;
+    std::cout << "  removed from the scene: " << (removed ? "yes" : "NO") << ", benchrock-big kept: " << (neighbour ? "yes" : "NO") << std::endl;
+    pass = pass && removed && neighbour;
+    unlink((dir + "/benchrock-big.fbx").c_str());
+    settle(1);
+
+    double worst = 0.0;
+    for (auto& r : reloader->history)
+        worst = std::max(worst, r.latencyMs);
+    std::cout << "  worst latency " << worst << " ms, " << (pass ? "PASS" : "FAIL") << std::endl;
+
+    reloader->stop();
+    s->assetReloader = previous;
+    rmdir(dir.c_str());
+    return pass;
+#else
+    return true;
+#endif
+}
+
+// big images loaded all at once, uploaded on the spot versus streamed.
+// frames is the most the streamed ones get to go in
+static bool benchStreaming(std::shared_ptr<Scene> s, int frames)
+{
+    const int COUNT = 4, SIZE = 2048;
+    auto makeImage = [](int seed) {
+        Texture::ImageData image;
+        image.width = image.height = SIZE;
+        image.colorChannels = 3;
+        image.format = GL_RGB;
+        image.pixelType = GL_UNSIGNED_BYTE;
+        unsigned char* data = new unsigned char[SIZE * SIZE * 3];
+        for (int i = 0; i < SIZE * SIZE * 3; ++i)
+            data[i] = (unsigned char)(i * 7 + seed * 31 + i / (SIZE * 3));
+        image.data = data;
+        image.free = [](void* d) { delete[] (unsigned char*)d; };
+        return image;
+    };
+    auto timeFrame = [s]() {
+        auto start = std::chrono::steady_clock::now();
+        frame(s);
+        glFinish();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    for (int i = 0; i < WARMUP_FRAMES; ++i)
+        frame(s);
+    double idleMs = 0.0;
+    for (int i = 0; i < 10; ++i)
+        idleMs += timeFrame() / 10;
+
+    // everything in one go on the main thread, like it used to load
+    std::vector<std::shared_ptr<Texture>> direct;
+    std::vector<Texture::ImageData> images;
+    for (int i = 0; i < COUNT; ++i)
+        images.push_back(makeImage(i));
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < COUNT; ++i)
+        direct.push_back(std::shared_ptr<Texture>(new Texture(images[i], GL_TEXTURE_2D, GL_LINEAR, GL_REPEAT)));
+    double directMs = timeFrame() + std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // streamed, the frames carry on while it goes in
+    std::vector<std::shared_ptr<Texture>> streamed;
+    for (int i = 0; i < COUNT; ++i)
+    {
+        streamed.push_back(std::shared_ptr<Texture>(new Texture(GL_TEXTURE_2D, GL_LINEAR, GL_REPEAT, glm::vec4(1.0f))));
+        s->textureStreamer->upload(streamed.back(), makeImage(i));
+    }
+    bool placeholders = true;
+    for (auto t : streamed)
+        placeholders = placeholders && !t->resident;
+    int streamFrames = 0;
+    double worstMs = 0.0, stallMs = 0.0;
+    size_t bytes = 0;
+    while (s->textureStreamer->pending() && streamFrames < std::max(frames, 1))
+    {
+        worstMs = std::max(worstMs, timeFrame());
+        stallMs += s->textureStreamer->stallMs;
+        bytes += s->textureStreamer->uploadedBytes;
+        streamFrames++;
+    }
+
+    // same pixels either way
+    bool same = true;
+    std::vector<unsigned char> a(SIZE * SIZE * 3), b(SIZE * SIZE * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    for (int i = 0; i < COUNT; ++i)
+    {
+        direct[i]->bind(GL_TEXTURE0);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, a.data());
+        streamed[i]->bind(GL_TEXTURE0);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, b.data());
+        same = same && streamed[i]->resident && a == b;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::STREAMING::" << COUNT << " textures of " << SIZE << "x" << SIZE << " ("
+        << (TextureStreamer::persistent ? "persistent mapping" : "mapped per frame") << ", "
+        << (s->textureStreamer->bytesPerFrame >> 10) << " KB a frame)" << std::endl;
+    std::cout << "  idle frame " << idleMs << " ms" << std::endl;
+    std::cout << "  direct upload: one " << directMs << " ms frame" << std::endl;
+    std::cout << "  streamed: " << streamFrames << " frames, worst " << worstMs << " ms, "
+        << bytes / (1024.0 * 1024.0) << " MB, stalled " << stallMs << " ms" << std::endl;
+    std::cout << "  placeholders until resident: " << (placeholders ? "yes" : "NO")
+        << ", same pixels: " << (same ? "yes" : "NO") << ", " << (placeholders && same ? "PASS" : "FAIL") << std::endl;
+    return placeholders && same;
+}
+
+static bool benchUi(std::shared_ptr<Scene> s, int frames)
+{
+    const size_t COUNT = std::max(frames, 1) * 1000;
+    std::vector<std::shared_ptr<Object>> added;
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        std::shared_ptr<Object> o = makePooled<Object>(s);
+        o->setName("UI Bench " + std::to_string(i));
+        s->addObject(o);
+        added.push_back(o);
+    }
+
+    const int FRAMES = 30;
+    s->renderUI(); // first frame builds whatever gets cached
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FRAMES; ++i)
+        s->renderUI();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+    // renaming one object changes the hierarchy, the next frame rebuilds
+    start = std::chrono::steady_clock::now();
+    added[0]->setName("UI Bench renamed");
+    s->renderUI();
+    double rebuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "BENCH::UI::" << s->objects.size() << " scene roots" << std::endl;
+    std::cout << "  ui: " << ms << " ms a frame, " << rebuildMs << " ms after a rename" << std::endl;
+    for (auto o : added)
+        o->remove();
+    return true;
+}
+
+struct Benchmarks {
+    const char* name;
+    bool (*bench)(std::shared_ptr<Scene>, int); // false if a check failed
+};
+static Benchmarks benchmarks[] = {
+    {"render", benchRender},
+    {"jobs", benchJobs},
+    {"scripts", benchScripts},
+    {"sim", benchSim},
+    {"leaks", benchLeaks},
+    {"clone", benchClone},
+    {"edit", benchEdit},
+    {"ecs", benchEcs},
+    {"prefab", benchPrefab},
+    {"scatter", benchScatter},
+    {"ui", benchUi},
+    {"batching", benchBatching},
+    {"arena", benchArena},
+    {"indirect", benchIndirect},
+    {"occlusion", benchOcclusion},
+    {"prepass", benchPrepass},
+    {"shaders", benchShaders},
+    {"variants", benchVariants},
+    {"reload", benchReload},
+    {"streaming", benchStreaming},
+};
+
+bool runBenchmark(std::shared_ptr<Scene> s, std::string name, int frames)
+{
+    for (auto& b : benchmarks)
+        if (name == b.name)
+        {
+            return b.bench(s, frames);
+        }
+
+    std::cout << "ERROR::BENCH::no benchmark called " << name << ", available:";
+    for (auto& b : benchmarks)
+        std::cout << " " << b.name;
+    std::cout << std::endl;
+    return false;
+}
\ No newline at end of file
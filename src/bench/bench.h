@@ -0,0 +1,12 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+class Scene;
+
+// benchmark harness, run with: prog --bench <name> [frames]
+// benchmarks run against the loaded scene and print their results to stdout
+// returns false if there is no benchmark with that name or one of its
+// checks failed
+bool runBenchmark(std::shared_ptr<Scene> s, std::string name, int frames = 300);
\ No newline at end of file
@@ -21,6 +21,16 @@
 #include <ui/objectHierarchy.h>
 #include <ui/assets.h>
 
+#include <util/profiler.h>
+#include <util/jobSystem.h>
+#include <util/gl43.h>
+#include <util/geometryArena.h>
+#include <util/shaderCache.h>
+#include <util/textureStreamer.h>
+#include <bench/bench.h>
+
+#include <string>
+
 // stb implementation
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -43,15 +53,43 @@ std::shared_ptr<Scene> loadScene(GLFWwindow* w) {
     return s;
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // command line: --bench <name> [frames], --workers <count> (default one per core),
+    // --gl33 (skip the 4.3 context, no indirect drawing)
+    std::string benchName = "";
+    int benchFrames = 300;
+    int workers = -1;
+    bool gl33 = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--bench" && i + 1 < argc)
+        {
+            benchName = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                benchFrames = std::stoi(argv[++i]);
+        }
+        else if (arg == "--workers" && i + 1 < argc)
+            workers = std::stoi(argv[++i]);
+        else if (arg == "--gl33")
+            gl33 = true;
+    }
+
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+    // 4.3 for indirect drawing and compute culling if the driver has it,
+    // everything else only needs 3.3
     const auto mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
-    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Computer Graphics Coursework 2", glfwGetPrimaryMonitor(), NULL);
+    GLFWwindow* window = NULL;
+    const int versions[][2] = { { 4, 3 }, { 3, 3 } };
+    for (int v = gl33 ? 1 : 0; v < 2 && window == NULL; ++v)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, versions[v][0]);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, versions[v][1]);
+        window = glfwCreateWindow(mode->width, mode->height, "Computer Graphics Coursework 2", glfwGetPrimaryMonitor(), NULL);
+    }
     if (window == NULL)
     {
         std::cout << "ERROR::GLFW::cannot create glfw window" << std::endl;
@@ -61,6 +99,14 @@ int main()
     glfwMakeContextCurrent(window);
 
     gladLoadGL();
+    // drivers can hand out a newer context than asked for, --gl33 has to
+    // stay off the 4.3 paths anyway
+    if (!gl33)
+    {
+        GL43::load((GLADloadproc)glfwGetProcAddress);
+        TextureStreamer::load((GLADloadproc)glfwGetProcAddress);
+    }
+    ShaderCache::load((GLADloadproc)glfwGetProcAddress);
     glViewport(0, 0, mode->width, mode->height);
     glEnable(GL_DEPTH_TEST);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -71,21 +117,46 @@ int main()
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 150");
 
+    JobSystem::get().start(workers);
     std::shared_ptr<Scene> scene = loadScene(window);
 
+    if (benchName != "")
+    {
+        glfwSwapInterval(0); // don't time vsync
+        int result = runBenchmark(scene, benchName, benchFrames) ? 0 : -1;
+        scene = nullptr;
+        GeometryArena::shutdown();
+        JobSystem::get().stop();
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return result;
+    }
+
+    // pick up asset changes while the editor is open
+    scene->assetReloader->start("./res");
+
     while (!glfwWindowShouldClose(window))
     {
+        Profiler::get().beginFrame();
         glfwPollEvents();
         glClearColor(scene->backgroundColor.r, scene->backgroundColor.g, scene->backgroundColor.b, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        JobSystem::get().runMainThreadJobs();
         scene->update();
         scene->render();
         scene->renderUI();
+        JobSystem::get().publishStats();
 
         glfwSwapBuffers(window);
     }
 
+    scene = nullptr; // frees GL objects, the context has to still be around
+    GeometryArena::shutdown();
+    JobSystem::get().stop();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
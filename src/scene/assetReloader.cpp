@@ -0,0 +1,268 @@
+#include "assetReloader.h"
+
+#include <scene/scene.h>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <iostream>
+#include <sstream>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+AssetFile::AssetFile(const std::string& file) : file(file)
+{
+    std::stringstream ss(file);
+
+    // process all dir seps
+    while (std::getline(ss, name, '/'));
+    while (std::getline(ss, name, '\\'));
+    ss = std::stringstream(name);
+
+    // get name and extension
+    name = "";
+    while (std::getline(ss, ext, '.')) {
+        name += ext;
+        std::getline(ss, ext, '.');
+    }
+}
+
+bool AssetFile::isImage(const std::string& ext)
+{
+    return ext == "jpg" || ext == "jpeg" || ext == "png" || ext == "bmp" || ext == "tga" || ext == "psd";
+}
+bool AssetFile::isModel(const std::string& ext)
+{
+    return ext == "blend" || ext == "obj" || ext == "fbx";
+}
+bool AssetFile::isShader(const std::string& ext)
+{
+    return ext == "vert" || ext == "frag" || ext == "comp";
+}
+
+void AssetFile::decode()
+{
+    if (isImage(ext))
+        image = Texture::loadFromFile(file.c_str());
+    else if (isModel(ext))
+    {
+        importer = std::shared_ptr<Assimp::Importer>(new Assimp::Importer());
+        importedScene = importer->ReadFile(file, aiProcess_Triangulate | aiProcess_FlipUVs);
+    }
+}
+
+void AssetFile::release()
+{
+    Texture::freeImage(image);
+    importer = nullptr;
+    importedScene = nullptr;
+}
+
+AssetReloader::~AssetReloader()
+{
+    stop();
+}
+
+bool AssetReloader::start(const std::string& path)
+{
+    stop();
+#ifdef __linux__
+    watching = true;
+    thread = std::thread(&AssetReloader::watch, this, path);
+    return true;
+#else
+    std::cout << "WARN::HOT_RELOAD::no file watching on this platform, assets won't reload" << std::endl;
+    return false;
+#endif
+}
+
+void AssetReloader::stop()
+{
+    watching = false;
+    if (thread.joinable())
+        thread.join();
+    for (auto& r : ready)
+        r.asset.release();
+    ready.clear();
+    kept.clear();
+}
+
+void AssetReloader::apply(Scene* s)
+{
+    std::vector<Ready> batch;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        batch.swap(ready);
+    }
+    if (batch.empty() && kept.empty())
+        return;
+
+    // held back removals go first, unless the file has changed again since
+    std::vector<Ready> todo;
+    for (auto& r : kept)
+    {
+        bool superseded = false;
+        for (auto& b : batch)
+            superseded = superseded || b.asset.file == r.asset.file;
+        if (!superseded)
+            todo.push_back(r);
+    }
+    kept.clear();
+    todo.insert(todo.end(), batch.begin(), batch.end());
+
+    for (auto& r : todo)
+    {
+        Clock::time_point start = Clock::now();
+        bool ok = true;
+        if (!r.removed)
+            ok = s->reloadAsset(r.asset);
+        else if (!s->removeAsset(r.asset))
+        {
+            if (!r.held)
+                std::cout << "WARN::HOT_RELOAD::" << r.asset.file << "::removed but still in use, kept until it isn't" << std::endl;
+            r.held = true;
+            kept.push_back(r);
+            continue;
+        }
+        r.asset.release();
+        Clock::time_point end = Clock::now();
+
+        if (r.removed)
+            removed++;
+        else if (ok)
+            reloaded++;
+        else
+            failed++;
+        history.push_back({ r.asset.file, r.removed, ok, r.decodeMs,
+            std::chrono::duration<double, std::milli>(end - start).count(),
+            std::chrono::duration<double, std::milli>(end - r.firstChange).count() });
+        if (history.size() > HISTORY)
+            history.pop_front();
+    }
+}
+
+#ifdef __linux__
+static const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE;
+
+// path and the folders under it, watch descriptors to folder paths
+static void addWatches(int fd, const std::string& path, std::map<int, std::string>& folders)
+{
+    int wd = inotify_add_watch(fd, path.c_str(), WATCH_MASK);
+    if (wd < 0)
+    {
+        std::cout << "WARN::HOT_RELOAD::can't watch " << path << std::endl;
+        return;
+    }
+    folders[wd] = path;
+    DIR* dir = opendir(path.c_str());
+    if (!dir)
+        return;
+    while (dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..")
+            continue;
+        std::string child = path + "/" + name;
+        struct stat st;
+        if (stat(child.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+            addWatches(fd, child, folders);
+    }
+    closedir(dir);
+}
+
+void AssetReloader::watch(std::string path)
+{
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cout << "WARN::HOT_RELOAD::inotify unavailable, assets won't reload" << std::endl;
+        watching = false;
+        return;
+    }
+    std::map<int, std::string> folders;
+    addWatches(fd, path, folders);
+
+    // files with events that haven't settled yet
+    struct Change {
+        Clock::time_point first, last;
+    };
+    std::map<std::string, Change> changes;
+
+    alignas(inotify_event) char buffer[4096];
+    while (watching)
+    {
+        // short timeout so stop() doesn't wait long
+        pollfd p = { fd, POLLIN, 0 };
+        if (poll(&p, 1, 20) > 0)
+        {
+            ssize_t length;
+            while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+                for (char* at = buffer; at < buffer + length; at += sizeof(inotify_event) + ((inotify_event*)at)->len)
+                {
+                    inotify_event* event = (inotify_event*)at;
+                    if (event->mask & IN_IGNORED)
+                    { // folder gone
+                        folders.erase(event->wd);
+                        continue;
+                    }
+                    auto folder = folders.find(event->wd);
+                    if (folder == folders.end() || !event->len)
+                        continue;
+                    std::string file = folder->second + "/" + event->name;
+                    if (event->mask & IN_ISDIR)
+                    {
+                        if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                            addWatches(fd, file, folders);
+                        continue;
+                    }
+                    if (event->mask & IN_CREATE)
+                        continue; // written later, close_write follows
+                    AssetFile asset(file);
+                    if (!AssetFile::isImage(asset.ext) && !AssetFile::isModel(asset.ext) && !AssetFile::isShader(asset.ext))
+                        continue;
+                    Clock::time_point now = Clock::now();
+                    auto it = changes.find(file);
+                    if (it == changes.end())
+                        changes[file] = { now, now };
+                    else
+                        it->second.last = now;
+                }
+        }
+
+        // whatever has been quiet long enough. whether it was changed or
+        // removed is whatever the disk says now, a save that replaces the
+        // file shows up as both
+        Clock::time_point now = Clock::now();
+        for (auto it = changes.begin(); it != changes.end();)
+        {
+            if (now - it->second.last < std::chrono::milliseconds(debounceMs))
+            {
+                ++it;
+                continue;
+            }
+            Ready r;
+            r.asset = AssetFile(it->first);
+            r.firstChange = it->second.first;
+            r.removed = access(it->first.c_str(), F_OK) != 0;
+            Clock::time_point start = Clock::now();
+            if (!r.removed)
+                r.asset.decode();
+            r.decodeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                ready.push_back(r);
+            }
+            it = changes.erase(it);
+        }
+    }
+    close(fd);
+}
+#else
+void AssetReloader::watch(std::string path) {}
+#endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <util/texture.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Scene;
+namespace Assimp { class Importer; }
+struct aiScene;
+
+// one asset file on its way in. decode() is the part of the import that
+// doesn't touch GL (image decoding, model parsing) so it can run on any
+// thread, the GL objects are made on the main thread afterwards
+struct AssetFile {
+    AssetFile() {}
+    explicit AssetFile(const std::string& file); // name and ext from the path
+
+    std::string file, name, ext;
+    Texture::ImageData image = {};
+    std::shared_ptr<Assimp::Importer> importer; // owns the imported scene
+    const aiScene* importedScene = nullptr;
+    void decode();
+    void release(); // the decoded data, if nothing took it
+
+    static bool isImage(const std::string& ext);
+    static bool isModel(const std::string& ext);
+    static bool isShader(const std::string& ext);
+};
+
+// hot reload
+// a thread watches the asset folder (inotify, so linux only) and picks up
+// files that are written, moved in, moved out or deleted. once a file has
+// been quiet for debounceMs (editors save in several steps) it is decoded
+// on that thread and queued, apply() hands the queue to the scene on the
+// main thread at the start of a frame (Scene::reloadAsset / removeAsset).
+// a removed file whose asset is still in use is tried again every frame
+// until it isn't (or the file comes back)
+class AssetReloader {
+public:
+    ~AssetReloader();
+
+    // watch path and every folder under it (folders made later too). false
+    // if there's no file watching here, nothing reloads
+    bool start(const std::string& path = "./res");
+    void stop();
+    size_t waiting() { return kept.size(); } // removals held back by users
+    bool running() { return watching.load(); }
+
+    // main thread, once a frame before anything draws
+    void apply(Scene* s);
+
+    unsigned int debounceMs = 100;
+
+    // the last HISTORY files handed to the scene, newest last
+    struct Reload {
+        std::string file;
+        bool removed;
+        bool ok;          // false if the old version was kept
+        double decodeMs;  // watcher thread
+        double applyMs;   // main thread
+        double latencyMs; // first change seen to applied
+    };
+    static const size_t HISTORY = 16;
+    std::deque<Reload> history;
+    unsigned int reloaded = 0, failed = 0, removed = 0;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    struct Ready {
+        AssetFile asset;
+        bool removed;
+        bool held = false; // in kept before
+        Clock::time_point firstChange;
+        double decodeMs;
+    };
+    void watch(std::string path);
+
+    std::thread thread;
+    std::atomic<bool> watching{ false };
+    std::mutex lock;
+    std::vector<Ready> ready;
+    std::vector<Ready> kept; // removed but still in use, main thread only
+};
\ No newline at end of file
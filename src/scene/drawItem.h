@@ -0,0 +1,24 @@
+#pragma once
+
+#include <util/aabb.h>
+
+#include <glm/glm.hpp>
+
+class Renderer;
+
+// one renderer in the scene, gathered once per frame so passes can cull
+// without walking the object tree again
+struct DrawItem {
+    DrawItem(Renderer* renderer, const glm::mat4& model, const AABB& bounds, bool isStatic)
+        : renderer(renderer), model(model), bounds(bounds), isStatic(isStatic),
+        visible(true), indirect(false), occluded(false), features(0) {}
+
+    Renderer* renderer;
+    glm::mat4 model;
+    AABB bounds; // world space, invalid if the renderer has no bounds (never culled)
+    bool isStatic; // object (or a parent) is marked static
+    bool visible; // inside the camera frustum this frame
+    bool indirect; // drawn by IndirectDraws (culled on the gpu), skipped by the cpu passes
+    bool occluded; // hidden behind an occluder from the camera (OcclusionCuller), shadows still draw it
+    unsigned int features; // Shader::Feature bits this draw needs, set before the camera passes
+};
\ No newline at end of file
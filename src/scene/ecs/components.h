@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class Object;
+class Renderer;
+class Light;
+
+// what the scene keeps in its World. Transform's data lives here for good
+// (the Transform component is a view onto it), lights and renderers are
+// listed here so the systems can find them without walking the tree
+
+struct TransformData {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f); // euler, degrees
+    glm::vec3 scale = glm::vec3(1.0f);
+    glm::vec3 previousPosition = glm::vec3(0.0f);
+    glm::vec3 previousRotation = glm::vec3(0.0f);
+    glm::vec3 previousScale = glm::vec3(1.0f);
+    glm::mat4 worldMatrix = glm::mat4(1.0f);
+    Object* object = nullptr; // for the static flag
+    bool isStatic = false; // object or a parent is static, as of the last world matrix pass
+};
+
+// tag, the object hangs off the scene's objects (blueprints and detached
+// objects don't have it, so they're not updated or drawn)
+struct InScene {
+    char unused = 0;
+};
+
+struct LightRef {
+    Light* light = nullptr;
+};
+
+// an object can have a few renderers (rare, but the inspector allows it).
+// past INLINE they go in overflow, kept on the heap so the component stays
+// plain data. Renderer adds and removes itself and frees it once it's empty
+struct RendererSet {
+    static const unsigned int INLINE = 4;
+    Renderer* renderers[INLINE] = { nullptr, nullptr, nullptr, nullptr };
+    unsigned int count = 0;
+    std::vector<Renderer*>* overflow = nullptr;
+
+    Renderer*& at(unsigned int i) { return i < INLINE ? renderers[i] : (*overflow)[i - INLINE]; }
+};
+
+// the object is a prefab instance (or an overridden part of one) and draws
+// the rest of its blueprint
+struct PrefabRef {
+    Object* object = nullptr;
+};
\ No newline at end of file
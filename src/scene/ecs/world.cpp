@@ -0,0 +1,174 @@
+#include "world.h"
+
+#include <algorithm>
+#include <iostream>
+
+size_t World::typeSizes[World::MAX_TYPES];
+unsigned int World::typeCount = 0;
+
+unsigned int World::registerType(size_t size)
+{
+    if (typeCount == MAX_TYPES)
+    {
+        std::cout << "ERROR::WORLD::too many component types" << std::endl;
+        return MAX_TYPES - 1;
+    }
+    typeSizes[typeCount] = size;
+    return typeCount++;
+}
+
+World::~World()
+{
+    for (auto& a : archetypeList)
+        for (char* chunk : a->chunkData)
+            ::operator delete(chunk);
+}
+
+Entity World::create()
+{
+    Entity e;
+    if (!freeRecords.empty())
+    {
+        e.index = freeRecords.back();
+        freeRecords.pop_back();
+    }
+    else
+    {
+        e.index = records.size();
+        records.push_back(Record());
+    }
+    e.generation = records[e.index].generation;
+    push(e, archetype(0));
+    liveCount++;
+    version++;
+    return e;
+}
+
+void World::destroy(Entity e)
+{
+    if (!alive(e))
+        return;
+    pop(e);
+    Record& r = records[e.index];
+    r.archetype = nullptr;
+    r.parent = Entity();
+    if (++r.generation == 0)
+        r.generation = 1;
+    freeRecords.push_back(e.index);
+    liveCount--;
+    version++;
+}
+
+void World::setParent(Entity e, Entity parent)
+{
+    if (!alive(e) || records[e.index].parent == parent)
+        return;
+    records[e.index].parent = parent;
+    version++;
+}
+
+World::Archetype* World::archetype(unsigned int mask)
+{
+    for (auto& a : archetypeList)
+        if (a->mask == mask)
+            return a.get();
+
+    // lay out a chunk: entity ids, then every column back to back
+    std::unique_ptr<Archetype> a(new Archetype());
+    a->mask = mask;
+    size_t rowSize = sizeof(Entity);
+    for (unsigned int t = 0; t < MAX_TYPES; ++t)
+    {
+        a->columnOf[t] = -1;
+        if (mask & (1u << t))
+        {
+            a->columnOf[t] = a->types.size();
+            a->types.push_back(t);
+            a->sizes.push_back(typeSizes[t]);
+            rowSize += typeSizes[t];
+        }
+    }
+    a->capacity = std::max((size_t)1, CHUNK_BYTES / rowSize);
+    size_t offset = a->capacity * sizeof(Entity);
+    for (size_t c = 0; c < a->types.size(); ++c)
+    {
+        offset = (offset + 15) & ~(size_t)15;
+        a->offsets.push_back(offset);
+        offset += a->capacity * a->sizes[c];
+    }
+    archetypeList.push_back(std::move(a));
+    return archetypeList.back().get();
+}
+
+void World::push(Entity e, Archetype* a)
+{
+    size_t chunk = a->count / a->capacity;
+    if (chunk == a->chunkData.size())
+    {
+        size_t bytes = a->offsets.empty() ? a->capacity * sizeof(Entity) : a->offsets.back() + a->capacity * a->sizes.back();
+        a->chunkData.push_back((char*)::operator new(bytes));
+        a->chunkCount.push_back(0);
+    }
+    size_t row = a->chunkCount[chunk]++;
+    a->entities(chunk)[row] = e;
+    a->count++;
+
+    Record& r = records[e.index];
+    r.archetype = a;
+    r.chunk = chunk;
+    r.row = row;
+}
+
+void World::pop(Entity e)
+{
+    // fill the hole with the archetype's last row so chunks stay dense
+    Record& r = records[e.index];
+    Archetype* a = r.archetype;
+    size_t lastChunk = (a->count - 1) / a->capacity;
+    size_t lastRow = a->chunkCount[lastChunk] - 1;
+    if (lastChunk != r.chunk || lastRow != r.row)
+    {
+        Entity moved = a->entities(lastChunk)[lastRow];
+        a->entities(r.chunk)[r.row] = moved;
+        for (size_t c = 0; c < a->types.size(); ++c)
+            memcpy(a->column(r.chunk, c) + r.row * a->sizes[c], a->column(lastChunk, c) + lastRow * a->sizes[c], a->sizes[c]);
+        records[moved.index].chunk = r.chunk;
+        records[moved.index].row = r.row;
+    }
+    a->chunkCount[lastChunk]--;
+    a->count--;
+}
+
+void* World::move(Entity e, unsigned int mask, unsigned int type, const void* value)
+{
+    Record& r = records[e.index];
+    Archetype* from = r.archetype;
+    if (from->mask == mask)
+        return nullptr;
+    Archetype* to = archetype(mask);
+    size_t fromChunk = r.chunk, fromRow = r.row;
+
+    // claim the new row before giving up the old one, the shared columns are
+    // copied across in between
+    Record old = r;
+    push(e, to);
+    for (size_t c = 0; c < to->types.size(); ++c)
+    {
+        int source = from->columnOf[to->types[c]];
+        char* dst = to->column(r.chunk, c) + r.row * to->sizes[c];
+        if (source >= 0)
+            memcpy(dst, from->column(fromChunk, source) + fromRow * to->sizes[c], to->sizes[c]);
+        else if (to->types[c] == type && value)
+            memcpy(dst, value, to->sizes[c]);
+    }
+    Record added = r;
+    r = old;
+    pop(e);
+    records[e.index].archetype = added.archetype;
+    records[e.index].chunk = added.chunk;
+    records[e.index].row = added.row;
+    version++;
+
+    int column = to->columnOf[type];
+    return column >= 0 ? to->column(added.chunk, column) + added.row * to->sizes[column] : nullptr;
+}
\ No newline at end of file
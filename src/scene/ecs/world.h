@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// entity id, same idea as ObjectHandle: the slot only resolves while the
+// generation matches, so destroyed entities can't be confused with new ones
+struct Entity {
+    unsigned int index = 0;
+    unsigned int generation = 0; // 0 = null entity
+
+    bool valid() const { return generation != 0; }
+    bool operator == (const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator != (const Entity& other) const { return !(*this == other); }
+};
+
+// archetype storage. entities with the same set of component types live in
+// the same archetype, which keeps each component type in its own tightly
+// packed column, split into fixed size chunks. systems ask for a set of
+// types and only walk the chunks that have all of them, no type tests.
+// components are plain data (trivially copyable), adding or removing one
+// moves the entity's row to another archetype so pointers into a column are
+// only good until the next structural change (create / destroy / add /
+// remove / setParent). structural changes are main thread only, reading and
+// writing existing components from jobs is fine
+class World {
+public:
+    static const unsigned int MAX_TYPES = 32;
+    static const size_t CHUNK_BYTES = 16 * 1024;
+    struct Archetype;
+
+    World() {}
+    World(const World& other) = delete;
+    ~World();
+
+    Entity create();
+    void destroy(Entity e);
+    bool alive(Entity e) const { return e.index < records.size() && records[e.index].generation == e.generation && e.valid(); }
+    size_t size() const { return liveCount; }
+    size_t capacity() const { return records.size(); } // highest entity index + 1
+    void reserve(size_t entities) { records.reserve(entities); }
+
+    // parent entity, the object hierarchy (transforms chain through it)
+    void setParent(Entity e, Entity parent);
+    Entity parent(Entity e) const { return alive(e) ? records[e.index].parent : Entity(); }
+
+    template <typename T> T* add(Entity e, const T& value = T());
+    template <typename T> void remove(Entity e) { if (alive(e)) move(e, records[e.index].archetype->mask & ~bit<T>(), typeId<T>(), nullptr); }
+    template <typename T> bool has(Entity e) const { return alive(e) && (records[e.index].archetype->mask & bit<T>()); }
+    template <typename T> T* get(Entity e)
+    {
+        if (!alive(e))
+            return nullptr;
+        const Record& r = records[e.index];
+        int column = r.archetype->columnOf[typeId<T>()];
+        if (column < 0)
+            return nullptr;
+        return (T*)r.archetype->column(r.chunk, column) + r.row;
+    }
+
+    // fn(size_t count, Entity* entities, A* a, B* b, ...) once for every
+    // chunk that has all the listed components
+    template <typename... Cs, typename F> void each(F fn);
+
+    // same, chunk by chunk, as a flat list (to split over jobs)
+    struct ChunkRef {
+        Archetype* archetype;
+        size_t chunk;
+    };
+    template <typename... Cs> std::vector<ChunkRef> chunks();
+    template <typename... Cs, typename F> void each(const ChunkRef& ref, F fn);
+
+    // bumps on every structural change, systems use it to know when cached
+    // orderings have to be rebuilt
+    unsigned long long version = 0;
+
+    // type ids are handed out on first use, at most MAX_TYPES of them
+    template <typename T> static unsigned int typeId()
+    {
+        static const unsigned int id = registerType(sizeof(T));
+        return id;
+    }
+    template <typename T> static unsigned int bit() { return 1u << typeId<T>(); }
+
+    struct Archetype {
+        unsigned int mask = 0;
+        std::vector<unsigned int> types;   // type ids, in column order
+        std::vector<size_t> sizes;         // per column
+        std::vector<size_t> offsets;       // per column, into a chunk
+        int columnOf[MAX_TYPES];           // type id -> column, -1 if missing
+        size_t capacity = 0;               // rows per chunk
+        std::vector<char*> chunkData;      // entities first, then each column
+        std::vector<size_t> chunkCount;
+        size_t count = 0;                  // rows over all chunks (dense, only the last chunk has holes)
+
+        Entity* entities(size_t chunk) { return (Entity*)chunkData[chunk]; }
+        char* column(size_t chunk, int column) { return chunkData[chunk] + offsets[column]; }
+    };
+    const std::vector<std::unique_ptr<Archetype>>& archetypes() const { return archetypeList; }
+
+private:
+    struct Record {
+        unsigned int generation = 1;
+        Archetype* archetype = nullptr;
+        size_t chunk = 0;
+        size_t row = 0;
+        Entity parent;
+    };
+
+    static unsigned int registerType(size_t size);
+    static size_t typeSizes[MAX_TYPES];
+    static unsigned int typeCount;
+
+    Archetype* archetype(unsigned int mask);
+    void push(Entity e, Archetype* a);
+    void pop(Entity e);
+    // move e to the archetype with mask, copying the shared columns. value
+    // fills the column of type if it's being added
+    void* move(Entity e, unsigned int mask, unsigned int type, const void* value);
+
+    std::vector<Record> records;
+    std::vector<unsigned int> freeRecords;
+    std::vector<std::unique_ptr<Archetype>> archetypeList;
+    size_t liveCount = 0;
+};
+
+template <typename T>
+T* World::add(Entity e, const T& value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "world components are plain data");
+    if (!alive(e))
+        return nullptr;
+    T* existing = get<T>(e);
+    if (existing)
+    {
+        *existing = value;
+        return existing;
+    }
+    return (T*)move(e, records[e.index].archetype->mask | bit<T>(), typeId<T>(), &value);
+}
+
+template <typename... Cs, typename F>
+void World::each(F fn)
+{
+    unsigned int mask = 0;
+    unsigned int bits[] = { 0u, bit<Cs>()... };
+    for (unsigned int b : bits)
+        mask |= b;
+    for (auto& a : archetypeList)
+        if ((a->mask & mask) == mask)
+            for (size_t c = 0; c < a->chunkData.size(); ++c)
+                if (a->chunkCount[c])
+                    fn(a->chunkCount[c], a->entities(c), (Cs*)a->column(c, a->columnOf[typeId<Cs>()])...);
+}
+
+template <typename... Cs>
+std::vector<World::ChunkRef> World::chunks()
+{
+    unsigned int mask = 0;
+    unsigned int bits[] = { 0u, bit<Cs>()... };
+    for (unsigned int b : bits)
+        mask |= b;
+    std::vector<ChunkRef> refs;
+    for (auto& a : archetypeList)
+        if ((a->mask & mask) == mask)
+            for (size_t c = 0; c < a->chunkData.size(); ++c)
+                if (a->chunkCount[c])
+                    refs.push_back({ a.get(), c });
+    return refs;
+}
+
+template <typename... Cs, typename F>
+void World::each(const ChunkRef& ref, F fn)
+{
+    Archetype* a = ref.archetype;
+    fn(a->chunkCount[ref.chunk], a->entities(ref.chunk), (Cs*)a->column(ref.chunk, a->columnOf[typeId<Cs>()])...);
+}
\ No newline at end of file
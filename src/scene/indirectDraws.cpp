@@ -0,0 +1,272 @@
+#include "indirectDraws.h"
+
+#include <scene/scene.h>
+#include <scene/shadowCascades.h>
+#include <scene/object/components/camera.h>
+#include <scene/object/components/renderer/renderer.h>
+#include <util/geometryArena.h>
+#include <util/gl43.h>
+#include <util/texture.h>
+#include <util/frustum.h>
+#include <util/profiler.h>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <map>
+#include <tuple>
+
+IndirectDraws::~IndirectDraws()
+{
+    if (arena && idBuffer)
+        arena->setInstanceIds(0, 3);
+    glDeleteBuffers(1, &instanceBuffer);
+    glDeleteBuffers(1, &commandBuffer);
+    glDeleteBuffers(1, &idBuffer);
+}
+
+bool IndirectDraws::supported(Scene* s)
+{
+    if (!GL43::available)
+        return false;
+    if (!cullShader)
+        for (auto shader : s->computeShaders)
+            if (shader->name == "cull")
+                cullShader = shader;
+    return cullShader != nullptr;
+}
+
+void IndirectDraws::reserve(size_t count)
+{
+    if (count <= capacity)
+        return;
+    capacity = 1024;
+    while (capacity < count)
+        capacity *= 2;
+
+    if (!instanceBuffer)
+    {
+        glGenBuffers(1, &instanceBuffer);
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &idBuffer);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, VIEWS * capacity * COMMAND_SIZE, nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // baseInstance n reads n out of this, the vertex shaders' record index
+    std::vector<GLfloat> ids(capacity);
+    for (size_t i = 0; i < capacity; ++i)
+        ids[i] = (GLfloat)i;
+    glBindBuffer(GL_ARRAY_BUFFER, idBuffer);
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(GLfloat), ids.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    arena = GeometryArena::standard();
+    arena->setInstanceIds(idBuffer, 3);
+}
+
+void IndirectDraws::build(Scene* s, std::vector<DrawItem>& drawList, const std::vector<unsigned int>& order, std::shared_ptr<Shader> depthShader)
+{
+    instances.clear();
+    groups.clear();
+    instanceCount = 0;
+    groupCount = 0;
+    if (!enabled || !supported(s))
+        return;
+
+    // group by shader, textures and shader features, everything else is
+    // per instance
+    typedef std::tuple<Shader*, Texture*, Texture*, unsigned int> Key;
+    std::map<Key, unsigned int> groupOf;
+    std::vector<std::pair<unsigned int, unsigned int>> members; // group, draw list index
+    bool depthIndirect = !depthShader || depthShader->indirectVariant;
+    for (unsigned int i : order)
+    {
+        DrawItem& item = drawList[i];
+        GeometryArena::Handle geometry = item.renderer->arenaGeometry();
+        BatchMaterial material;
+        const void* key = nullptr;
+        if (!geometry || !depthIndirect || !item.renderer->batchSource(material, key))
+            continue;
+        std::shared_ptr<Shader> shader = material.shader;
+        if (!shader || !shader->indirectVariant || (shader->gbufferVariant && !shader->gbufferVariant->indirectVariant))
+            continue;
+
+        Key k(shader.get(), material.diffuseTex.get(), material.specularTex.get(), item.features);
+        auto it = groupOf.find(k);
+        if (it == groupOf.end())
+        {
+            it = groupOf.insert(std::make_pair(k, (unsigned int)groups.size())).first;
+            groups.push_back({ shader, material.diffuseTex, material.specularTex, item.features, 0, 0 });
+        }
+        groups[it->second].count++;
+        members.push_back({ it->second, i });
+
+        Instance instance;
+        instance.model = item.model;
+        instance.diffuse = glm::vec4(material.diffuseColor, material.shininess);
+        instance.specular = glm::vec4(material.specularColor, 0.0f);
+        instance.boundsMin = glm::vec4(item.bounds.min, item.bounds.valid() ? 1.0f : 0.0f);
+        instance.boundsMax = glm::vec4(item.bounds.max, item.isStatic ? 1.0f : 0.0f);
+        const GeometryArena::Range& range = GeometryArena::standard()->range(geometry);
+        instance.draw = glm::uvec4(range.indexCount, range.firstIndex, (GLuint)range.baseVertex, item.occluded ? 1 : 0);
+        instances.push_back(instance);
+
+        // off the cpu path
+        item.indirect = true;
+        item.visible = false;
+    }
+    if (instances.empty())
+        return;
+
+    // lay the groups out back to back
+    unsigned int offset = 0;
+    for (auto& group : groups)
+    {
+        group.first = offset;
+        offset += group.count;
+        group.count = 0;
+    }
+    std::vector<Instance> sorted(instances.size());
+    for (size_t m = 0; m < members.size(); ++m)
+    {
+        Group& group = groups[members[m].first];
+        sorted[group.first + group.count++] = instances[m];
+    }
+    instances.swap(sorted);
+
+    reserve(instances.size());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, instances.size() * sizeof(Instance), instances.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    instanceCount = instances.size();
+    groupCount = groups.size();
+}
+
+void IndirectDraws::cull(Scene* s)
+{
+    shadowDraws = false;
+    multiDraws = 0;
+    if (!instanceCount)
+        return;
+
+    cullShader->activate();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+    glUniform1ui(glGetUniformLocation(cullShader->id, "instanceCount"), instanceCount);
+    GLuint groupsX = (instanceCount + 63) / 64;
+
+    auto dispatch = [this, groupsX](unsigned int view, const Frustum& frustum, bool shadow) {
+        // shadow casters between the cascade and the sun still count,
+        // they're clamped onto the near plane, so no near plane test
+        glm::vec4 planes[6];
+        int count = 0;
+        for (int p = 0; p < 6; ++p)
+            if (!shadow || p != 4)
+                planes[count++] = frustum.planes[p];
+        glUniform4fv(glGetUniformLocation(cullShader->id, "planes"), count, glm::value_ptr(planes[0]));
+        glUniform1i(glGetUniformLocation(cullShader->id, "planeCount"), count);
+        glUniform1ui(glGetUniformLocation(cullShader->id, "firstCommand"), view * capacity);
+        glUniform1i(glGetUniformLocation(cullShader->id, "skipStatic"), shadow);
+        glUniform1i(glGetUniformLocation(cullShader->id, "writeNormals"), view == 0);
+        glUniform1i(glGetUniformLocation(cullShader->id, "skipOccluded"), view == 0);
+        glDispatchCompute(groupsX, 1, 1);
+    };
+
+    dispatch(0, Frustum(s->activeCamera->getMatrix()), false);
+    // without caching the cascades draw everything on refits, like the cpu path
+    if (s->dirLight && s->sunShadows->cacheStatic)
+    {
+        for (unsigned int c = 0; c < s->sunShadows->cascadeCount; ++c)
+            dispatch(1 + c, Frustum(s->sunShadows->viewProjection[c]), true);
+        shadowDraws = true;
+    }
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+    Profiler::get().count("indirect instances", instanceCount);
+}
+
+// same choice as Renderer::passShader
+static std::shared_ptr<Shader> passShader(Scene* s, std::shared_ptr<Shader> shader)
+{
+    switch (s->currentPass)
+    {
+    case Scene::Pass::GBUFFER_PASS:
+        return shader->gbufferVariant;
+    case Scene::Pass::FALLBACK_PASS:
+        return shader->gbufferVariant ? nullptr : shader;
+    default:
+        return shader;
+    }
+}
+
+void IndirectDraws::draw(Scene* s, std::shared_ptr<Shader> shaderOverride)
+{
+    if (!instanceCount)
+        return;
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+    arena->bind();
+    for (auto& group : groups)
+    {
+        std::shared_ptr<Shader> shader = shaderOverride ? shaderOverride : passShader(s, group.shader);
+        if (!shader || !shader->indirectVariant)
+            continue;
+        shader = shader->indirectVariant;
+        if (!shaderOverride)
+            shader = s->shaderVariant(shader, group.features);
+        shader->activate();
+
+        if (group.diffuseTex)
+            group.diffuseTex->bind(GL_TEXTURE0);
+        else {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        if (group.specularTex)
+            group.specularTex->bind(GL_TEXTURE1);
+        else {
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        glUniform1i(glGetUniformLocation(shader->id, "diffuseTex"), 0);
+        glUniform1i(glGetUniformLocation(shader->id, "specularTex"), 1);
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(group.first * COMMAND_SIZE), group.count, 0);
+        multiDraws++;
+    }
+    GeometryArena::unbind();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void IndirectDraws::drawDepth(unsigned int view, std::shared_ptr<Shader> depthShader, const glm::mat4& viewProjection)
+{
+    if (!instanceCount || !depthShader->indirectVariant)
+        return;
+
+    // one depth shader for all of them, so one draw for every group
+    std::shared_ptr<Shader> shader = depthShader->indirectVariant;
+    shader->activate();
+    glUniformMatrix4fv(glGetUniformLocation(shader->id, "lightViewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+    arena->bind();
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(view * capacity * COMMAND_SIZE), instanceCount, 0);
+    multiDraws++;
+    GeometryArena::unbind();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    depthShader->activate();
+}
+
+unsigned int IndirectDraws::readVisible(unsigned int view)
+{
+    if (!instanceCount)
+        return 0;
+    std::vector<GLuint> commands(instanceCount * 5);
+    glBindBuffer(GL_COPY_READ_BUFFER, commandBuffer);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, view * capacity * COMMAND_SIZE, commands.size() * sizeof(GLuint), commands.data());
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    unsigned int visible = 0;
+    for (unsigned int i = 0; i < instanceCount; ++i)
+        visible += commands[i * 5 + 1];
+    return visible;
+}
\ No newline at end of file
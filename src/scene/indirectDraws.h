@@ -0,0 +1,97 @@
+#pragma once
+
+#include <scene/drawItem.h>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <memory>
+
+class Scene;
+class Shader;
+class Texture;
+class GeometryArena;
+
+// multi-draw indirect with gpu culling, only on a GL 4.3 context (the 3.3
+// path draws everything one by one as before). each frame the draw list
+// items that can go this way (geometry in the standard arena, a shader
+// with an INDIRECT path) are packed into one instance buffer, grouped by
+// shader and textures, and taken off the cpu path. a compute shader culls
+// them against the camera and every shadow cascade and writes the draw
+// commands, then each group is a single glMultiDrawElementsIndirect per
+// pass. static casters still go into the cached shadow maps through the
+// cpu path when a cascade refits, only the dynamic ones are drawn here
+class IndirectDraws {
+public:
+    IndirectDraws() {}
+    IndirectDraws(const IndirectDraws& other) = delete;
+    ~IndirectDraws();
+
+    bool enabled = true;
+    // GL 4.3 and the cull shader loaded
+    bool supported(Scene* s);
+
+    // pack what can be drawn indirectly and flag those items, order is the
+    // order they're drawn in within each group
+    void build(Scene* s, std::vector<DrawItem>& drawList, const std::vector<unsigned int>& order, std::shared_ptr<Shader> depthShader);
+    // write the commands for the camera and the shadow cascades
+    void cull(Scene* s);
+    // the groups that take part in the scene's current pass, or all of them
+    // with the override's indirect variant
+    void draw(Scene* s, std::shared_ptr<Shader> shaderOverride = nullptr);
+    // depth only, everything one view's commands kept (the camera's depth
+    // pre-pass, or a cascade's dynamic casters). leaves depthShader active
+    void drawDepth(unsigned int view, std::shared_ptr<Shader> depthShader, const glm::mat4& viewProjection);
+    void drawShadow(unsigned int cascade, std::shared_ptr<Shader> depthShader, const glm::mat4& lightViewProjection)
+    {
+        if (shadowDraws)
+            drawDepth(1 + cascade, depthShader, lightViewProjection);
+    }
+
+    // stats, last frame
+    unsigned int instanceCount = 0;
+    unsigned int groupCount = 0;
+    unsigned int multiDraws = 0;
+
+    // let go of last frame's groups (their shaders and textures), the next
+    // build makes them again
+    void release() { groups.clear(); }
+
+    // the commands one view ended up with (stalls, benchmarks only).
+    // view 0 is the camera, 1 + c cascade c
+    unsigned int readVisible(unsigned int view);
+
+private:
+    // std430 layout, matches Instance in the shaders
+    struct Instance {
+        glm::mat4 model;
+        glm::mat4 normalMat; // written by the cull shader
+        glm::vec4 diffuse;   // rgb, shininess
+        glm::vec4 specular;
+        glm::vec4 boundsMin; // w = 1 if valid
+        glm::vec4 boundsMax; // w = 1 if static
+        glm::uvec4 draw;     // count, firstIndex, baseVertex, occluded from the camera
+    };
+    struct Group {
+        std::shared_ptr<Shader> shader;
+        std::shared_ptr<Texture> diffuseTex;
+        std::shared_ptr<Texture> specularTex;
+        unsigned int features; // Shader::Feature bits, the variant drawn with
+        unsigned int first;
+        unsigned int count;
+    };
+    std::vector<Instance> instances;
+    std::vector<Group> groups;
+    std::shared_ptr<GeometryArena> arena;
+    std::shared_ptr<Shader> cullShader;
+    bool shadowDraws = false; // dynamic casters culled this frame
+
+    static const unsigned int VIEWS = 5; // camera + ShadowCascades::MAX_CASCADES
+    static const size_t COMMAND_SIZE = 5 * sizeof(GLuint);
+    GLuint instanceBuffer = 0;
+    GLuint commandBuffer = 0;
+    GLuint idBuffer = 0;   // 0, 1, 2... per instance attribute
+    size_t capacity = 0;   // instances the buffers have room for
+    void reserve(size_t count);
+};
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include "lightClusters.h"
+
+#include <scene/object/components/camera.h>
+#include <scene/object/components/transform.h>
+#include <util/shader.h>
+
+#include <GLFW/glfw3.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// lights below this intensity are considered out of range (1/256 is
+// what an 8-bit framebuffer can't show anyway)
+static const float INTENSITY_CUTOFF = 1.0f / 256.0f;
+
+// texture slots the cluster buffers live in (0-2 are taken by the
+// material textures and the sun shadow map)
+static const GLenum LIGHT_DATA_SLOT = 3;
+static const GLenum LIGHT_GRID_SLOT = 4;
+static const GLenum LIGHT_INDICES_SLOT = 5;
+
+LightClusters::LightClusters()
+{
+    lightData = std::shared_ptr<TBO>(new TBO(GL_RGBA32F));
+    lightGrid = std::shared_ptr<TBO>(new TBO(GL_RG32UI));
+    lightIndices = std::shared_ptr<TBO>(new TBO(GL_R32UI));
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+
+    minX.resize(CLUSTERS); minY.resize(CLUSTERS); minZ.resize(CLUSTERS);
+    maxX.resize(CLUSTERS); maxY.resize(CLUSTERS); maxZ.resize(CLUSTERS);
+    grid.resize(CLUSTERS * 2);
+}
+
+float LightClusters::lightRange(glm::vec3 color, float linear, float quadratic)
+{
+    // solve intensity / (1 + l*d + q*d^2) = cutoff for d
+    float intensity = std::max(color.r, std::max(color.g, color.b));
+    float k = intensity / INTENSITY_CUTOFF - 1.0f;
+    if (k <= 0.0f)
+        return 0.0f; // too dim to ever show up
+    if (quadratic > 0.0f)
+        return (-linear + std::sqrt(linear * linear + 4.0f * quadratic * k)) / (2.0f * quadratic);
+    if (linear > 0.0f)
+        return k / linear;
+    return -1.0f; // no attenuation, reaches everything
+}
+
+// depth of the boundary between slice k-1 and k (exponential slicing so
+// the clusters stay roughly cube shaped)
+static float sliceDepth(unsigned int k, float near, float far)
+{
+    return near * std::pow(far / near, (float)k / LightClusters::DIM_Z);
+}
+
+void LightClusters::buildClusterBounds(const glm::mat4& projection, float near, float far)
+{
+    glm::mat4 invProjection = glm::inverse(projection);
+
+    // find the view space direction of every tile corner (point on the
+    // near plane, scale it along the ray to get other depths)
+    std::vector<glm::vec3> corners((DIM_X + 1) * (DIM_Y + 1));
+    for (unsigned int y = 0; y <= DIM_Y; ++y)
+        for (unsigned int x = 0; x <= DIM_X; ++x)
+        {
+            glm::vec4 ndc(-1.0f + 2.0f * x / DIM_X, -1.0f + 2.0f * y / DIM_Y, -1.0f, 1.0f);
+            glm::vec4 v = invProjection * ndc;
+            v /= v.w;
+            corners[y * (DIM_X + 1) + x] = glm::vec3(v) / -v.z; // normalise to depth 1
+        }
+
+    for (unsigned int z = 0; z < DIM_Z; ++z)
+    {
+        float dNear = sliceDepth(z, near, far);
+        float dFar = sliceDepth(z + 1, near, far);
+        for (unsigned int y = 0; y < DIM_Y; ++y)
+            for (unsigned int x = 0; x < DIM_X; ++x)
+            {
+                unsigned int c = x + DIM_X * (y + DIM_Y * z);
+                glm::vec3 mn(INFINITY), mx(-INFINITY);
+                for (unsigned int cy = 0; cy <= 1; ++cy)
+                    for (unsigned int cx = 0; cx <= 1; ++cx)
+                    {
+                        glm::vec3 dir = corners[(y + cy) * (DIM_X + 1) + x + cx];
+                        mn = glm::min(mn, glm::min(dir * dNear, dir * dFar));
+                        mx = glm::max(mx, glm::max(dir * dNear, dir * dFar));
+                    }
+                minX[c] = mn.x; minY[c] = mn.y; minZ[c] = mn.z;
+                maxX[c] = mx.x; maxY[c] = mx.y; maxZ[c] = mx.z;
+            }
+    }
+}
+
+void LightClusters::update(std::shared_ptr<Camera> camera, const std::vector<glm::vec4>& lights, bool dirty)
+{
+    unsigned int count = lights.size() / 2;
+    // 2 texels a light, the ones that don't fit in the texture buffer aren't
+    // uploaded (or binned)
+    if (count > (unsigned int)maxTexels / 2)
+    {
+        if (dirty)
+            std::cout << "WARN::RENDERER::CLUSTERS::too many point lights, dropping "
+                << count - maxTexels / 2 << std::endl;
+        count = maxTexels / 2;
+    }
+    if (dirty)
+    {
+        ranges.resize(count);
+        for (unsigned int i = 0; i < count; ++i)
+            ranges[i] = lightRange(glm::vec3(lights[i * 2 + 1]), lights[i * 2].w, lights[i * 2 + 1].w);
+    }
+
+    // rebuild cluster bounds only when the projection changes
+    glm::mat4 projection = camera->getPerspective();
+    if (projection != boundsProjection)
+    {
+        near = camera->near;
+        far = camera->far;
+        buildClusterBounds(projection, near, far);
+        boundsProjection = projection;
+    }
+    glm::mat4 view = camera->getView();
+    float logScale = DIM_Z / std::log(far / near);
+
+    clusterOf.clear();
+    lightOf.clear();
+    spheres.clear();
+    maxPerCluster = 0;
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        glm::vec3 worldPos = glm::vec3(lights[i * 2]);
+        float r = ranges[i];
+        if (r == 0.0f)
+            continue;
+        if (r < 0.0f)
+            r = 2.0f * far; // unattenuated, covers the whole frustum
+
+        // cull against the depth range of the frustum
+        glm::vec3 p = glm::vec3(view * glm::vec4(worldPos, 1.0f));
+        float depth = -p.z;
+        if (depth + r < near || depth - r > far)
+            continue;
+
+        // depth slices the light sphere touches
+        unsigned int z0 = (unsigned int)std::max(0.0f, std::floor(std::log(std::max(depth - r, near) / near) * logScale));
+        unsigned int z1 = (unsigned int)std::max(0.0f, std::floor(std::log(std::min(depth + r, far) / near) * logScale));
+        z1 = std::min(z1, DIM_Z - 1);
+
+        // screen tiles the light sphere touches, project the sphere's bounding
+        // box when it is fully in front of the camera, otherwise it could be anywhere
+        unsigned int x0 = 0, x1 = DIM_X - 1, y0 = 0, y1 = DIM_Y - 1;
+        float dMin = depth - r, dMax = depth + r;
+        if (dMin > near)
+        {
+            float lx = p.x - r, hx = p.x + r, ly = p.y - r, hy = p.y + r;
+            float ndcX0 = projection[0][0] * (lx < 0 ? lx / dMin : lx / dMax);
+            float ndcX1 = projection[0][0] * (hx > 0 ? hx / dMin : hx / dMax);
+            float ndcY0 = projection[1][1] * (ly < 0 ? ly / dMin : ly / dMax);
+            float ndcY1 = projection[1][1] * (hy > 0 ? hy / dMin : hy / dMax);
+            if (ndcX1 < -1.0f || ndcX0 > 1.0f || ndcY1 < -1.0f || ndcY0 > 1.0f)
+                continue; // off screen
+            x0 = (unsigned int)glm::clamp((ndcX0 + 1.0f) * 0.5f * DIM_X, 0.0f, DIM_X - 1.0f);
+            x1 = (unsigned int)glm::clamp((ndcX1 + 1.0f) * 0.5f * DIM_X, 0.0f, DIM_X - 1.0f);
+            y0 = (unsigned int)glm::clamp((ndcY0 + 1.0f) * 0.5f * DIM_Y, 0.0f, DIM_Y - 1.0f);
+            y1 = (unsigned int)glm::clamp((ndcY1 + 1.0f) * 0.5f * DIM_Y, 0.0f, DIM_Y - 1.0f);
+        }
+
+        spheres.push_back(glm::vec4(worldPos, r));
+
+        // sphere vs cluster aabb for every candidate cluster. the distance
+        // calculation runs over a row of clusters at a time without branching
+        // so the compiler can vectorise it
+        float r2 = r * r;
+        float dist2[DIM_X];
+        for (unsigned int z = z0; z <= z1; ++z)
+            for (unsigned int y = y0; y <= y1; ++y)
+            {
+                unsigned int row = DIM_X * (y + DIM_Y * z);
+                for (unsigned int x = x0; x <= x1; ++x)
+                {
+                    unsigned int c = row + x;
+                    float dx = std::max(std::max(minX[c] - p.x, p.x - maxX[c]), 0.0f);
+                    float dy = std::max(std::max(minY[c] - p.y, p.y - maxY[c]), 0.0f);
+                    float dz = std::max(std::max(minZ[c] - p.z, p.z - maxZ[c]), 0.0f);
+                    dist2[x] = dx * dx + dy * dy + dz * dz;
+                }
+                for (unsigned int x = x0; x <= x1; ++x)
+                    if (dist2[x] <= r2)
+                    {
+                        clusterOf.push_back(row + x);
+                        lightOf.push_back(i);
+                    }
+            }
+    }
+
+    // too many light/cluster pairs for the texture buffer, drop the extras
+    if (clusterOf.size() > (size_t)maxTexels)
+    {
+        std::cout << "WARN::RENDERER::CLUSTERS::too many light/cluster pairs, dropping "
+            << clusterOf.size() - maxTexels << std::endl;
+        clusterOf.resize(maxTexels);
+        lightOf.resize(maxTexels);
+    }
+
+    // counting sort the pairs into per-cluster light lists
+    std::fill(grid.begin(), grid.end(), 0);
+    for (auto c : clusterOf)
+        grid[c * 2 + 1]++;
+    GLuint offset = 0;
+    for (unsigned int c = 0; c < CLUSTERS; ++c)
+    {
+        grid[c * 2] = offset;
+        offset += grid[c * 2 + 1];
+        maxPerCluster = std::max(maxPerCluster, grid[c * 2 + 1]);
+        grid[c * 2 + 1] = 0; // reused as the fill cursor below
+    }
+    indices.resize(std::max<size_t>(clusterOf.size(), 1));
+    for (size_t i = 0; i < clusterOf.size(); ++i)
+    {
+        GLuint c = clusterOf[i];
+        indices[grid[c * 2] + grid[c * 2 + 1]++] = lightOf[i];
+    }
+
+    lightCount = count;
+    indexCount = clusterOf.size();
+
+    // upload (light data only when it changed)
+    if (dirty && count)
+        lightData->upload(&lights[0], count * 2 * sizeof(glm::vec4));
+    lightGrid->upload(&grid[0], grid.size() * sizeof(GLuint));
+    lightIndices->upload(&indices[0], indices.size() * sizeof(GLuint));
+}
+
+void LightClusters::bind()
+{
+    lightData->bind(GL_TEXTURE0 + LIGHT_DATA_SLOT);
+    lightGrid->bind(GL_TEXTURE0 + LIGHT_GRID_SLOT);
+    lightIndices->bind(GL_TEXTURE0 + LIGHT_INDICES_SLOT);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+bool LightClusters::reaches(const AABB& bounds) const
+{
+    for (auto& sphere : spheres)
+    {
+        glm::vec3 centre = glm::vec3(sphere);
+        glm::vec3 d = glm::clamp(centre, bounds.min, bounds.max) - centre;
+        if (glm::dot(d, d) <= sphere.w * sphere.w)
+            return true;
+    }
+    return false;
+}
+
+void LightClusters::setUniforms(std::shared_ptr<Shader> shader)
+{
+    const auto mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    float logFarNear = std::log(far / near);
+
+    glUniform1i(glGetUniformLocation(shader->id, "lightData"), LIGHT_DATA_SLOT);
+    glUniform1i(glGetUniformLocation(shader->id, "lightGrid"), LIGHT_GRID_SLOT);
+    glUniform1i(glGetUniformLocation(shader->id, "lightIndices"), LIGHT_INDICES_SLOT);
+    glUniform3ui(glGetUniformLocation(shader->id, "clusterDims"), DIM_X, DIM_Y, DIM_Z);
+    glUniform2f(glGetUniformLocation(shader->id, "screenSize"), (float)mode->width, (float)mode->height);
+    // slice = log(depth) * scale + bias
+    glUniform1f(glGetUniformLocation(shader->id, "clusterScale"), DIM_Z / logFarNear);
+    glUniform1f(glGetUniformLocation(shader->id, "clusterBias"), -(float)DIM_Z * std::log(near) / logFarNear);
+}
\ No newline at end of file
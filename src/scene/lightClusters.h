@@ -0,0 +1,71 @@
+#pragma once
+
+#include <util/tbo.h>
+#include <util/aabb.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <memory>
+
+class Camera;
+class Shader;
+
+// clustered forward lighting
+// the view frustum is chopped into a grid of clusters (tiles on screen,
+// exponential slices in depth). every frame the point lights get binned
+// into the clusters they touch on the cpu and the resulting light lists
+// are handed to the shaders through texture buffers, so each fragment only
+// loops over the handful of lights that can actually reach it
+class LightClusters {
+public:
+    LightClusters();
+
+    static const unsigned int DIM_X = 16;
+    static const unsigned int DIM_Y = 9;
+    static const unsigned int DIM_Z = 24;
+    static const unsigned int CLUSTERS = DIM_X * DIM_Y * DIM_Z;
+
+    // build the light lists for this frame and upload them, lightData is
+    // 2 texels per light (see Scene::pointLightData) and is only re-uploaded
+    // when dirty
+    void update(std::shared_ptr<Camera> camera, const std::vector<glm::vec4>& lightData, bool dirty);
+    // bind the buffers to the texture slots and point the shader at them
+    void bind();
+    void setUniforms(std::shared_ptr<Shader> shader);
+
+    // distance at which a light's attenuated intensity drops under the cutoff
+    // negative if the light never reaches the cutoff (no attenuation)
+    static float lightRange(glm::vec3 color, float linear, float quadratic);
+
+    // whether any light binned this frame can reach into the box, the ones
+    // that can't light anything on screen don't count
+    bool reaches(const AABB& bounds) const;
+
+    // stats for the overview
+    unsigned int lightCount = 0;
+    unsigned int indexCount = 0;
+    unsigned int maxPerCluster = 0;
+
+private:
+    void buildClusterBounds(const glm::mat4& projection, float near, float far);
+
+    std::shared_ptr<TBO> lightData;   // 2 texels per light: pos + linear, color + quadratic
+    std::shared_ptr<TBO> lightGrid;   // per cluster: offset, count into lightIndices
+    std::shared_ptr<TBO> lightIndices;
+
+    // view space cluster aabbs, structure of arrays so the overlap test vectorises
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    glm::mat4 boundsProjection = glm::mat4(0.0f);
+
+    // scratch buffers, kept around so we don't reallocate every frame
+    std::vector<float> ranges; // per light, recalculated when the lights are dirty
+    std::vector<glm::vec4> spheres; // world position, range of the lights binned this frame
+    std::vector<GLuint> clusterOf; // (cluster, light) pairs before sorting
+    std::vector<GLuint> lightOf;
+    std::vector<GLuint> grid;
+    std::vector<GLuint> indices;
+
+    float near = 0.1f, far = 100.0f;
+    GLint maxTexels = 65536;
+};
\ No newline at end of file
@@ -46,7 +46,7 @@ Camera::Camera(std::shared_ptr<Object> obj, int width, int height, float FOV, fl
 glm::mat4 Camera::getMatrix() {
     // calculate direction vector
     // FIXME: there has to be a better way than having to call decompose
-    glm::mat4 model = transform->modelMatrix();
+    glm::mat4 model = transform->worldMatrix(); // interpolated, matches what gets drawn
     glm::vec3 pos, scale, skew;
     glm::vec4 pers;
     glm::quat rot;
@@ -72,7 +72,7 @@ glm::mat4 Camera::getPerspective() {
 glm::mat4 Camera::getView() {
     // calculate direction vector
     // FIXME: there has to be a better way than having to call decompose
-    glm::mat4 model = transform->modelMatrix();
+    glm::mat4 model = transform->worldMatrix();
     glm::vec3 pos, scale, skew;
     glm::vec4 pers;
     glm::quat rot;
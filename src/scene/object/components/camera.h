@@ -16,7 +16,7 @@ public:
     Camera(const Camera& other) = delete;
     Camera(const Camera& other, std::shared_ptr<Object> newObj) : Camera(newObj, other.width, other.height, other.FOV, other.near, other.far, other.fogOffset) {}
     std::shared_ptr<Component> clone(std::shared_ptr<Object> newObj) override {
-        return std::shared_ptr<Component>(new Camera(*this, newObj));
+        return makePooled<Camera>(*this, newObj);
     }
     void renderInspector() override;
     YAML::Emitter& serialise(YAML::Emitter& emitter) override
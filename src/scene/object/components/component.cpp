@@ -15,11 +15,11 @@
 #include <memory>
 
 template <typename T>
-Component* newComponent(std::shared_ptr<Object> obj) { return new T(obj); }
+std::shared_ptr<Component> newComponent(std::shared_ptr<Object> obj) { return makePooled<T>(obj); }
 
 struct ComponentBuilders {
     const char* name;
-    Component* (*builder)(std::shared_ptr<Object>);
+    std::shared_ptr<Component> (*builder)(std::shared_ptr<Object>);
 };
 
 static ComponentBuilders builders[] = {
@@ -43,7 +43,7 @@ void Component::renderComponentChildWindow(std::shared_ptr<Object> obj) {
         {
             if (ImGui::Button(cb.name))
             {
-                obj->components.push_back(std::shared_ptr<Component>(cb.builder(obj)));
+                obj->components.push_back(cb.builder(obj));
                 ImGui::CloseCurrentPopup();
             }
             ImGui::Separator();
@@ -65,7 +65,7 @@ std::shared_ptr<Component> Component::deserialise(const YAML::Node& componentNod
         for (auto cb : builders)
             if (componentNode["name"].as<std::string>() == std::string(cb.name))
             {
-                auto component = std::shared_ptr<Component>(cb.builder(obj));
+                auto component = cb.builder(obj);
                 component->_deserialise(componentNode);
                 return component;
             }
@@ -73,6 +73,11 @@ std::shared_ptr<Component> Component::deserialise(const YAML::Node& componentNod
     return nullptr;
 }
 
+std::shared_ptr<Object> Component::getObject()
+{
+    return object->shared_from_this();
+}
+
 void Component::remove()
 {
     // find self in obj components and remove (shared_ptr should automatically free us)
@@ -3,6 +3,8 @@
 #include <string>
 #include <memory>
 
+#include <util/pool.h>
+
 #include <yaml-cpp/yaml.h>
 
 class Object;
@@ -10,11 +12,11 @@ class Object;
 class Component
 {
 public:
-    Component(std::shared_ptr<Object> obj) : object(obj) {}
+    Component(std::shared_ptr<Object> obj) : object(obj.get()) {}
     std::string getName() { return name; }
 
     // DANGEROUS! for use by Object::clone() ONLY
-    void setObject(std::shared_ptr<Object> newObj) { object = newObj; }
+    void setObject(std::shared_ptr<Object> newObj) { object = newObj.get(); }
 
     friend YAML::Emitter& operator << (YAML::Emitter& emitter, Component& c) {
         return c.serialise(emitter);
@@ -29,11 +31,11 @@ public:
     virtual std::shared_ptr<Component> clone(std::shared_ptr<Object> newObj) = 0;
     static void renderComponentChildWindow(std::shared_ptr<Object> obj);
 
-    std::shared_ptr<Object> getObject() { return object; }
+    std::shared_ptr<Object> getObject();
 
-    void remove();
+    virtual void remove();
 
 protected:
     std::string name;
-    std::shared_ptr<Object> object;
+    Object* object; // owner, not owned (the object outlives its components)
 };
\ No newline at end of file
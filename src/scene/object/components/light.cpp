@@ -2,6 +2,7 @@
 
 #include <scene/object/object.h>
 #include <scene/object/components/transform.h>
+#include <scene/scene.h>
 
 #include <imgui.h>
 
@@ -17,6 +18,14 @@ Light::Light(std::shared_ptr<Object> obj, glm::vec3 color, float linearAttenuati
 {
     name = "Light";
 
+    // let the scene know about us, so it doesn't have to go looking
+    scene = obj->getScene().get();
+    scene->registerLight(this);
+    entity = obj->getEntity();
+    LightRef ref;
+    ref.light = this;
+    scene->world.add<LightRef>(entity, ref);
+
     // find object transform
     std::shared_ptr<Transform> t = obj->getComponent<Transform>();
 
@@ -30,6 +39,27 @@ Light::Light(std::shared_ptr<Object> obj, glm::vec3 color, float linearAttenuati
     transform = t;
 }
 
+Light::~Light()
+{
+    if (scene)
+        unregister();
+}
+
+void Light::remove()
+{
+    unregister();
+    scene = nullptr;
+    Component::remove();
+}
+
+void Light::unregister()
+{
+    scene->unregisterLight(this);
+    LightRef* ref = scene->world.get<LightRef>(entity);
+    if (ref && ref->light == this)
+        scene->world.remove<LightRef>(entity);
+}
+
 void Light::renderInspector()
 {
     ImGui::Text("Light");
@@ -1,20 +1,23 @@
 #pragma once
 
 #include <scene/object/components/component.h>
+#include <scene/ecs/world.h>
 
 #include <glm/glm.hpp>
 
 #include <memory>
 
 class Transform;
+class Scene;
 
 class Light : public Component
 {
 public:
     Light(std::shared_ptr<Object> obj, glm::vec3 color = glm::vec3(1.0f), float linearAttenuation = 0, float quadAttenuation = 0);
-    Light(const Light& other, std::shared_ptr<Object> newObj) : Light(newObj, other.color, other.linearAttenuation, other.quadAttenuation) {}
+    Light(const Light& other, std::shared_ptr<Object> newObj) : Light(newObj, other.color, other.linearAttenuation, other.quadAttenuation) { type = other.type; }
+    ~Light();
     std::shared_ptr<Component> clone(std::shared_ptr<Object> newObj) override {
-        return std::shared_ptr<Component>(new Light(*this, newObj));
+        return makePooled<Light>(*this, newObj);
     }
 
     enum Type {
@@ -23,6 +26,7 @@ public:
     };
 
     void renderInspector() override;
+    void remove() override;
     YAML::Emitter& serialise(YAML::Emitter& emitter) override
     {
         emitter << YAML::BeginMap;
@@ -56,4 +60,9 @@ public:
     Type type = POINT;
 
     std::shared_ptr<Transform> transform;
+
+private:
+    void unregister();
+    Scene* scene; // registered with, null once removed
+    Entity entity;
 };
\ No newline at end of file
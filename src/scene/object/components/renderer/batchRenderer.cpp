@@ -0,0 +1,58 @@
+#include "batchRenderer.h"
+
+#include <util/texture.h>
+
+#include <glad/glad.h>
+#include <glm/gtc/type_ptr.hpp>
+
+BatchRenderer::BatchRenderer(std::shared_ptr<Object> obj, const BatchMaterial& material,
+    std::vector<GLfloat>& vertices, std::vector<GLuint>& indices, AABB bounds, unsigned int sources)
+    : Renderer(obj), material(material), sources(sources), bounds(bounds)
+{
+    name = "BatchRenderer";
+    shader = material.shader;
+    vertexCount = vertices.size() / 8;
+    indexCount = indices.size();
+
+    arena = GeometryArena::standard();
+    geometry = arena->add(vertices.data(), vertexCount, indices.data(), indexCount);
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    arena->remove(geometry);
+}
+
+void BatchRenderer::render(std::shared_ptr<Scene> s, const glm::mat4& model, std::shared_ptr<Shader> shaderOverride)
+{
+    std::shared_ptr<Shader> active = passShader(s, shaderOverride);
+    if (!active)
+        return;
+    active->activate();
+
+    // the vertices are in world space already
+    glm::mat3 normalMat(1.0f);
+    glUniformMatrix4fv(glGetUniformLocation(active->id, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix3fv(glGetUniformLocation(active->id, "normalMat"), 1, GL_FALSE, glm::value_ptr(normalMat));
+
+    glUniform3f(glGetUniformLocation(active->id, "diffuseColor"), material.diffuseColor.r, material.diffuseColor.g, material.diffuseColor.b);
+    glUniform3f(glGetUniformLocation(active->id, "specularColor"), material.specularColor.r, material.specularColor.g, material.specularColor.b);
+    glUniform1f(glGetUniformLocation(active->id, "shininess"), material.shininess);
+    if (material.diffuseTex)
+        material.diffuseTex->bind(GL_TEXTURE0);
+    else {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    if (material.specularTex)
+        material.specularTex->bind(GL_TEXTURE1);
+    else {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glUniform1i(glGetUniformLocation(active->id, "diffuseTex"), 0);
+    glUniform1i(glGetUniformLocation(active->id, "specularTex"), 1);
+
+    arena->bind();
+    arena->draw(geometry);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <scene/object/components/renderer/renderer.h>
+#include <util/geometryArena.h>
+
+#include <memory>
+#include <vector>
+
+// one static batch: the triangles of many static renderers that share a
+// material, already in world space so they draw with an identity model
+// matrix. made by StaticBatches on an object that isn't in the scene, never
+// saved or cloned
+class BatchRenderer : public Renderer {
+public:
+    BatchRenderer(std::shared_ptr<Object> obj, const BatchMaterial& material,
+        std::vector<GLfloat>& vertices, std::vector<GLuint>& indices, AABB bounds, unsigned int sources);
+    ~BatchRenderer();
+
+    void render(std::shared_ptr<Scene> s, const glm::mat4& model, std::shared_ptr<Shader> shaderOverride = nullptr) override;
+    AABB localBounds() override { return bounds; }
+    void renderInspector() override {}
+    void _deserialise(const YAML::Node&) override {}
+    std::shared_ptr<Component> clone(std::shared_ptr<Object>) override { return nullptr; } // rebuild instead
+    // not for batching again, for indirect draws and occluders
+    bool batchSource(BatchMaterial& m, const void*& geometryKey) override
+    {
+        m = material;
+        geometryKey = this;
+        return true;
+    }
+    void readGeometry(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices) override { arena->read(geometry, vertices, indices); }
+    GeometryArena::Handle arenaGeometry() override { return geometry; }
+
+    BatchMaterial material;
+    unsigned int sources;  // renderers merged in
+    size_t vertexCount;
+    size_t indexCount;
+
+private:
+    AABB bounds;
+    std::shared_ptr<GeometryArena> arena;
+    GeometryArena::Handle geometry;
+};
\ No newline at end of file
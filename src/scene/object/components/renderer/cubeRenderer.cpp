@@ -15,9 +15,8 @@
 #include <memory>
 
 bool CubeRenderer::initialised = false;
-std::shared_ptr<VBO> CubeRenderer::cubeVBO;
-std::shared_ptr<VAO> CubeRenderer::cubeVAO;
-std::shared_ptr<EBO> CubeRenderer::cubeEBO;
+std::shared_ptr<GeometryArena> CubeRenderer::arena;
+GeometryArena::Handle CubeRenderer::cubeGeometry = 0;
 
 CubeRenderer::CubeRenderer(std::shared_ptr<Object> obj) : Renderer(obj)
 {
@@ -80,59 +79,40 @@ void CubeRenderer::initVertexData() {
         16, 17, 18, 18, 19, 16, // fifth face
         20, 21, 22, 22, 23, 20, // sixth face
     };
-    cubeVAO = std::shared_ptr<VAO>(new VAO());
-    cubeVBO = std::shared_ptr<VBO>(new VBO(cubeVAO, verts, sizeof(verts)));
-    cubeEBO = std::shared_ptr<EBO>(new EBO(cubeVAO, elements, sizeof(elements)));
-
-    // set buffer attributes
-    // vertex positions
-    cubeVAO->link(cubeVBO, 0, 3, GL_FLOAT, 8 * sizeof(GLfloat), (void*)0); // vertex coords
-    // normals 
-    cubeVAO->link(cubeVBO, 1, 3, GL_FLOAT, 8 * sizeof(GLfloat), (void*)(3 * sizeof(float))); // vertex coords
-    // texcoords 
-    cubeVAO->link(cubeVBO, 2, 2, GL_FLOAT, 8 * sizeof(GLfloat), (void*)(6 * sizeof(float))); // vertex coords
+    // pos, normal, texcoord, same layout as the shared arena
+    arena = GeometryArena::standard();
+    cubeGeometry = arena->add(verts, sizeof(verts) / (8 * sizeof(GLfloat)), elements, sizeof(elements) / sizeof(GLuint));
 
     initialised = true;
 }
 
-void CubeRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride)
+void CubeRenderer::render(std::shared_ptr<Scene> s, const glm::mat4& model, std::shared_ptr<Shader> shaderOverride)
 {
     // set default shader
     if (!shader)
         shader = object->getScene()->shaders[0];
 
-    // find object transform
-    std::shared_ptr<Transform> t = object->getComponent<Transform>();
-
-    // cannot find transform, don't render anything
-    if (t == nullptr)
-    {
-        std::cout << "WARN::" << object->getName() << "::cubeRenderer::cannot find transform" << std::endl;
+    // activate the shader for this pass
+    std::shared_ptr<Shader> active = passShader(s, shaderOverride);
+    if (!active)
         return;
-    }
-
-    // activate the renderer's shader
-    if (shaderOverride)
-        shaderOverride->activate();
-    else
-        shader->activate();
+    active->activate();
 
     // model mat and normal mat
-    glm::mat4 modelMat = t->modelMatrix();
-    glm::mat3 normalMat = glm::mat3(glm::transpose(glm::inverse(modelMat)));
-    glUniformMatrix4fv(glGetUniformLocation(shader->id, "model"), 1, GL_FALSE, glm::value_ptr(modelMat));
-    glUniformMatrix3fv(glGetUniformLocation(shader->id, "normalMat"), 1, GL_FALSE, glm::value_ptr(normalMat));
+    glm::mat3 normalMat = glm::mat3(glm::transpose(glm::inverse(model)));
+    glUniformMatrix4fv(glGetUniformLocation(active->id, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix3fv(glGetUniformLocation(active->id, "normalMat"), 1, GL_FALSE, glm::value_ptr(normalMat));
 
     // load color / texture
     switch (mode)
     {
     case CubeRenderer::Mode::MATERIAL:
-        glUniform3f(glGetUniformLocation(shader->id, "diffuseColor"),
+        glUniform3f(glGetUniformLocation(active->id, "diffuseColor"),
             diffuseColor.r,
             diffuseColor.g,
             diffuseColor.b
         );
-        glUniform3f(glGetUniformLocation(shader->id, "specularColor"),
+        glUniform3f(glGetUniformLocation(active->id, "specularColor"),
             specularColor.r,
             specularColor.g,
             specularColor.b
@@ -141,12 +121,12 @@ void CubeRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shad
         glBindTexture(GL_TEXTURE_2D, 0);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, 0);
-        glUniform1f(glGetUniformLocation(shader->id, "shininess"), shininess);
+        glUniform1f(glGetUniformLocation(active->id, "shininess"), shininess);
         break;
     case CubeRenderer::Mode::TEX_MAP:
-        glUniform3f(glGetUniformLocation(shader->id, "diffuseColor"), 0, 0, 0);
-        glUniform3f(glGetUniformLocation(shader->id, "specularColor"), 0, 0, 0);
-        glUniform1f(glGetUniformLocation(shader->id, "shininess"), shininess);
+        glUniform3f(glGetUniformLocation(active->id, "diffuseColor"), 0, 0, 0);
+        glUniform3f(glGetUniformLocation(active->id, "specularColor"), 0, 0, 0);
+        glUniform1f(glGetUniformLocation(active->id, "shininess"), shininess);
         if (diffuseTex)
             diffuseTex->bind(GL_TEXTURE0);
         else {
@@ -159,14 +139,36 @@ void CubeRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shad
             glActiveTexture(GL_TEXTURE1);
             glBindTexture(GL_TEXTURE_2D, 0);
         }
-        glUniform1i(glGetUniformLocation(shader->id, "diffuseTex"), 0);
-        glUniform1i(glGetUniformLocation(shader->id, "specularTex"), 1);
+        glUniform1i(glGetUniformLocation(active->id, "diffuseTex"), 0);
+        glUniform1i(glGetUniformLocation(active->id, "specularTex"), 1);
         break;
 
     }
-    cubeVAO->bind();
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, (void*)0);
-    cubeVAO->unbind();
+    arena->bind();
+    arena->draw(cubeGeometry);
+}
+
+bool CubeRenderer::batchSource(BatchMaterial& material, const void*& geometry)
+{
+    material.shader = shader ? shader : object->getScene()->shaders[0];
+    material.shininess = shininess;
+    if (mode == CubeRenderer::Mode::TEX_MAP)
+    {
+        material.diffuseTex = diffuseTex;
+        material.specularTex = specularTex;
+    }
+    else
+    {
+        material.diffuseColor = diffuseColor;
+        material.specularColor = specularColor;
+    }
+    geometry = &cubeGeometry;
+    return true;
+}
+
+void CubeRenderer::readGeometry(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices)
+{
+    arena->read(cubeGeometry, vertices, indices);
 }
 
 void CubeRenderer::renderInspector()
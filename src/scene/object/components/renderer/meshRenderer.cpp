@@ -10,38 +10,27 @@
 
 #include <iostream>
 
-void MeshRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride)
+void MeshRenderer::render(std::shared_ptr<Scene> s, const glm::mat4& model, std::shared_ptr<Shader> shaderOverride)
 {
     // set default shader
     if (!shader)
         shader = object->getScene()->shaders[0];
 
-    // find object transform
-    std::shared_ptr<Transform> t = object->getComponent<Transform>();
-
-    // cannot find transform, don't render anything
-    if (t == nullptr)
-    {
-        std::cout << "WARN::" << object->getName() << "::meshRenderer::cannot find transform" << std::endl;
+    // activate the shader for this pass
+    std::shared_ptr<Shader> active = passShader(s, shaderOverride);
+    if (!active)
         return;
-    }
-
-    // activate the renderer's shader
-    if (shaderOverride)
-        shaderOverride->activate();
-    else
-        shader->activate();
+    active->activate();
 
     // model mat and normal mat
-    glm::mat4 modelMat = t->modelMatrix();
-    glm::mat3 normalMat = glm::mat3(glm::transpose(glm::inverse(modelMat)));
-    glUniformMatrix4fv(glGetUniformLocation(shader->id, "model"), 1, GL_FALSE, glm::value_ptr(modelMat));
-    glUniformMatrix3fv(glGetUniformLocation(shader->id, "normalMat"), 1, GL_FALSE, glm::value_ptr(normalMat));
+    glm::mat3 normalMat = glm::mat3(glm::transpose(glm::inverse(model)));
+    glUniformMatrix4fv(glGetUniformLocation(active->id, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix3fv(glGetUniformLocation(active->id, "normalMat"), 1, GL_FALSE, glm::value_ptr(normalMat));
 
     // load color / texture
-    glUniform3f(glGetUniformLocation(shader->id, "diffuseColor"), mesh->diffuseColor.r, mesh->diffuseColor.g, mesh->diffuseColor.b);
-    glUniform3f(glGetUniformLocation(shader->id, "specularColor"), mesh->specularColor.r, mesh->specularColor.g, mesh->specularColor.b);
-    glUniform1f(glGetUniformLocation(shader->id, "shininess"), mesh->shininess);
+    glUniform3f(glGetUniformLocation(active->id, "diffuseColor"), mesh->diffuseColor.r, mesh->diffuseColor.g, mesh->diffuseColor.b);
+    glUniform3f(glGetUniformLocation(active->id, "specularColor"), mesh->specularColor.r, mesh->specularColor.g, mesh->specularColor.b);
+    glUniform1f(glGetUniformLocation(active->id, "shininess"), mesh->shininess);
     if (mesh->diffuseTex)
         mesh->diffuseTex->bind(GL_TEXTURE0);
     else {
@@ -54,12 +43,10 @@ void MeshRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shad
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
-    glUniform1i(glGetUniformLocation(shader->id, "diffuseTex"), 0);
-    glUniform1i(glGetUniformLocation(shader->id, "specularTex"), 1);
+    glUniform1i(glGetUniformLocation(active->id, "diffuseTex"), 0);
+    glUniform1i(glGetUniformLocation(active->id, "specularTex"), 1);
 
-    mesh->bind();
-    glDrawElements(GL_TRIANGLES, mesh->indices(), GL_UNSIGNED_INT, (void*)0);
-    mesh->unbind();
+    mesh->draw();
 }
 
 
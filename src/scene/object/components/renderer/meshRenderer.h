@@ -15,8 +15,24 @@ public:
     MeshRenderer(const MeshRenderer& other, std::shared_ptr<Object> newObj)
         : MeshRenderer(newObj, other.mesh) {}
 
-    void render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride = nullptr) override;
+    void render(std::shared_ptr<Scene> s, const glm::mat4& model, std::shared_ptr<Shader> shaderOverride = nullptr) override;
+    AABB localBounds() override { return mesh ? mesh->bounds : AABB(); }
     void renderInspector() override;
+    bool batchSource(BatchMaterial& material, const void*& geometry) override
+    {
+        if (!mesh)
+            return false;
+        material.shader = shader ? shader : object->getScene()->shaders[0];
+        material.diffuseColor = mesh->diffuseColor;
+        material.specularColor = mesh->specularColor;
+        material.shininess = mesh->shininess;
+        material.diffuseTex = mesh->diffuseTex;
+        material.specularTex = mesh->specularTex;
+        geometry = mesh.get();
+        return true;
+    }
+    void readGeometry(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices) override { mesh->read(vertices, indices); }
+    GeometryArena::Handle arenaGeometry() override { return mesh ? mesh->getGeometry() : 0; }
     YAML::Emitter& serialise(YAML::Emitter& emitter) override
     {
         emitter << YAML::BeginMap;
@@ -56,7 +72,7 @@ public:
         }
     }
     std::shared_ptr<Component> clone(std::shared_ptr<Object> newObj) {
-        return std::shared_ptr<Component>(new MeshRenderer(*this, newObj));
+        return makePooled<MeshRenderer>(*this, newObj);
     }
 
     std::shared_ptr<Mesh> mesh;
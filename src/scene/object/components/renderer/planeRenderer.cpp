@@ -15,9 +15,8 @@
 #include <memory>
 
 bool PlaneRenderer::initialised = false;
-std::shared_ptr<VBO> PlaneRenderer::planeVBO;
-std::shared_ptr<VAO> PlaneRenderer::planeVAO;
-std::shared_ptr<EBO> PlaneRenderer::planeEBO;
+std::shared_ptr<GeometryArena> PlaneRenderer::arena;
+GeometryArena::Handle PlaneRenderer::planeGeometry = 0;
 
 PlaneRenderer::PlaneRenderer(std::shared_ptr<Object> obj) : Renderer(obj)
 {
@@ -48,59 +47,40 @@ void PlaneRenderer::initVertexData() {
         0,1,2, // one half of plane
         2,1,3 // other half of plane (maintain CCW winding order)
     };
-    planeVAO = std::shared_ptr<VAO>(new VAO());
-    planeVBO = std::shared_ptr<VBO>(new VBO(planeVAO, verts, sizeof(verts)));
-    planeEBO = std::shared_ptr<EBO>(new EBO(planeVAO, elements, sizeof(elements)));
-
-    // set buffer attributes
-    // vertex positions
-    planeVAO->link(planeVBO, 0, 3, GL_FLOAT, 8 * sizeof(GLfloat), (void*)0); // vertex coords
-    // normals 
-    planeVAO->link(planeVBO, 1, 3, GL_FLOAT, 8 * sizeof(GLfloat), (void*)(3 * sizeof(float))); // vertex coords
-    // texcoords 
-    planeVAO->link(planeVBO, 2, 2, GL_FLOAT, 8 * sizeof(GLfloat), (void*)(6 * sizeof(float))); // vertex coords
+    // pos, normal, texcoord, same layout as the shared arena
+    arena = GeometryArena::standard();
+    planeGeometry = arena->add(verts, sizeof(verts) / (8 * sizeof(GLfloat)), elements, sizeof(elements) / sizeof(GLuint));
 
     initialised = true;
 }
 
-void PlaneRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride)
+void PlaneRenderer::render(std::shared_ptr<Scene> s, const glm::mat4& model, std::shared_ptr<Shader> shaderOverride)
 {
     // set default shader
     if (!shader)
         shader = object->getScene()->shaders[0];
 
-    // find object transform
-    std::shared_ptr<Transform> t = object->getComponent<Transform>();
-
-    // cannot find transform, don't render anything
-    if (t == nullptr)
-    {
-        std::cout << "WARN::" << object->getName() << "::planeRenderer::cannot find transform" << std::endl;
+    // activate the shader for this pass
+    std::shared_ptr<Shader> active = passShader(s, shaderOverride);
+    if (!active)
         return;
-    }
-
-    // activate the renderer's shader
-    if (shaderOverride)
-        shaderOverride->activate();
-    else
-        shader->activate();
+    active->activate();
 
     // model mat and normal mat
-    glm::mat4 modelMat = t->modelMatrix();
-    glm::mat3 normalMat = glm::mat3(glm::transpose(glm::inverse(modelMat)));
-    glUniformMatrix4fv(glGetUniformLocation(shader->id, "model"), 1, GL_FALSE, glm::value_ptr(modelMat));
-    glUniformMatrix3fv(glGetUniformLocation(shader->id, "normalMat"), 1, GL_FALSE, glm::value_ptr(normalMat));
+    glm::mat3 normalMat = glm::mat3(glm::transpose(glm::inverse(model)));
+    glUniformMatrix4fv(glGetUniformLocation(active->id, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix3fv(glGetUniformLocation(active->id, "normalMat"), 1, GL_FALSE, glm::value_ptr(normalMat));
 
     // load color / texture
     switch (mode)
     {
     case PlaneRenderer::Mode::MATERIAL:
-        glUniform3f(glGetUniformLocation(shader->id, "diffuseColor"),
+        glUniform3f(glGetUniformLocation(active->id, "diffuseColor"),
             diffuseColor.r,
             diffuseColor.g,
             diffuseColor.b
         );
-        glUniform3f(glGetUniformLocation(shader->id, "specularColor"),
+        glUniform3f(glGetUniformLocation(active->id, "specularColor"),
             specularColor.r,
             specularColor.g,
             specularColor.b
@@ -109,12 +89,12 @@ void PlaneRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> sha
         glBindTexture(GL_TEXTURE_2D, 0);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, 0);
-        glUniform1f(glGetUniformLocation(shader->id, "shininess"), shininess);
+        glUniform1f(glGetUniformLocation(active->id, "shininess"), shininess);
         break;
     case PlaneRenderer::Mode::TEX_MAP:
-        glUniform3f(glGetUniformLocation(shader->id, "diffuseColor"), 0, 0, 0);
-        glUniform3f(glGetUniformLocation(shader->id, "specularColor"), 0, 0, 0);
-        glUniform1f(glGetUniformLocation(shader->id, "shininess"), shininess);
+        glUniform3f(glGetUniformLocation(active->id, "diffuseColor"), 0, 0, 0);
+        glUniform3f(glGetUniformLocation(active->id, "specularColor"), 0, 0, 0);
+        glUniform1f(glGetUniformLocation(active->id, "shininess"), shininess);
         if (diffuseTex)
             diffuseTex->bind(GL_TEXTURE0);
         else {
@@ -127,13 +107,35 @@ void PlaneRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> sha
             glActiveTexture(GL_TEXTURE1);
             glBindTexture(GL_TEXTURE_2D, 0);
         }
-        glUniform1i(glGetUniformLocation(shader->id, "diffuseTex"), 0);
-        glUniform1i(glGetUniformLocation(shader->id, "specularTex"), 1);
+        glUniform1i(glGetUniformLocation(active->id, "diffuseTex"), 0);
+        glUniform1i(glGetUniformLocation(active->id, "specularTex"), 1);
         break;
     }
-    planeVAO->bind();
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
-    planeVAO->unbind();
+    arena->bind();
+    arena->draw(planeGeometry);
+}
+
+bool PlaneRenderer::batchSource(BatchMaterial& material, const void*& geometry)
+{
+    material.shader = shader ? shader : object->getScene()->shaders[0];
+    material.shininess = shininess;
+    if (mode == PlaneRenderer::Mode::TEX_MAP)
+    {
+        material.diffuseTex = diffuseTex;
+        material.specularTex = specularTex;
+    }
+    else
+    {
+        material.diffuseColor = diffuseColor;
+        material.specularColor = specularColor;
+    }
+    geometry = &planeGeometry;
+    return true;
+}
+
+void PlaneRenderer::readGeometry(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices)
+{
+    arena->read(planeGeometry, vertices, indices);
 }
 
 void PlaneRenderer::renderInspector()
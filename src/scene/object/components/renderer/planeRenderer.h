@@ -1,9 +1,7 @@
 #pragma once
 
 #include <scene/object/components/renderer/renderer.h>
-#include <util/vbo.h>
-#include <util/vao.h>
-#include <util/ebo.h>
+#include <util/geometryArena.h>
 
 #include <glm/glm.hpp>
 
@@ -11,9 +9,6 @@
 
 class Object;
 class Texture;
-class VAO;
-class VBO;
-class EBO;
 
 class PlaneRenderer : public Renderer {
 public:
@@ -29,11 +24,15 @@ public:
         specularTex = other.specularTex;
     }
     std::shared_ptr<Component> clone(std::shared_ptr<Object> newObj) {
-        return std::shared_ptr<Component>(new PlaneRenderer(*this, newObj));
+        return makePooled<PlaneRenderer>(*this, newObj);
     }
 
-    void render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride = nullptr) override;
+    void render(std::shared_ptr<Scene> s, const glm::mat4& model, std::shared_ptr<Shader> shaderOverride = nullptr) override;
+    AABB localBounds() override { return AABB(glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(1.0f, 0.0f, 1.0f)); }
     void renderInspector() override;
+    bool batchSource(BatchMaterial& material, const void*& geometry) override;
+    void readGeometry(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices) override;
+    GeometryArena::Handle arenaGeometry() override { return planeGeometry; }
     YAML::Emitter& serialise(YAML::Emitter& emitter) override
     {
         emitter << YAML::BeginMap;
@@ -122,7 +121,6 @@ public:
 protected:
     static bool initialised;
     // every renderer uses the same plane, make them static
-    static std::shared_ptr<VBO> planeVBO;
-    static std::shared_ptr<VAO> planeVAO;
-    static std::shared_ptr<EBO> planeEBO;
+    static std::shared_ptr<GeometryArena> arena;
+    static GeometryArena::Handle planeGeometry;
 };
\ No newline at end of file
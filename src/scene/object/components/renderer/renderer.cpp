@@ -0,0 +1,87 @@
+#include "renderer.h"
+
+#include <iostream>
+
+Renderer::Renderer(std::shared_ptr<Object> obj)
+    : Component(obj),
+    scene(obj->getScene().get()),
+    world(&obj->getScene()->world),
+    entity(obj->getEntity())
+{
+    RendererSet* set = world->get<RendererSet>(entity);
+    if (!set)
+        set = world->add<RendererSet>(entity);
+    if (set->count < RendererSet::INLINE)
+        set->renderers[set->count] = this;
+    else
+    {
+        if (!set->overflow)
+            set->overflow = new std::vector<Renderer*>();
+        set->overflow->push_back(this);
+    }
+    set->count++;
+}
+
+Renderer::~Renderer()
+{
+    unregister();
+}
+
+void Renderer::remove()
+{
+    unregister();
+    entity = Entity();
+    Component::remove();
+}
+
+void Renderer::unregister()
+{
+    // the batch still has our triangles
+    if (batched)
+    {
+        batched = false;
+        scene->staticBatches->dirty = true;
+    }
+
+    RendererSet* set = world->get<RendererSet>(entity);
+    if (!set)
+        return;
+    for (unsigned int i = 0; i < set->count; ++i)
+        if (set->at(i) == this)
+        {
+            set->at(i) = set->at(--set->count);
+            if (set->count < RendererSet::INLINE)
+                set->renderers[set->count] = nullptr;
+            else
+                set->overflow->pop_back();
+            break;
+        }
+    if (set->overflow && set->overflow->empty())
+    {
+        delete set->overflow;
+        set->overflow = nullptr;
+    }
+    if (set->count == 0)
+        world->remove<RendererSet>(entity);
+}
+
+std::shared_ptr<Shader> Renderer::passShader(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride)
+{
+    if (shaderOverride)
+        return shaderOverride;
+
+    std::shared_ptr<Shader> active;
+    switch (s->currentPass)
+    {
+    case Scene::Pass::GBUFFER_PASS: // deferred shaders only
+        active = shader->gbufferVariant;
+        break;
+    case Scene::Pass::FALLBACK_PASS: // whatever couldn't go in the g-buffer
+        active = shader->gbufferVariant ? nullptr : shader;
+        break;
+    default:
+        active = shader;
+    }
+    // built without what this draw doesn't need
+    return active ? s->shaderVariant(active, s->currentFeatures) : nullptr;
+}
\ No newline at end of file
@@ -4,17 +4,75 @@
 #include <scene/object/object.h>
 #include <scene/scene.h>
 #include <util/shader.h>
+#include <util/aabb.h>
+#include <util/geometryArena.h>
 
 #include <memory>
 
 class Object;
 class Scene;
 class Shader;
+class Texture;
+
+// how a renderer's draw looks to the static batcher, renderers with the
+// same material can be merged into one draw
+struct BatchMaterial {
+    std::shared_ptr<Shader> shader;
+    glm::vec3 diffuseColor = glm::vec3(0.0f);
+    glm::vec3 specularColor = glm::vec3(0.0f);
+    float shininess = 1.0f;
+    std::shared_ptr<Texture> diffuseTex;
+    std::shared_ptr<Texture> specularTex;
+
+    bool operator < (const BatchMaterial& o) const
+    {
+        if (shader != o.shader) return shader < o.shader;
+        if (diffuseTex != o.diffuseTex) return diffuseTex < o.diffuseTex;
+        if (specularTex != o.specularTex) return specularTex < o.specularTex;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (diffuseColor[i] != o.diffuseColor[i]) return diffuseColor[i] < o.diffuseColor[i];
+            if (specularColor[i] != o.specularColor[i]) return specularColor[i] < o.specularColor[i];
+        }
+        return shininess < o.shininess;
+    }
+};
 
 class Renderer : public Component
 {
 public:
-    Renderer(std::shared_ptr<Object> obj) : Component(obj) {}
-    virtual void render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride = nullptr) = 0;
+    Renderer(std::shared_ptr<Object> obj);
+    ~Renderer();
+    void remove() override;
+    // model is the world matrix to draw at, usually our object's but prefab
+    // instances draw the blueprint's renderers at their own
+    virtual void render(std::shared_ptr<Scene> s, const glm::mat4& model, std::shared_ptr<Shader> shaderOverride = nullptr) = 0;
     std::shared_ptr<Shader> shader = nullptr;
+
+    // object space bounds of what gets drawn, invalid if unknown
+    virtual AABB localBounds() { return AABB(); }
+
+    // static batching. batchSource fills in the material and a key for the
+    // geometry (same key, same triangles, so it's read back once per build),
+    // false if this renderer can't be batched. readGeometry gives the object
+    // space triangles in the usual layout (position, normal, texcoords)
+    virtual bool batchSource(BatchMaterial&, const void*&) { return false; }
+    virtual void readGeometry(std::vector<GLfloat>&, std::vector<GLuint>&) {}
+    // merged into a static batch, the batch draws it instead
+    bool batched = false;
+    // what's drawn, in the standard arena, for multi-draw indirect (the
+    // material comes from batchSource). 0 if it isn't in the arena
+    virtual GeometryArena::Handle arenaGeometry() { return 0; }
+
+protected:
+    // shader to draw with in the scene's current pass, nullptr if this
+    // renderer doesn't take part in the pass
+    std::shared_ptr<Shader> passShader(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride);
+
+private:
+    // listed in the entity's RendererSet for the draw list
+    void unregister();
+    Scene* scene;
+    World* world;
+    Entity entity;
 };
\ No newline at end of file
@@ -15,9 +15,8 @@
 #include <memory>
 
 bool SphereRenderer::initialised = false;
-std::shared_ptr<VBO> SphereRenderer::sphereVBO;
-std::shared_ptr<VAO> SphereRenderer::sphereVAO;
-std::shared_ptr<EBO> SphereRenderer::sphereEBO;
+std::shared_ptr<GeometryArena> SphereRenderer::arena;
+GeometryArena::Handle SphereRenderer::sphereGeometry = 0;
 
 SphereRenderer::SphereRenderer(std::shared_ptr<Object> obj) : Renderer(obj)
 {
@@ -96,59 +95,40 @@ void SphereRenderer::initVertexData() {
         }
     }
 
-    sphereVAO = std::shared_ptr<VAO>(new VAO());
-    sphereVBO = std::shared_ptr<VBO>(new VBO(sphereVAO, &verts[0], verts.size() * sizeof(GLfloat)));
-    sphereEBO = std::shared_ptr<EBO>(new EBO(sphereVAO, &elements[0], elements.size() * sizeof(GLuint)));
-
-    // set buffer attributes
-    // vertex positions
-    sphereVAO->link(sphereVBO, 0, 3, GL_FLOAT, 8 * sizeof(GLfloat), (void*)0); // vertex coords
-    // normals 
-    sphereVAO->link(sphereVBO, 1, 3, GL_FLOAT, 8 * sizeof(GLfloat), (void*)(3 * sizeof(float))); // vertex coords
-    // texcoords 
-    sphereVAO->link(sphereVBO, 2, 2, GL_FLOAT, 8 * sizeof(GLfloat), (void*)(6 * sizeof(float))); // vertex coords
+    // pos, normal, texcoord, same layout as the shared arena
+    arena = GeometryArena::standard();
+    sphereGeometry = arena->add(verts.data(), verts.size() / 8, elements.data(), elements.size());
 
     initialised = true;
 }
 
-void SphereRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride)
+void SphereRenderer::render(std::shared_ptr<Scene> s, const glm::mat4& model, std::shared_ptr<Shader> shaderOverride)
 {
     // set default shader
     if (!shader)
         shader = object->getScene()->shaders[0];
 
-    // find object transform
-    std::shared_ptr<Transform> t = object->getComponent<Transform>();
-
-    // cannot find transform, don't render anything
-    if (t == nullptr)
-    {
-        std::cout << "WARN::" << object->getName() << "::sphereRenderer::cannot find transform" << std::endl;
+    // activate the shader for this pass
+    std::shared_ptr<Shader> active = passShader(s, shaderOverride);
+    if (!active)
         return;
-    }
-
-    // activate the renderer's shader
-    if (shaderOverride)
-        shaderOverride->activate();
-    else
-        shader->activate();
+    active->activate();
 
     // model mat and normal mat
-    glm::mat4 modelMat = t->modelMatrix();
-    glm::mat3 normalMat = glm::mat3(glm::transpose(glm::inverse(modelMat)));
-    glUniformMatrix4fv(glGetUniformLocation(shader->id, "model"), 1, GL_FALSE, glm::value_ptr(modelMat));
-    glUniformMatrix3fv(glGetUniformLocation(shader->id, "normalMat"), 1, GL_FALSE, glm::value_ptr(normalMat));
+    glm::mat3 normalMat = glm::mat3(glm::transpose(glm::inverse(model)));
+    glUniformMatrix4fv(glGetUniformLocation(active->id, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix3fv(glGetUniformLocation(active->id, "normalMat"), 1, GL_FALSE, glm::value_ptr(normalMat));
 
     // load color / texture
     switch (mode)
     {
     case SphereRenderer::Mode::MATERIAL:
-        glUniform3f(glGetUniformLocation(shader->id, "diffuseColor"),
+        glUniform3f(glGetUniformLocation(active->id, "diffuseColor"),
             diffuseColor.r,
             diffuseColor.g,
             diffuseColor.b
         );
-        glUniform3f(glGetUniformLocation(shader->id, "specularColor"),
+        glUniform3f(glGetUniformLocation(active->id, "specularColor"),
             specularColor.r,
             specularColor.g,
             specularColor.b
@@ -157,12 +137,12 @@ void SphereRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> sh
         glBindTexture(GL_TEXTURE_2D, 0);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, 0);
-        glUniform1f(glGetUniformLocation(shader->id, "shininess"), shininess);
+        glUniform1f(glGetUniformLocation(active->id, "shininess"), shininess);
         break;
     case SphereRenderer::Mode::TEX_MAP:
-        glUniform3f(glGetUniformLocation(shader->id, "diffuseColor"), 0, 0, 0);
-        glUniform3f(glGetUniformLocation(shader->id, "specularColor"), 0, 0, 0);
-        glUniform1f(glGetUniformLocation(shader->id, "shininess"), shininess);
+        glUniform3f(glGetUniformLocation(active->id, "diffuseColor"), 0, 0, 0);
+        glUniform3f(glGetUniformLocation(active->id, "specularColor"), 0, 0, 0);
+        glUniform1f(glGetUniformLocation(active->id, "shininess"), shininess);
         if (diffuseTex)
             diffuseTex->bind(GL_TEXTURE0);
         else {
@@ -175,13 +155,35 @@ void SphereRenderer::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> sh
             glActiveTexture(GL_TEXTURE1);
             glBindTexture(GL_TEXTURE_2D, 0);
         }
-        glUniform1i(glGetUniformLocation(shader->id, "diffuseTex"), 0);
-        glUniform1i(glGetUniformLocation(shader->id, "specularTex"), 1);
+        glUniform1i(glGetUniformLocation(active->id, "diffuseTex"), 0);
+        glUniform1i(glGetUniformLocation(active->id, "specularTex"), 1);
         break;
     }
-    sphereVAO->bind();
-    glDrawElements(GL_TRIANGLES, sphereEBO->size, GL_UNSIGNED_INT, (void*)0);
-    sphereVAO->unbind();
+    arena->bind();
+    arena->draw(sphereGeometry);
+}
+
+bool SphereRenderer::batchSource(BatchMaterial& material, const void*& geometry)
+{
+    material.shader = shader ? shader : object->getScene()->shaders[0];
+    material.shininess = shininess;
+    if (mode == SphereRenderer::Mode::TEX_MAP)
+    {
+        material.diffuseTex = diffuseTex;
+        material.specularTex = specularTex;
+    }
+    else
+    {
+        material.diffuseColor = diffuseColor;
+        material.specularColor = specularColor;
+    }
+    geometry = &sphereGeometry;
+    return true;
+}
+
+void SphereRenderer::readGeometry(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices)
+{
+    arena->read(sphereGeometry, vertices, indices);
 }
 
 void SphereRenderer::renderInspector()
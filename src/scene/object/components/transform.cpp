@@ -10,26 +10,88 @@
 
 #include <iostream>
 
+Transform::Transform(std::shared_ptr<Object> obj, glm::vec3 position, glm::vec3 rotation, glm::vec3 scale)
+    : Component(obj),
+    world(&obj->getScene()->world),
+    entity(obj->getEntity())
+{
+    name = "Transform";
+    TransformData d;
+    d.position = position;
+    d.rotation = rotation;
+    d.scale = scale;
+    d.object = obj.get();
+    world->add<TransformData>(entity, d);
+    savePrevious();
+}
+
+Transform::~Transform()
+{
+    // nothing happens if the object (and its entity) went first
+    world->remove<TransformData>(entity);
+}
+
+void Transform::remove()
+{
+    detached = data(); // keeps where it was
+    detached.object = nullptr;
+    world->remove<TransformData>(entity);
+    entity = Entity();
+    Component::remove();
+}
+
 glm::vec3 Transform::worldPos()
 {
     return modelMatrix() * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
 }
 
-glm::mat4 Transform::localMatrix() {
-    glm::vec3 rotationRad(glm::radians(rotation.x), glm::radians(rotation.y), glm::radians(rotation.z));
+static glm::mat4 localMatrix(const TransformData& d)
+{
+    glm::vec3 rotationRad(glm::radians(d.rotation.x), glm::radians(d.rotation.y), glm::radians(d.rotation.z));
     glm::mat4 model =
-        glm::translate(glm::mat4(1.0f), position) *
+        glm::translate(glm::mat4(1.0f), d.position) *
         glm::toMat4(glm::quat(rotationRad)) *
-        glm::scale(glm::mat4(1.0f), scale);
+        glm::scale(glm::mat4(1.0f), d.scale);
     return model;
 }
 
-glm::mat4 Transform::modelMatrix() {
-    glm::vec3 rotationRad(glm::radians(rotation.x), glm::radians(rotation.y), glm::radians(rotation.z));
+glm::mat4 Transform::localMatrix() {
+    return ::localMatrix(data());
+}
+
+void Transform::savePrevious()
+{
+    TransformData& d = data();
+    d.previousPosition = d.position;
+    d.previousRotation = d.rotation;
+    d.previousScale = d.scale;
+}
+
+glm::mat4 Transform::interpolatedMatrix(float alpha)
+{
+    return interpolatedMatrix(data(), alpha);
+}
+
+glm::mat4 Transform::interpolatedMatrix(const TransformData& d, float alpha)
+{
+    // not moving, keep it bit for bit the same as localMatrix (cached
+    // static shadows compare matrices)
+    if (d.previousPosition == d.position && d.previousRotation == d.rotation && d.previousScale == d.scale)
+        return ::localMatrix(d);
+
+    // slerp the rotation, lerping euler angles goes the long way round when
+    // one of them wraps
+    glm::quat from(glm::radians(d.previousRotation));
+    glm::quat to(glm::radians(d.rotation));
     glm::mat4 model =
-        glm::translate(glm::mat4(1.0f), position) *
-        glm::toMat4(glm::quat(rotationRad)) *
-        glm::scale(glm::mat4(1.0f), scale);
+        glm::translate(glm::mat4(1.0f), glm::mix(d.previousPosition, d.position, alpha)) *
+        glm::toMat4(glm::slerp(from, to, alpha)) *
+        glm::scale(glm::mat4(1.0f), glm::mix(d.previousScale, d.scale, alpha));
+    return model;
+}
+
+glm::mat4 Transform::modelMatrix() {
+    glm::mat4 model = ::localMatrix(data());
 
     if (object->getParent() == nullptr) // parentless
         return model;
@@ -55,9 +117,9 @@ glm::mat4 Transform::modelMatrix() {
 
 void Transform::renderInspector() {
     ImGui::Text("Transform");
-    ImGui::DragFloat3("Position", glm::value_ptr(position), 0.01f);
-    ImGui::DragFloat3("Rotation", glm::value_ptr(rotation));
-    ImGui::DragFloat3("Scale", glm::value_ptr(scale), 0.01f, 0.01f);
+    ImGui::DragFloat3("Position", glm::value_ptr(position()), 0.01f);
+    ImGui::DragFloat3("Rotation", glm::value_ptr(rotation()));
+    ImGui::DragFloat3("Scale", glm::value_ptr(scale()), 0.01f, 0.01f);
     ImGui::NewLine();
     glm::vec3 worldpos = worldPos();
     ImGui::Text(std::string("World Coords: " + std::to_string(worldpos.x) + "," + std::to_string(worldpos.y) + "," + std::to_string(worldpos.z)).c_str());
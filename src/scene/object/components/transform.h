@@ -3,51 +3,46 @@
 #include <glm/glm.hpp>
 
 #include <scene/object/components/component.h>
+#include <scene/ecs/world.h>
+#include <scene/ecs/components.h>
 
 #include <string>
 #include <memory>
 
 class Object;
 
+// view onto the object's TransformData in the scene's World, the data
+// itself lives in the world's columns so systems can run over it without
+// touching objects. the references handed out are good until the next
+// structural change to the world (adding/removing components or objects)
 class Transform : public Component
 {
 public:
-    Transform(std::shared_ptr<Object> obj)
-        : Component(obj),
-        position(glm::vec3(0.0)),
-        rotation(glm::vec3(0.0)),
-        scale(glm::vec3(1.0))
-    {
-        name = "Transform";
-    }
-    Transform(std::shared_ptr<Object> obj, glm::vec3 position, glm::vec3 rotation, glm::vec3 scale)
-        : Component(obj),
-        position(position),
-        rotation(rotation),
-        scale(scale)
-    {
-        name = "Transform";
-    }
+    Transform(std::shared_ptr<Object> obj) : Transform(obj, glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f)) {}
+    Transform(std::shared_ptr<Object> obj, glm::vec3 position, glm::vec3 rotation, glm::vec3 scale);
     Transform(const Transform& other) = delete;
-    Transform(const Transform& other, std::shared_ptr<Object> newObj) : Transform(newObj, other.position, other.rotation, other.scale) {}
+    Transform(const Transform& other, std::shared_ptr<Object> newObj) : Transform(newObj, other.data().position, other.data().rotation, other.data().scale) {}
+    ~Transform();
     std::shared_ptr<Component> clone(std::shared_ptr<Object> newObj) override {
-        return std::shared_ptr<Component>(new Transform(*this, newObj));
+        return makePooled<Transform>(*this, newObj);
     }
     void renderInspector() override;
+    void remove() override;
 
     YAML::Emitter& serialise(YAML::Emitter& emitter) override
     {
+        const TransformData& d = data();
         emitter << YAML::BeginMap;
         emitter << YAML::Key << "name";
         emitter << YAML::Value << "Transform";
         emitter << YAML::Key << "position" << YAML::Value << YAML::Flow << YAML::BeginSeq
-            << position.x << position.y << position.z
+            << d.position.x << d.position.y << d.position.z
             << YAML::EndSeq;
         emitter << YAML::Key << "rotation" << YAML::Value << YAML::Flow << YAML::BeginSeq
-            << rotation.x << rotation.y << rotation.z
+            << d.rotation.x << d.rotation.y << d.rotation.z
             << YAML::EndSeq;
         emitter << YAML::Key << "scale" << YAML::Value << YAML::Flow << YAML::BeginSeq
-            << scale.x << scale.y << scale.z
+            << d.scale.x << d.scale.y << d.scale.z
             << YAML::EndSeq;
         emitter << YAML::EndMap;
         return emitter;
@@ -55,28 +50,57 @@ public:
     void _deserialise(const YAML::Node& componentNode) override
     {
         // do the reverse of serialise duh
-        position = glm::vec3(
+        position() = glm::vec3(
             componentNode["position"][0].as<float>(),
             componentNode["position"][1].as<float>(),
             componentNode["position"][2].as<float>()
         );
-        rotation = glm::vec3(
+        rotation() = glm::vec3(
             componentNode["rotation"][0].as<float>(),
             componentNode["rotation"][1].as<float>(),
             componentNode["rotation"][2].as<float>()
         );
-        scale = glm::vec3(
+        scale() = glm::vec3(
             componentNode["scale"][0].as<float>(),
             componentNode["scale"][1].as<float>(),
             componentNode["scale"][2].as<float>()
         );
+        savePrevious();
     }
 
     glm::vec3 worldPos();
     glm::mat4 localMatrix();
     glm::mat4 modelMatrix();
 
-    glm::vec3 position;
-    glm::vec3 rotation;
-    glm::vec3 scale;
+    // state at the start of the last simulation tick, rendering blends from
+    // it to the current state so motion stays smooth between ticks
+    void savePrevious();
+    glm::mat4 interpolatedMatrix(float alpha);
+    static glm::mat4 interpolatedMatrix(const TransformData& d, float alpha);
+    glm::vec3& previousPosition() { return data().previousPosition; }
+    glm::vec3& previousRotation() { return data().previousRotation; }
+    glm::vec3& previousScale() { return data().previousScale; }
+
+    glm::vec3& position() { return data().position; }
+    glm::vec3& rotation() { return data().rotation; }
+    glm::vec3& scale() { return data().scale; }
+
+    // modelMatrix() as of the last Scene::update (interpolated between the
+    // last two ticks), filled in by the (parallel) world matrix pass so
+    // rendering doesn't walk up the parents every time
+    glm::mat4& worldMatrix() { return data().worldMatrix; }
+
+    TransformData& data() const
+    {
+        TransformData* d = world->get<TransformData>(entity);
+        return d ? *d : detached;
+    }
+
+private:
+    World* world;
+    Entity entity;
+    // stands in for the data once the transform has been taken off its
+    // object (or the object went) while something still holds on to it,
+    // one each so detached transforms don't write over each other
+    mutable TransformData detached;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "object.h"
 
 #include <scene/object/components/renderer/renderer.h>
+#include <scene/object/components/transform.h>
 #include <scene/object/components/component.h>
 #include <scene/object/scripts/script.h>
 
@@ -14,6 +15,15 @@ YAML::Emitter& operator<< (YAML::Emitter& serialiser, const Object& o) {
     // name
     serialiser << YAML::Key << "name";
     serialiser << YAML::Value << o.name;
+    serialiser << YAML::Key << "id" << YAML::Value << o.handle.index;
+    if (o.isStatic)
+        serialiser << YAML::Key << "static" << YAML::Value << true;
+    // instances only save what they override, the rest comes from the
+    // blueprint again when loading
+    if (o.prefab && o.prefab->getParent())
+        serialiser << YAML::Key << "prefabChild" << YAML::Value << o.prefab->name;
+    else if (o.prefab)
+        serialiser << YAML::Key << "prefab" << YAML::Value << o.prefab->name;
 
     // components (as another sequence of maps)
     serialiser << YAML::Key << "components";
@@ -40,10 +50,25 @@ YAML::Emitter& operator<< (YAML::Emitter& serialiser, const Object& o) {
     return serialiser;
 }
 
-std::shared_ptr<Object> Object::deserialise(const YAML::Node& objectNode, std::shared_ptr<Scene> s)
+std::shared_ptr<Object> Object::deserialise(const YAML::Node& objectNode, std::shared_ptr<Scene> s,
+    std::map<unsigned int, std::shared_ptr<Object>>* ids, std::shared_ptr<Object> prefabSource)
 {
-    std::shared_ptr<Object> obj(new Object(s));
+    std::shared_ptr<Object> obj = makePooled<Object>(s);
     obj->name = objectNode["name"].as<std::string>();
+    obj->isStatic = objectNode["static"].as<bool>(false);
+    if (ids && objectNode["id"])
+        (*ids)[objectNode["id"].as<unsigned int>()] = obj;
+    if (prefabSource)
+        obj->setPrefab(prefabSource);
+    else if (objectNode["prefab"])
+    {
+        std::string prefabName = objectNode["prefab"].as<std::string>();
+        for (auto blueprint : s->blueprints)
+            if (blueprint->name == prefabName)
+                obj->setPrefab(blueprint);
+        if (!obj->prefab)
+            std::cout << "WARN::OBJECT::" << obj->name << "::could not find blueprint " << prefabName << ", loading the overrides only" << std::endl;
+    }
 
     for (auto it = objectNode["components"].begin(); it != objectNode["components"].end(); ++it)
     {
@@ -61,25 +86,67 @@ std::shared_ptr<Object> Object::deserialise(const YAML::Node& objectNode, std::s
 
     for (auto it = objectNode["children"].begin(); it != objectNode["children"].end(); ++it)
     {
-        auto o = Object::deserialise(it->as<YAML::Node>(), s);
-        o->parent = obj;
+        // overridden child, find what it overrides in our blueprint first
+        std::shared_ptr<Object> source;
+        if (obj->prefab && (*it)["prefabChild"])
+        {
+            std::string sourceName = (*it)["prefabChild"].as<std::string>();
+            for (auto candidate : obj->prefab->children)
+                if (candidate->name == sourceName && !obj->overrides(candidate.get()))
+                {
+                    source = candidate;
+                    break;
+                }
+        }
+        auto o = Object::deserialise(it->as<YAML::Node>(), s, ids, source);
         if (o)
-            obj->children.push_back(o);
+        {
+            o->parent = obj;
+            o->link(obj->children);
+        }
     }
 
     return obj;
 }
 
+Object::Object(std::shared_ptr<Scene> s) : scene(s.get())
+{
+    handle = scene->registerObject(this);
+    entity = scene->world.create();
+}
+
+Object::~Object()
+{
+    scene->unregisterObject(handle);
+    scene->world.destroy(entity);
+}
+
+void Object::setName(std::string name)
+{
+    this->name = name;
+    scene->hierarchyVersion++;
+}
+
+std::shared_ptr<Scene> Object::getScene()
+{
+    return scene->shared_from_this();
+}
+
 std::shared_ptr<Object> Object::clone(std::shared_ptr<Object> parent)
 {
-    std::shared_ptr<Object> newObj(new Object(this->scene));
+    std::shared_ptr<Object> newObj = makePooled<Object>(getScene());
     newObj->setName(name + " (Clone)");
+    newObj->isStatic = isStatic;
+    newObj->setPrefab(prefab);
     if (parent)
+    {
         newObj->parent = parent;
+        newObj->link(parent->children);
+    }
 
-    // deep copy children
+    // deep copy children (they link themselves)
     for (auto child : children)
-        newObj->children.push_back(child->clone(newObj));
+        child->clone(newObj);
 
     // deep copy components
     for (auto component : components)
@@ -91,100 +158,245 @@ std::shared_ptr<Object> Object::clone(std::shared_ptr<Object> parent)
     return newObj;
 }
 
+std::shared_ptr<Object> Object::instantiate()
+{
+    std::shared_ptr<Object> instance = instanceOf(nullptr);
+    instance->overrideRequired();
+    return instance;
+}
+
+std::shared_ptr<Object> Object::instanceOf(std::shared_ptr<Object> parent)
+{
+    std::shared_ptr<Object> instance = makePooled<Object>(getScene());
+    instance->setName(name);
+    instance->isStatic = isStatic;
+    instance->setPrefab(shared_from_this());
+    if (parent)
+    {
+        instance->parent = parent;
+        instance->link(parent->children);
+    }
+    for (auto component : components)
+        instance->components.push_back(component->clone(instance));
+    for (auto script : scripts)
+        instance->scripts.push_back(script->clone(instance));
+    return instance;
+}
+
+// anything that does more than sit there and get drawn
+static bool needsInstance(Object* node)
+{
+    if (!node->scripts.empty())
+        return true;
+    for (auto component : node->components)
+        if (!dynamic_cast<Transform*>(component.get()) && !dynamic_cast<Renderer*>(component.get()))
+            return true;
+    for (auto child : node->children)
+        if (needsInstance(child.get()))
+            return true;
+    return false;
+}
+
+void Object::overrideRequired()
+{
+    if (!prefab)
+        return;
+    for (auto source : prefab->children)
+        if (needsInstance(source.get()))
+            overridePrefabChild(source);
+}
+
+std::shared_ptr<Object> Object::overridePrefabChild(std::shared_ptr<Object> source)
+{
+    if (!prefab || source->getParent() != prefab)
+    {
+        std::cout << "WARN::OBJECT::" << name << "::" << source->name << " isn't part of our prefab" << std::endl;
+        return nullptr;
+    }
+    for (auto child : children)
+        if (child->prefab == source)
+            return child;
+    std::shared_ptr<Object> copy = source->instanceOf(shared_from_this());
+    copy->overrideRequired();
+    return copy;
+}
+
+bool Object::overrides(Object* source)
+{
+    for (auto& child : children)
+        if (child->prefab.get() == source)
+            return true;
+    return false;
+}
+
+std::vector<std::shared_ptr<Object>> Object::prefabChildren()
+{
+    std::vector<std::shared_ptr<Object>> result;
+    if (prefab)
+        for (auto source : prefab->children)
+            if (!overrides(source.get()))
+                result.push_back(source);
+    return result;
+}
+
+void Object::setPrefab(std::shared_ptr<Object> p)
+{
+    prefab = p;
+    if (prefab)
+    {
+        PrefabRef ref;
+        ref.object = this;
+        scene->world.add<PrefabRef>(entity, ref);
+    }
+    else
+        scene->world.remove<PrefabRef>(entity);
+}
+
+const std::vector<Object::PrefabDraw>& Object::prefabDraws(unsigned long long frame)
+{
+    // a blueprint that (somehow) ends up inside itself sees nothing instead
+    // of recursing forever
+    static const std::vector<PrefabDraw> none;
+    if (gatheringPrefabDraws)
+        return none;
+    if (frame == prefabDrawFrame)
+        return prefabDrawCache;
+
+    gatheringPrefabDraws = true;
+    prefabDrawCache.clear();
+    for (auto child : children)
+        gatherPrefabDraws(child.get(), glm::mat4(1.0f), isStatic, child.get(), frame);
+    gatheringPrefabDraws = false;
+    prefabDrawFrame = frame;
+    return prefabDrawCache;
+}
+
+void Object::gatherPrefabDraws(Object* node, const glm::mat4& relative, bool isStatic, Object* child, unsigned long long frame)
+{
+    // blueprints aren't simulated, their local matrices are all there is
+    std::shared_ptr<Transform> t = node->getComponent<Transform>();
+    glm::mat4 model = t ? relative * t->localMatrix() : relative;
+    isStatic = isStatic || node->isStatic;
+    for (auto component : node->components)
+    {
+        Renderer* r = dynamic_cast<Renderer*>(component.get());
+        if (r && t)
+            prefabDrawCache.push_back({ r, model, isStatic, child });
+    }
+    // an instance inside the blueprint
+    if (node->prefab)
+        for (auto& draw : node->prefab->prefabDraws(frame))
+            if (!node->overrides(draw.child))
+                prefabDrawCache.push_back({ draw.renderer, model * draw.model, isStatic || draw.isStatic, child });
+    for (auto grandchild : node->children)
+        gatherPrefabDraws(grandchild.get(), model, isStatic, child, frame);
+}
+
 void Object::reparent(std::shared_ptr<Object> p, bool blueprint)
 {
     // increment the ref count so we don't get nuked
     // by shared_ptr just in case this object is empty
     std::shared_ptr<Object> temporary = this->shared_from_this();
-    
-    // do we have a parent? remove us from their children
-    if (parent != nullptr)
-        for (auto it = parent->children.begin(); it != parent->children.end(); ++it) {
-            if (it->get() == this)
-            {
-                parent->children.erase(it);
-                break;
-            }
+
+    // can't go under ourselves, the subtree would own itself
+    for (std::shared_ptr<Object> a = p; a != nullptr; a = a->getParent())
+        if (a.get() == this)
+        {
+            std::cout << "WARN::OBJECT::" << name << "::can't reparent under itself" << std::endl;
+            return;
         }
-    else // remove from scene direct child
-        if (!blueprint)
-            for (auto it = scene->objects.begin(); it != scene->objects.end(); ++it) {
-                if (it->get() == this)
-                {
-                    scene->objects.erase(it);
-                    break;
-                }
-            }
-        else
-            for (auto it = scene->blueprints.begin(); it != scene->blueprints.end(); ++it) {
-                if (it->get() == this)
-                {
-                    scene->blueprints.erase(it);
-                    break;
-                }
-            }
+
+    // out of wherever we are now
+    unlink();
 
     // are we just setting to null?
     if (p == nullptr) {
         parent.reset();
-        parent = nullptr;
-        if (!blueprint)
-            scene->objects.push_back(shared_from_this()); // add back to scene direct child
-        else
-            scene->blueprints.push_back(shared_from_this());
+        link(blueprint ? scene->blueprints : scene->objects); // add back to scene direct child
         return;
     }
 
-    // find parent and add to children
     parent = p;
-    parent->children.push_back(this->shared_from_this());
+    link(p->children);
 }
 
-void Object::update(std::shared_ptr<Scene> s) {
-    for (auto script : scripts)
-        script->update(s);
+void Object::link(std::vector<std::shared_ptr<Object>>& siblings)
+{
+    siblingIndex = siblings.size();
+    siblings.push_back(shared_from_this());
+    scene->hierarchyVersion++;
+    std::shared_ptr<Object> p = parent.lock();
+    scene->world.setParent(entity, p ? p->entity : Entity());
+    setInScene(&siblings == &scene->objects || (p && scene->world.has<InScene>(p->entity)));
+}
+
+void Object::setInScene(bool inScene)
+{
+    // a subtree is always all in or all out
+    if (scene->world.has<InScene>(entity) == inScene)
+        return;
+    if (inScene)
+        scene->world.add<InScene>(entity);
+    else
+        scene->world.remove<InScene>(entity);
     for (auto child : children)
-        child->update(s);
+        child->setInScene(inScene);
 }
 
-void Object::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride) {
-    for (auto component : components)
+bool Object::unlink(std::vector<std::shared_ptr<Object>>& siblings)
+{
+    if (siblingIndex >= siblings.size() || siblings[siblingIndex].get() != this)
+        return false;
+
+    // move the last sibling into our place instead of shifting everyone down
+    size_t i = siblingIndex;
+    siblingIndex = NOT_LINKED;
+    if (i + 1 != siblings.size())
     {
-        std::shared_ptr<Renderer> r = std::dynamic_pointer_cast<Renderer>(component);
-        if (r != nullptr)
-            r->render(s, shaderOverride);
+        siblings[i] = std::move(siblings.back());
+        siblings[i]->siblingIndex = i;
     }
-    for (auto child : children)
-        child->render(s, shaderOverride);
+    siblings.pop_back();
+    scene->hierarchyVersion++;
+    return true;
+}
+
+void Object::unlink()
+{
+    std::shared_ptr<Object> p = parent.lock();
+    if (p != nullptr)
+        unlink(p->children);
+    else if (!unlink(scene->objects)) // scene root or blueprint, siblingIndex tells which
+        unlink(scene->blueprints);
 }
 
 void Object::remove()
 {
-    // remove all children
+    // whoever owns us lets go at the end, stay alive until we're done
+    std::shared_ptr<Object> self = shared_from_this();
+    release();
+
+    // let go of us
+    unlink();
+}
+
+void Object::release()
+{
+    scene->world.remove<InScene>(entity);
+    if (scene->inspectedObject.get() == this)
+        scene->inspectedObject = nullptr;
+    if (scene->activeCamera && scene->activeCamera->getObject().get() == this)
+        scene->activeCamera = nullptr;
+
+    // children go with the children vector when we do, erasing them one at
+    // a time from the front would make deleting a big subtree quadratic
     for (auto child : children)
         if (child)
-            child->remove();
+            child->release();
 
-    // remove all components
-    for (auto component : components)
+    // remove all components (iterate over a copy, removing erases from the original)
+    auto componentsCopy = components;
+    for (auto component : componentsCopy)
         if (component)
             component->remove();
-
-    // 
-    if (parent != nullptr)
-        for (auto it = parent->children.begin(); it != parent->children.end(); ++it) {
-            if (it->get() == this)
-            {
-                parent->children.erase(it);
-                break;
-            }
-        }
-    else // remove from scene direct child
-        for (auto it = scene->objects.begin(); it != scene->objects.end(); ++it) {
-            if (it->get() == this)
-            {
-                scene->objects.erase(it);
-                break;
-            }
-        }
 }
\ No newline at end of file
@@ -4,37 +4,78 @@
 
 #include <scene/object/components/component.h>
 #include <scene/object/scripts/script.h>
+#include <scene/object/objectHandle.h>
+#include <scene/ecs/world.h>
 #include <scene/scene.h>
+#include <util/aabb.h>
 
 #include <yaml-cpp/yaml.h>
 
 #include <vector>
 #include <memory>
 #include <string>
+#include <map>
 
 class Scene;
 class Component;
 class Object;
 class Script;
 class Shader;
+class Renderer;
 
+// ownership only goes down: the scene owns its root objects, objects own
+// their children, components and scripts. everything pointing back up (parent,
+// scene, a component's object) is weak or raw so removing an object frees it
 class Object : public std::enable_shared_from_this<Object>
 {
 public:
-    Object(std::shared_ptr<Scene> s) : scene(s) {}
+    Object(std::shared_ptr<Scene> s);
     Object(const Object& other) = delete; // use clone()
+    ~Object();
 
     std::vector<std::shared_ptr<Component>> components;
+    // read only, add with addChild / reparent (they track where each child
+    // sits so removing and reparenting don't have to search)
     std::vector<std::shared_ptr<Object>> children;
     std::vector<std::shared_ptr<Script>> scripts;
 
-    void setName(std::string name) { this->name = name; }
-    std::string getName() { return name; }
-    std::shared_ptr<Object> getParent() { return parent; }
-    std::shared_ptr<Scene> getScene() { return scene; }
+    // never moves (includes children), lets the renderer cache things like shadows
+    bool isStatic = false;
+
+    void setName(std::string name);
+    const std::string& getName() { return name; }
+    std::shared_ptr<Object> getParent() { return parent.lock(); }
+    std::shared_ptr<Scene> getScene();
+    ObjectHandle getHandle() { return handle; }
+    Entity getEntity() { return entity; } // in the scene's World
 
     std::shared_ptr<Object> clone(std::shared_ptr<Object> parent = nullptr);
 
+    // prefab instances. instantiate() on a blueprint copies only the root's
+    // components and scripts, the rest of the blueprint is drawn from the
+    // blueprint itself until a child is overridden (copy on write, the child
+    // becomes a real object of the instance). nodes with scripts or anything
+    // other than a transform and renderers are overridden up front since
+    // they have to run per instance
+    std::shared_ptr<Object> instantiate();
+    // source must be a child of our prefab, returns our copy of it (made
+    // now if it isn't overridden yet)
+    std::shared_ptr<Object> overridePrefabChild(std::shared_ptr<Object> source);
+    bool overrides(Object* source);
+    std::vector<std::shared_ptr<Object>> prefabChildren(); // not overridden yet
+    // the blueprint node we stand in for, nullptr if we're not an instance
+    std::shared_ptr<Object> getPrefab() { return prefab; }
+
+    // what an instance of this blueprint node draws: the renderers under it
+    // relative to it, refreshed once per draw list frame
+    struct PrefabDraw {
+        Renderer* renderer;
+        glm::mat4 model; // relative to the blueprint node
+        bool isStatic;
+        Object* child;   // our child it sits under, skipped once that's overridden
+    };
+    const std::vector<PrefabDraw>& prefabDraws(unsigned long long frame);
+
     template<typename C>
     std::shared_ptr<C> getComponent()
     {
@@ -47,16 +88,45 @@ public:
         }
         return c;
     }
+    // p == nullptr makes us a scene root (or a blueprint)
     void reparent(std::shared_ptr<Object> p, bool blueprint = false);
+    void addChild(std::shared_ptr<Object> child) { child->reparent(shared_from_this()); }
     void remove();
-    void update(std::shared_ptr<Scene> s);
-    void render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shaderOverride = nullptr);
 
     friend YAML::Emitter& operator << (YAML::Emitter& emitter, const Object& o);
-    static std::shared_ptr<Object> deserialise(const YAML::Node& objectNode, std::shared_ptr<Scene> s);
+    // ids maps the save file's object ids to the new objects, for anything
+    // that refers to objects by id (see Scene::load). prefabSource is the
+    // part of the parent's blueprint an overridden child stands in for, set
+    // before its own children are read so theirs can be found too
+    static std::shared_ptr<Object> deserialise(const YAML::Node& objectNode, std::shared_ptr<Scene> s,
+        std::map<unsigned int, std::shared_ptr<Object>>* ids = nullptr, std::shared_ptr<Object> prefabSource = nullptr);
 
 protected:
-    std::shared_ptr<Scene> scene;
+    // drop scene references and components of this subtree, the caller
+    // unlinks the root
+    void release();
+
+    // sibling list bookkeeping, swap removes and keeps siblingIndex right
+    static const size_t NOT_LINKED = (size_t)-1;
+    void link(std::vector<std::shared_ptr<Object>>& siblings);
+    bool unlink(std::vector<std::shared_ptr<Object>>& siblings);
+    void unlink();
+    // InScene tag for us and everything under us
+    void setInScene(bool inScene);
+    // our components and scripts copied onto a new instance of us
+    std::shared_ptr<Object> instanceOf(std::shared_ptr<Object> parent);
+    void overrideRequired();
+    void setPrefab(std::shared_ptr<Object> p);
+    void gatherPrefabDraws(Object* node, const glm::mat4& relative, bool isStatic, Object* child, unsigned long long frame);
+
+    Scene* scene; // the scene outlives its objects
     std::string name;
-    std::shared_ptr<Object> parent = nullptr;
+    std::weak_ptr<Object> parent;
+    ObjectHandle handle;
+    Entity entity;
+    size_t siblingIndex = NOT_LINKED; // in the parent's children, or the scene's objects / blueprints
+    std::shared_ptr<Object> prefab;
+    std::vector<PrefabDraw> prefabDrawCache;
+    unsigned long long prefabDrawFrame = ~0ull;
+    bool gatheringPrefabDraws = false;
 };
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+// reference to an object that doesn't keep it alive and can't dangle: the
+// scene's registry slot at index is reused for a new object only after its
+// generation has moved on, so a handle to a removed object just stops
+// resolving (Scene::find returns nullptr). safe to put in ui payloads
+struct ObjectHandle {
+    unsigned int index = 0;
+    unsigned int generation = 0; // 0 = null handle
+
+    bool valid() const { return generation != 0; }
+    bool operator == (const ObjectHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator != (const ObjectHandle& other) const { return !(*this == other); }
+};
\ No newline at end of file
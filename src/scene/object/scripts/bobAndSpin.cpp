@@ -30,13 +30,13 @@ void BobAndSpin::start() {
 void BobAndSpin::update(std::shared_ptr<Scene> s)
 {
     // do the bob
-    t->position.y = 
-        object->getParent()->getComponent<Transform>()->position.y +
+    t->position().y = 
+        object->getParent()->getComponent<Transform>()->position().y +
         bobOffset +
-        glm::sin(glfwGetTime() * bobSpeed) * bobSize;
+        glm::sin(s->time * bobSpeed) * bobSize;
 
     // do the spin ting
-    t->rotation.y += s->dTime * spinSpeed;
+    t->rotation().y += deltaTime * spinSpeed;
 }
 
 void BobAndSpin::renderInspector()
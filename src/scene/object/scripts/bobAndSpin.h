@@ -28,6 +28,7 @@ public:
         : BobAndSpin(newObj, other.bobSpeed, other.bobOffset, other.bobSize, other.spinSpeed) {}
     void start() override;
     void update(std::shared_ptr<Scene> s) override;
+    unsigned int access() override { return OWN_TRANSFORM | PARENT_TRANSFORM | SCENE_READ; }
     void renderInspector() override;
     YAML::Emitter& serialise(YAML::Emitter& emitter) override
     {
@@ -51,7 +52,7 @@ public:
     }
 
     std::shared_ptr<Script> clone(std::shared_ptr<Object> newObj) {
-        return std::shared_ptr<Script>(new BobAndSpin(*this, newObj));
+        return makePooled<BobAndSpin>(*this, newObj);
     }
 
     float bobSpeed = 1.0f;
@@ -24,6 +24,9 @@ void EditCamera::start() {
         }
     if (t == nullptr)
         std::cout << "WARN::" << object->getName() << "::script::editcamera::cannot find transform" << std::endl;
+
+    // nothing to do unless the mouse is doing something
+    runOnInput();
 }
 
 void EditCamera::update(std::shared_ptr<Scene> s)
@@ -33,9 +36,9 @@ void EditCamera::update(std::shared_ptr<Scene> s)
     glm::vec3 direction = glm::rotate(
         glm::quat(
             glm::vec3(
-                glm::radians(t->rotation.x),
-                glm::radians(t->rotation.y),
-                glm::radians(t->rotation.z)
+                glm::radians(t->rotation().x),
+                glm::radians(t->rotation().y),
+                glm::radians(t->rotation().z)
             )
         ),
         glm::vec3(0, 0, -1)
@@ -46,7 +49,7 @@ void EditCamera::update(std::shared_ptr<Scene> s)
     zoom *= s->scrollY;
 
     // apply to position
-    t->position += zoom;
+    t->position() += zoom;
 
     // rotate or drag camera 
     if (ImGui::GetIO().WantCaptureMouse) return;
@@ -72,8 +75,8 @@ void EditCamera::update(std::shared_ptr<Scene> s)
         // drag
         if (glfwGetKey(s->window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS || glfwGetKey(s->window, GLFW_KEY_RIGHT_SHIFT == GLFW_PRESS))
         {
-            t->position += -dX * dragSpeed * glm::normalize(glm::cross(direction, glm::vec3(0, 1.0f, 0)));
-            t->position += -dY * dragSpeed * glm::normalize(glm::cross(direction, glm::cross(direction, glm::vec3(0, 1.0f, 0))));
+            t->position() += -dX * dragSpeed * glm::normalize(glm::cross(direction, glm::vec3(0, 1.0f, 0)));
+            t->position() += -dY * dragSpeed * glm::normalize(glm::cross(direction, glm::cross(direction, glm::vec3(0, 1.0f, 0))));
 
         }
         else // rotate
@@ -81,9 +84,9 @@ void EditCamera::update(std::shared_ptr<Scene> s)
             direction = glm::rotate(direction, glm::radians(-dY * rotateSpeed), glm::normalize(glm::cross(direction, glm::vec3(0, 1.0f, 0))));
             direction = glm::rotate(direction, glm::radians(-dX * rotateSpeed), glm::vec3(0, 1.0f, 0));
             glm::vec3 o = glm::eulerAngles(glm::rotation(glm::vec3(0, 0, -1), glm::normalize(direction)));
-            t->rotation.x = glm::degrees(o.x);
-            t->rotation.y = glm::degrees(o.y);
-            t->rotation.z = glm::degrees(o.z);
+            t->rotation().x = glm::degrees(o.x);
+            t->rotation().y = glm::degrees(o.y);
+            t->rotation().z = glm::degrees(o.z);
         }
 
         lastX = mouseX;
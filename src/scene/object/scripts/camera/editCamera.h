@@ -27,6 +27,7 @@ public:
         : EditCamera(newObj, other.zoomSpeed, other.rotateSpeed, other.dragSpeed) {}
     void start() override;
     void update(std::shared_ptr<Scene> s) override;
+    unsigned int access() override { return OWN_TRANSFORM | SCENE_READ | MAIN_THREAD; } // mouse input
     void renderInspector() override;
     YAML::Emitter& serialise(YAML::Emitter& emitter) override 
     {
@@ -48,7 +49,7 @@ public:
     }
 
     std::shared_ptr<Script> clone(std::shared_ptr<Object> newObj) {
-        return std::shared_ptr<Script>(new EditCamera(*this, newObj));
+        return makePooled<EditCamera>(*this, newObj);
     }
 
     float zoomSpeed = 0.5f;
@@ -7,13 +7,15 @@
 #include <imgui.h>
 
 #include <memory>
+#include <algorithm>
+#include <cmath>
 
 template <typename T>
-Script* newComponent(std::shared_ptr<Object> obj) { return new T(obj); }
+std::shared_ptr<Script> newComponent(std::shared_ptr<Object> obj) { return makePooled<T>(obj); }
 
 struct ScriptBuilders {
     const char* name;
-    Script* (*builder)(std::shared_ptr<Object>);
+    std::shared_ptr<Script> (*builder)(std::shared_ptr<Object>);
 };
 
 static ScriptBuilders builders[] = {
@@ -33,7 +35,7 @@ void Script::renderComponentChildWindow(std::shared_ptr<Object> obj) {
         {
             if (ImGui::Button(cb.name))
             {
-                obj->scripts.push_back(std::shared_ptr<Script>(cb.builder(obj)));
+                obj->scripts.push_back(cb.builder(obj));
                 ImGui::CloseCurrentPopup();
             }
             ImGui::Separator();
@@ -52,7 +54,7 @@ std::shared_ptr<Script> Script::deserialise(const YAML::Node& scriptNode, std::s
         for (auto cb : builders)
             if (scriptNode["name"].as<std::string>() == std::string(cb.name))
             {
-                auto script = std::shared_ptr<Script>(cb.builder(obj));
+                auto script = cb.builder(obj);
                 script->_deserialise(scriptNode);
                 return script;
             }
@@ -60,6 +62,46 @@ std::shared_ptr<Script> Script::deserialise(const YAML::Node& scriptNode, std::s
     return nullptr;
 }
 
+std::atomic<unsigned int> Script::nextPhase{ 0 };
+
+void Script::runEvery(unsigned int ticks)
+{
+    everyTicks = std::max(1u, ticks);
+    hz = 0.0;
+    phase = nextPhase++;
+}
+
+void Script::runAt(double hz)
+{
+    this->hz = hz;
+    phase = nextPhase++;
+}
+
+void Script::runOnInput(bool onInput)
+{
+    this->onInput = onInput;
+}
+
+bool Script::due(Scene* s)
+{
+    if (asleep)
+        return false;
+    ticksSinceRun++;
+    if (onInput && !s->inputThisTick)
+        return false;
+    unsigned int interval = everyTicks;
+    if (hz > 0.0)
+        interval = std::max(1, (int)std::round(s->tickRate / hz));
+    return (s->tickIndex + phase) % interval == 0;
+}
+
+void Script::run(std::shared_ptr<Scene> s)
+{
+    deltaTime = ticksSinceRun * s->dTime;
+    ticksSinceRun = 0;
+    update(s);
+}
+
 void Script::remove()
 {
     // find self in obj components and remove (shared_ptr should automatically free us)
@@ -3,20 +3,52 @@
 #include <scene/scene.h>
 #include <scene/object/object.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 
+#include <util/pool.h>
+
 #include <yaml-cpp/yaml.h>
 
 class Scene;
 class Object;
+struct ScriptStats;
 
 class Script {
 public:
-    Script(std::string name, std::shared_ptr<Object> obj) : name(name), object(obj) {
+    Script(std::string name, std::shared_ptr<Object> obj) : name(name), object(obj.get()) {
     }
     virtual void start() = 0;
     virtual void update(std::shared_ptr<Scene> s) = 0;
+
+    // what update() touches, so the scene can run scripts side by side.
+    // scripts that don't say anything are assumed to touch everything and
+    // always run alone on the main thread
+    enum Access {
+        OWN_TRANSFORM = 1,      // reads/writes its own object's transform (and its own members)
+        PARENT_TRANSFORM = 2,   // reads the parent object's transform
+        SCENE_READ = 4,         // reads scene globals (dTime, time, ...)
+        SCENE_WRITE = 8,        // writes scene globals or other objects
+        MAIN_THREAD = 16        // input, GL, ui
+    };
+    virtual unsigned int access() { return SCENE_WRITE | MAIN_THREAD; }
+    bool runsAlone() { return (access() & (SCENE_WRITE | MAIN_THREAD)) != 0; }
+
+    // scheduling, by default update() runs every tick. call these from
+    // start() (or update() to change it on the fly)
+    void runEvery(unsigned int ticks);  // every N ticks, spread out so they don't all land on the same tick
+    void runAt(double hz);              // as close to hz as the tick rate allows
+    void runOnInput(bool onInput = true); // only on ticks with mouse/scroll input
+    void sleep() { asleep = true; }     // not at all until woken
+    void wake() { if (asleep) ticksSinceRun = 0; asleep = false; } // deltaTime doesn't cover the sleep
+    bool sleeping() { return asleep; }
+
+    // called by the scene once per tick (main thread). due() says whether
+    // update() should run this tick, run() calls it
+    bool due(Scene* s);
+    void run(std::shared_ptr<Scene> s);
+    ScriptStats* stats = nullptr; // per script type, see Scene::scriptStats
     friend YAML::Emitter& operator << (YAML::Emitter& emitter, Script& c) {
         return c.serialise(emitter);
     }
@@ -30,11 +62,21 @@ public:
     static void renderComponentChildWindow(std::shared_ptr<Object> obj);
 
     // DANGEROUS! for use by Object::clone() ONLY
-    void setObject(std::shared_ptr<Object> newObj) { object = newObj; }
+    void setObject(std::shared_ptr<Object> newObj) { object = newObj.get(); }
     virtual std::shared_ptr<Script> clone(std::shared_ptr<Object> newObj) = 0;
     
     void remove();
+    std::string getName() { return name; }
 protected:
     std::string name;
-    std::shared_ptr<Object> object;
+    Object* object; // owner, not owned
+    double deltaTime = 0.0; // time since this script's last update, use instead of Scene::dTime
+private:
+    unsigned int everyTicks = 1;
+    double hz = 0.0;
+    bool onInput = false;
+    bool asleep = false;
+    unsigned int phase = 0;
+    unsigned int ticksSinceRun = 0;
+    static std::atomic<unsigned int> nextPhase; // runEvery/runAt can be called from update() on workers
 };
\ No newline at end of file
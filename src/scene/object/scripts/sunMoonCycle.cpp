@@ -25,18 +25,28 @@ void SunMoonCycle::start() {
         }
     if (t == nullptr)
         std::cout << "WARN::" << object->getName() << "::script::editcamera::cannot find transform" << std::endl;
+
+    // a day takes minutes, 10 updates a second is plenty
+    runAt(10.0);
 }
 
 void SunMoonCycle::update(std::shared_ptr<Scene> s)
 {
-    double deltaTime = s->dTime;
-    deltaTime /= 60 * 60 * 24;
-    deltaTime *= timeScale;
-    time += deltaTime;
+    // time is stopped, nothing will change until the inspector wakes us
+    if (timeScale == 0.0)
+    {
+        sleep();
+        return;
+    }
+
+    double dayTime = deltaTime;
+    dayTime /= 60 * 60 * 24;
+    dayTime *= timeScale;
+    time += dayTime;
     time = fmod(time, 1.0);
     float angle;
     angle = ((time < 0.5 ? time / 0.5 : (time - 0.5) / 0.5) * 180) - 90;
-    t->rotation.z = angle;
+    t->rotation().z = angle;
 
     auto light = object->children[0]->getComponent<Light>();
     if (time < 0.5)
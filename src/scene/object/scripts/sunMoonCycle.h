@@ -26,6 +26,7 @@ public:
         : SunMoonCycle(newObj, other.time, other.timeScale) {}
     void start() override;
     void update(std::shared_ptr<Scene> s) override;
+    unsigned int access() override { return OWN_TRANSFORM | SCENE_READ | SCENE_WRITE; } // background color, sun light
     void renderInspector() override;
     YAML::Emitter& serialise(YAML::Emitter& emitter) override
     {
@@ -45,7 +46,7 @@ public:
     }
 
     std::shared_ptr<Script> clone(std::shared_ptr<Object> newObj) {
-        return std::shared_ptr<Script>(new SunMoonCycle(*this, newObj));
+        return makePooled<SunMoonCycle>(*this, newObj);
     }
 
     double time = 0.0f;
@@ -0,0 +1,291 @@
+#include "occlusionCuller.h"
+
+#include <scene/object/components/renderer/renderer.h>
+#include <util/jobSystem.h>
+#include <util/profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+void OcclusionCuller::cull(std::vector<DrawItem>& drawList, const glm::mat4& viewProjection)
+{
+    occluderCount = 0;
+    triangleCount = 0;
+    testedCount = 0;
+    occludedCount = 0;
+    rasterMs = 0.0;
+    testMs = 0.0;
+    if (!enabled)
+        return;
+    auto start = std::chrono::steady_clock::now();
+
+    // big static things in view, the most screen covered first. ones we
+    // can't see the whole of (crossing the near plane) go first of all
+    std::vector<std::pair<float, size_t>> candidates;
+    for (size_t i = 0; i < drawList.size(); ++i)
+    {
+        const DrawItem& item = drawList[i];
+        if (!item.visible || !item.isStatic || !item.bounds.valid())
+            continue;
+        glm::vec3 size = item.bounds.max - item.bounds.min;
+        if (std::max(size.x, std::max(size.y, size.z)) < occluderSize)
+            continue;
+        glm::ivec4 rect;
+        float nearest;
+        float area = std::numeric_limits<float>::max();
+        if (screenRect(item.bounds, viewProjection, rect, nearest))
+            area = (float)(rect.z - rect.x + 1) * (rect.w - rect.y + 1);
+        candidates.push_back({ area, i });
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const std::pair<float, size_t>& a, const std::pair<float, size_t>& b) {
+        return a.first > b.first;
+    });
+
+    // the pyramid, sized on the first frame and when the resolution changes
+    if (sizes.empty() || sizes[0] != glm::ivec2(width, height))
+    {
+        levels.clear();
+        sizes.clear();
+        glm::ivec2 size(std::max(width, 1), std::max(height, 1));
+        while (true)
+        {
+            sizes.push_back(size);
+            levels.push_back(std::vector<float>(size.x * size.y));
+            if (size.x == 1 && size.y == 1)
+                break;
+            size = glm::ivec2((size.x + 1) / 2, (size.y + 1) / 2);
+        }
+    }
+    std::fill(levels[0].begin(), levels[0].end(), 1.0f);
+
+    std::vector<char> occluder(drawList.size(), 0);
+    for (auto& candidate : candidates)
+    {
+        if (occluderCount >= maxOccluders)
+            break;
+        const DrawItem& item = drawList[candidate.second];
+        const Geometry* geometry = geometryOf(item);
+        if (!geometry)
+            continue;
+        size_t triangles = geometry->indices.size() / 3;
+        if (triangleCount + triangles > triangleBudget)
+            continue;
+        rasterize(*geometry, viewProjection * item.model);
+        triangleCount += triangles;
+        occluderCount++;
+        occluder[candidate.second] = 1;
+    }
+    auto rastered = std::chrono::steady_clock::now();
+    rasterMs = std::chrono::duration<double, std::milli>(rastered - start).count();
+    if (!occluderCount)
+        return;
+    buildPyramid();
+
+    // occluders aren't tested, they can't hide themselves and float noise
+    // on a face that sits on their own bounds would say they do
+    JobSystem::get().parallelFor(drawList.size(), 256, [this, &drawList, &occluder, &viewProjection](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            DrawItem& item = drawList[i];
+            if (!item.visible || occluder[i] || !item.bounds.valid())
+                continue;
+            if (hidden(item.bounds, viewProjection))
+            {
+                item.occluded = true;
+                item.visible = false;
+            }
+        }
+    });
+    for (size_t i = 0; i < drawList.size(); ++i)
+    {
+        testedCount += (drawList[i].visible || drawList[i].occluded) && !occluder[i] && drawList[i].bounds.valid();
+        occludedCount += drawList[i].occluded;
+    }
+    testMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - rastered).count();
+    Profiler::get().count("occluders", occluderCount);
+    Profiler::get().count("occluded draws", occludedCount);
+}
+
+const OcclusionCuller::Geometry* OcclusionCuller::geometryOf(const DrawItem& item)
+{
+    BatchMaterial material;
+    const void* key = nullptr;
+    if (!item.renderer->batchSource(material, key) || !key)
+        return nullptr;
+    auto found = geometries.find(key);
+    if (found != geometries.end())
+        return &found->second;
+
+    // first time we see it, read it back (stalls) and keep the positions
+    std::vector<GLfloat> vertices;
+    Geometry& geometry = geometries[key];
+    item.renderer->readGeometry(vertices, geometry.indices);
+    geometry.positions.resize(vertices.size() / 8);
+    for (size_t v = 0; v < geometry.positions.size(); ++v)
+        geometry.positions[v] = glm::vec3(vertices[v * 8], vertices[v * 8 + 1], vertices[v * 8 + 2]);
+    return &geometry;
+}
+
+void OcclusionCuller::rasterize(const Geometry& geometry, const glm::mat4& mvp)
+{
+    clip.resize(geometry.positions.size());
+    for (size_t v = 0; v < clip.size(); ++v)
+        clip[v] = mvp * glm::vec4(geometry.positions[v], 1.0f);
+
+    for (size_t t = 0; t + 2 < geometry.indices.size(); t += 3)
+    {
+        const glm::vec4& a = clip[geometry.indices[t]];
+        const glm::vec4& b = clip[geometry.indices[t + 1]];
+        const glm::vec4& c = clip[geometry.indices[t + 2]];
+        // all three outside the same side plane or past the far plane
+        if ((a.x > a.w && b.x > b.w && c.x > c.w) || (a.x < -a.w && b.x < -b.w && c.x < -c.w)
+            || (a.y > a.w && b.y > b.w && c.y > c.w) || (a.y < -a.w && b.y < -b.w && c.y < -c.w)
+            || (a.z > a.w && b.z > b.w && c.z > c.w))
+            continue;
+
+        // clip against the near plane (z > -w), leaves a triangle or a quad
+        float da = a.z + a.w, db = b.z + b.w, dc = c.z + c.w;
+        if (da >= 0.0f && db >= 0.0f && dc >= 0.0f)
+        {
+            triangle(a, b, c);
+            continue;
+        }
+        glm::vec4 in[3] = { a, b, c };
+        float d[3] = { da, db, dc };
+        glm::vec4 out[4];
+        int count = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            int j = (i + 1) % 3;
+            if (d[i] >= 0.0f)
+                out[count++] = in[i];
+            if ((d[i] >= 0.0f) != (d[j] >= 0.0f))
+                out[count++] = glm::mix(in[i], in[j], d[i] / (d[i] - d[j]));
+        }
+        for (int i = 2; i < count; ++i)
+            triangle(out[0], out[i - 1], out[i]);
+    }
+}
+
+void OcclusionCuller::triangle(glm::vec4 a, glm::vec4 b, glm::vec4 c)
+{
+    // to pixels, depth 0 to 1
+    glm::vec3 v[3];
+    const glm::vec4* in[3] = { &a, &b, &c };
+    for (int i = 0; i < 3; ++i)
+    {
+        float w = std::max(in[i]->w, 1e-6f);
+        v[i] = glm::vec3((in[i]->x / w * 0.5f + 0.5f) * width, (in[i]->y / w * 0.5f + 0.5f) * height, in[i]->z / w * 0.5f + 0.5f);
+    }
+    float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+    if (std::abs(area) < 1e-8f)
+        return;
+    // both windings occlude
+    if (area < 0.0f)
+    {
+        std::swap(v[1], v[2]);
+        area = -area;
+    }
+
+    // clamped as floats, vertices near the eye plane land way off screen
+    int x0 = (int)std::max(0.0f, std::floor(std::min(v[0].x, std::min(v[1].x, v[2].x))));
+    int x1 = (int)std::min(width - 1.0f, std::ceil(std::max(v[0].x, std::max(v[1].x, v[2].x))));
+    int y0 = (int)std::max(0.0f, std::floor(std::min(v[0].y, std::min(v[1].y, v[2].y))));
+    int y1 = (int)std::min(height - 1.0f, std::ceil(std::max(v[0].y, std::max(v[1].y, v[2].y))));
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    // edge functions as a * x + b * y + c, one per vertex (the edge
+    // opposite it), positive inside. scaled by 1 / area they're the
+    // barycentrics, so depth is one more plane equation
+    float ea[3], eb[3], ec[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const glm::vec3& p = v[(i + 1) % 3];
+        const glm::vec3& q = v[(i + 2) % 3];
+        ea[i] = p.y - q.y;
+        eb[i] = q.x - p.x;
+        ec[i] = (q.y - p.y) * p.x - (q.x - p.x) * p.y;
+    }
+    float inv = 1.0f / area;
+    float za = (ea[0] * v[0].z + ea[1] * v[1].z + ea[2] * v[2].z) * inv;
+    float zb = (eb[0] * v[0].z + eb[1] * v[1].z + eb[2] * v[2].z) * inv;
+    float zc = (ec[0] * v[0].z + ec[1] * v[1].z + ec[2] * v[2].z) * inv;
+
+    // no early outs in the row loop so it vectorizes
+    std::vector<float>& depth = levels[0];
+    for (int y = y0; y <= y1; ++y)
+    {
+        float py = y + 0.5f;
+        float r0 = eb[0] * py + ec[0], r1 = eb[1] * py + ec[1], r2 = eb[2] * py + ec[2];
+        float rz = zb * py + zc;
+        float* row = &depth[y * width];
+        for (int x = x0; x <= x1; ++x)
+        {
+            float px = x + 0.5f;
+            float w0 = ea[0] * px + r0, w1 = ea[1] * px + r1, w2 = ea[2] * px + r2;
+            float z = za * px + rz;
+            bool inside = w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f;
+            row[x] = inside && z < row[x] ? z : row[x];
+        }
+    }
+}
+
+void OcclusionCuller::buildPyramid()
+{
+    for (size_t l = 1; l < levels.size(); ++l)
+    {
+        const std::vector<float>& src = levels[l - 1];
+        std::vector<float>& dst = levels[l];
+        glm::ivec2 s = sizes[l - 1], d = sizes[l];
+        for (int y = 0; y < d.y; ++y)
+            for (int x = 0; x < d.x; ++x)
+            {
+                // odd sizes, the last row / column only has itself
+                int sx = std::min(x * 2 + 1, s.x - 1), sy = std::min(y * 2 + 1, s.y - 1);
+                dst[y * d.x + x] = std::max(std::max(src[y * 2 * s.x + x * 2], src[y * 2 * s.x + sx]),
+                    std::max(src[sy * s.x + x * 2], src[sy * s.x + sx]));
+            }
+    }
+}
+
+bool OcclusionCuller::screenRect(const AABB& bounds, const glm::mat4& viewProjection, glm::ivec4& rect, float& nearest) const
+{
+    glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner((i & 1) ? bounds.max.x : bounds.min.x, (i & 2) ? bounds.max.y : bounds.min.y, (i & 4) ? bounds.max.z : bounds.min.z);
+        glm::vec4 p = viewProjection * glm::vec4(corner, 1.0f);
+        if (p.w <= 1e-6f || p.z < -p.w)
+            return false;
+        glm::vec3 ndc = glm::vec3(p) / p.w;
+        lo = glm::min(lo, ndc);
+        hi = glm::max(hi, ndc);
+    }
+    glm::vec4 pixels = glm::floor((glm::vec4(lo.x, lo.y, hi.x, hi.y) * 0.5f + 0.5f) * glm::vec4(width, height, width, height));
+    rect = glm::ivec4(glm::clamp(pixels, glm::vec4(0.0f), glm::vec4(width - 1, height - 1, width - 1, height - 1)));
+    nearest = lo.z * 0.5f + 0.5f;
+    return true;
+}
+
+bool OcclusionCuller::hidden(const AABB& bounds, const glm::mat4& viewProjection) const
+{
+    glm::ivec4 rect;
+    float nearest;
+    if (!screenRect(bounds, viewProjection, rect, nearest))
+        return false;
+
+    // the level where the rect is 2x2 texels at most
+    size_t l = 0;
+    while (l + 1 < levels.size() && ((rect.z >> l) - (rect.x >> l) > 1 || (rect.w >> l) - (rect.y >> l) > 1))
+        l++;
+    const std::vector<float>& level = levels[l];
+    int w = sizes[l].x;
+    for (int y = rect.y >> l; y <= rect.w >> l; ++y)
+        for (int x = rect.x >> l; x <= rect.z >> l; ++x)
+            if (level[y * w + x] >= nearest)
+                return false;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <scene/drawItem.h>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <map>
+#include <vector>
+
+// software occlusion culling
+// the biggest static things in view (terrain, mountains, anything over
+// occluderSize) are rasterized on the cpu into a small depth buffer from
+// the camera, then every draw that survived the frustum has its bounds
+// tested against a max depth pyramid built from it: if the nearest point
+// of the box is behind the farthest occluder depth over the whole screen
+// rect it covers, it isn't drawn. only the camera passes are culled, the
+// shadow cascades still see everything. the occluders' triangles are read
+// back from the gpu once and kept until the static batches change
+class OcclusionCuller {
+public:
+    bool enabled = true;
+    int width = 256;  // depth buffer size, aspect doesn't matter much
+    int height = 128;
+    float occluderSize = 20.0f;      // world units, largest side of a static draw's bounds
+    unsigned int maxOccluders = 32;  // the ones covering the most screen first
+    size_t triangleBudget = 100000;  // per frame, occluders past it are skipped
+
+    // sets occluded (and clears visible) on the visible items that are hidden
+    void cull(std::vector<DrawItem>& drawList, const glm::mat4& viewProjection);
+    // drop the cached triangles, the static batches were rebuilt
+    void forget() { geometries.clear(); }
+
+    // the depth buffer, 0 near 1 far (debug views, benchmarks)
+    const std::vector<float>& depth() const { return levels.empty() ? empty : levels[0]; }
+
+    // stats, last frame
+    unsigned int occluderCount = 0;
+    size_t triangleCount = 0;
+    unsigned int testedCount = 0;
+    unsigned int occludedCount = 0;
+    double rasterMs = 0.0;
+    double testMs = 0.0;
+
+private:
+    struct Geometry {
+        std::vector<glm::vec3> positions;
+        std::vector<GLuint> indices;
+    };
+    std::map<const void*, Geometry> geometries; // by batchSource's geometry key
+    const Geometry* geometryOf(const DrawItem& item);
+
+    void rasterize(const Geometry& geometry, const glm::mat4& mvp);
+    void triangle(glm::vec4 a, glm::vec4 b, glm::vec4 c);
+    void buildPyramid();
+    // bounds to a pixel rect and nearest depth, false if it crosses the near plane
+    bool screenRect(const AABB& bounds, const glm::mat4& viewProjection, glm::ivec4& rect, float& nearest) const;
+    bool hidden(const AABB& bounds, const glm::mat4& viewProjection) const;
+
+    // level 0 is the depth buffer, each level after it holds the max of 2x2
+    std::vector<std::vector<float>> levels;
+    std::vector<glm::ivec2> sizes;
+    std::vector<glm::vec4> clip; // scratch, one occluder's vertices
+    std::vector<float> empty;
+};
\ No newline at end of file
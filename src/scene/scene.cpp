@@ -12,6 +12,15 @@
 #include <scene/object/components/transform.h>
 #include <scene/object/components/light.h>
 #include <scene/object/components/renderer/meshRenderer.h>
+#include <scene/object/components/renderer/renderer.h>
+#include <scene/object/scripts/script.h>
+
+#include <util/profiler.h>
+#include <util/jobSystem.h>
+#include <util/pool.h>
+#include <util/frustum.h>
+#include <util/geometryArena.h>
+#include <util/gl43.h>
 
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -21,6 +30,11 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <chrono>
+#include <random>
 
 //---BEGIN RANT---
 // yes the uni computers have ancient versions of things 
@@ -111,14 +125,14 @@ bool processModelNode(aiNode* node, const aiScene* importedScene, std::string mo
     for (unsigned int meshIdx = 0; meshIdx < node->mNumMeshes; ++meshIdx)
     {
         // create new child for each mesh
-        std::shared_ptr<Object> meshchild(new Object(blueprint->getScene()));
+        std::shared_ptr<Object> meshchild = makePooled<Object>(blueprint->getScene());
         meshchild->setName(blueprint->getName() + std::string("-m" + std::to_string(meshIdx)));
 
         // add mesh to child and scene
         std::shared_ptr<Mesh> mesh = processModelMesh(importedScene->mMeshes[node->mMeshes[meshIdx]], importedScene, meshchild->getName());
         if (mesh == nullptr) return false;
-        meshchild->components.push_back(std::shared_ptr<Component>(new Transform(meshchild)));
-        meshchild->components.push_back(std::shared_ptr<Component>(new MeshRenderer(meshchild, mesh)));
+        meshchild->components.push_back(makePooled<Transform>(meshchild));
+        meshchild->components.push_back(makePooled<MeshRenderer>(meshchild, mesh));
         meshchild->getComponent<MeshRenderer>()->mesh = mesh;
         blueprint->getScene()->meshes.push_back(mesh);
 
@@ -130,9 +144,9 @@ bool processModelNode(aiNode* node, const aiScene* importedScene, std::string mo
     for (unsigned int nodeIdx = 0; nodeIdx < node->mNumChildren; ++nodeIdx)
     {
         // create child
-        std::shared_ptr<Object> child(new Object(blueprint->getScene()));
+        std::shared_ptr<Object> child = makePooled<Object>(blueprint->getScene());
         child->reparent(blueprint, true);
-        child->components.push_back(std::shared_ptr<Component>(new Transform(child)));
+        child->components.push_back(makePooled<Transform>(child));
         child->setName(blueprint->getName() + std::string("-c" + std::to_string(nodeIdx)));
 
         // make child new blueprint parent in next processing
@@ -142,98 +156,133 @@ bool processModelNode(aiNode* node, const aiScene* importedScene, std::string mo
 
     return true;
 }
-void processFiles(std::shared_ptr<Scene> s)
+// texture from a decoded image, sampling options come from the file name
+// (<name>_<nearest|linear>_<repeat|mirrored|edge|border>). the pixels are
+// streamed in, the image goes to the scene's streamer
+static std::shared_ptr<Texture> importTexture(std::shared_ptr<Scene> s, AssetFile& p)
 {
-    for (auto file : filesToProcess)
+    std::stringstream tss(p.name);
+    std::string tk;
+    std::vector<std::string> tks;
+    while (std::getline(tss, tk, '_'))
+        tks.push_back(tk);
+    GLenum scale = GL_LINEAR, repeat = GL_REPEAT;
+    if (tks.size() >= 2)
+        if (tks[1] == "nearest")
+            scale = GL_NEAREST;
+        else if (tks[1] == "linear")
+            scale = GL_LINEAR;
+    if (tks.size() >= 3)
+        if (tks[2] == "repeat")
+            repeat = GL_REPEAT;
+        else if (tks[2] == "mirrored")
+            repeat = GL_MIRRORED_REPEAT;
+        else if (tks[2] == "edge")
+            repeat = GL_CLAMP_TO_EDGE;
+        else if (tks[2] == "border")
+            repeat = GL_CLAMP_TO_BORDER;
+
+    std::shared_ptr<Texture> texture(new Texture(GL_TEXTURE_2D, scale, repeat, glm::vec4(1.0f), p.name));
+    s->textureStreamer->upload(texture, p.image);
+    p.image.data = nullptr;
+    return texture;
+}
+
+// blueprint (prefab) from a parsed model, not added to the scene's
+// blueprints yet. nullptr if it couldn't be imported
+static std::shared_ptr<Object> importModel(std::shared_ptr<Scene> s, AssetFile& p)
+{
+    const aiScene* importedScene = p.importedScene;
+    if (!importedScene || importedScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !importedScene->mRootNode)
     {
-        std::stringstream ss(file);
-        std::string name, ext;
+        std::cout << "WARN::ASSETIMPORT::ASSIMP::could not import " << p.file << std::endl;
+        return nullptr;
+    }
 
-        // process all dir seps
-        while (std::getline(ss, name, '/'));
-        while (std::getline(ss, name, '\\'));
-        ss = std::stringstream(name);
+    // create new blueprint (prefab)
+    std::string modelDir = p.file.substr(0, p.file.find_last_of('/'));
+    std::shared_ptr<Object> newBlueprint = makePooled<Object>(s);
+    newBlueprint->setName(std::string("importedmodel_" + p.name));
+    newBlueprint->components.push_back(makePooled<Transform>(newBlueprint));
 
-        // get name and extension
-        name = "";
-        while (std::getline(ss, ext, '.')) {
-            name += ext;
-            std::getline(ss, ext, '.');
-        }
-        if (ext == "jpg" || ext == "jpeg" || ext == "png" || ext == "bmp" || ext == "tga" || ext == "psd")
-        { // process texture
-            std::stringstream tss(name);
-            std::string tk;
-            std::vector<std::string> tks;
-            while (std::getline(tss, tk, '_'))
-                tks.push_back(tk);
-            GLenum scale = GL_LINEAR, repeat = GL_REPEAT;
-            if (tks.size() >= 2)
-                if (tks[1] == "nearest")
-                    scale = GL_NEAREST;
-                else if (tks[1] == "linear")
-                    scale = GL_LINEAR;
-            if (tks.size() >= 3)
-                if (tks[2] == "repeat")
-                    repeat = GL_REPEAT;
-                else if (tks[2] == "mirrored")
-                    repeat = GL_MIRRORED_REPEAT;
-                else if (tks[2] == "edge")
-                    repeat = GL_CLAMP_TO_EDGE;
-                else if (tks[2] == "border")
-                    repeat = GL_CLAMP_TO_BORDER;
-
-            s->textures.push_back(std::shared_ptr<Texture>(new Texture(Texture::loadFromFile(file.c_str()), GL_TEXTURE_2D, scale, repeat, glm::vec4(1.0f), name)));
-        }
-        else if (ext == "blend" || ext == "obj" || ext == "fbx")
-        { // process model
-            Assimp::Importer importer;
-            const aiScene* importedScene = importer.ReadFile(file, aiProcess_Triangulate | aiProcess_FlipUVs);
-            if (!importedScene || importedScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !importedScene->mRootNode)
-            {
-                std::cout << "WARN::ASSETIMPORT::ASSIMP::could not import " << file << std::endl;
-                continue;
-            }
+    // populate blueprint with model meshes recursively, if model loading
+    // fails let the blueprint smart pointer die so everything it owns will
+    // be released
+    bool loaded = processModelNode(importedScene->mRootNode, importedScene, modelDir, newBlueprint);
+    p.importer = nullptr;
+    p.importedScene = nullptr;
+    return loaded ? newBlueprint : nullptr;
+}
+
+// the meshes an imported model's blueprint draws with (its MeshRenderers),
+// by name. going by the name prefix instead would mix up models whose
+// names extend each other (tree, tree-big)
+static void modelMeshes(std::shared_ptr<Object> o, std::map<std::string, std::shared_ptr<Mesh>>& found)
+{
+    std::shared_ptr<MeshRenderer> r = o->getComponent<MeshRenderer>();
+    if (r && r->mesh)
+        found[r->mesh->name] = r->mesh;
+    for (auto child : o->children)
+        modelMeshes(child, found);
+}
 
-            // create new blueprint (prefab)
-            std::string modelDir = file.substr(0, file.find_last_of('/'));
-            std::shared_ptr<Object> newBlueprint(new Object(s));
-            newBlueprint->setName(std::string("importedmodel_" + name));
-            newBlueprint->components.push_back(std::shared_ptr<Component>(new Transform(newBlueprint)));
-
-            // populate blueprint with model meshes recursively and add to blueprints
-            if (processModelNode(importedScene->mRootNode, importedScene, modelDir, newBlueprint))
-                s->blueprints.push_back(newBlueprint);
-            // if model loading fails, let the blueprint smart pointer die so everything
-            // it owns will be released
+// g-buffer (gbuffer_<name>) and multi-draw indirect variants for a shader
+// that was just loaded. indirect variants go in the list too so they get
+// the scene uniforms
+static void linkShaderVariants(std::shared_ptr<Scene> s, std::shared_ptr<Shader> shader)
+{
+    for (auto other : s->shaders)
+    {
+        if (shader->name.find("gbuffer_") == 0 && other->name == shader->name.substr(8))
+            other->gbufferVariant = shader;
+        if (other->name == "gbuffer_" + shader->name)
+            shader->gbufferVariant = other;
+    }
+    if (GL43::available && shader->hasIndirect && !shader->indirectVariant)
+    {
+        shader->indirectVariant = std::shared_ptr<Shader>(new Shader("indirect_" + shader->name,
+            shader->vertPath.c_str(), shader->fragPath.c_str(), "#version 430 core\n#define INDIRECT\n"));
+        s->shaders.push_back(shader->indirectVariant);
+    }
+}
+
+void processFiles(std::shared_ptr<Scene> s)
+{
+    // decoding images and parsing models doesn't touch GL, so that part runs
+    // on the job system. the GL objects are made afterwards on this thread,
+    // in file order so the asset lists come out the same every time
+    std::vector<AssetFile> pending;
+    for (auto& file : filesToProcess)
+        pending.push_back(AssetFile(file));
+
+    JobSystem::get().parallelFor(pending.size(), 1, [&pending](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            pending[i].decode();
+    });
+
+    for (auto& p : pending)
+    {
+        const std::string& file = p.file;
+        const std::string& name = p.name;
+        const std::string& ext = p.ext;
+        if (AssetFile::isImage(ext))
+            s->textures.push_back(importTexture(s, p));
+        else if (AssetFile::isModel(ext))
+        { // process model
+            std::shared_ptr<Object> newBlueprint = importModel(s, p);
+            if (newBlueprint)
+                newBlueprint->reparent(nullptr, true);
         }
         else if (ext == "vert")
         { // process shader
             // find fragment shader
             std::string fragPath = "";
-            for (auto fragFile : filesToProcess)
-            {
-                std::stringstream ss(fragFile);
-                std::string fragname, fragext;
-
-                // process all dir seps
-                while (std::getline(ss, fragname, '/'));
-                while (std::getline(ss, fragname, '\\'));
-                ss = std::stringstream(fragname);
-
-                // get name and extension
-                fragname = "";
-                while (std::getline(ss, fragext, '.')) {
-                    fragname += fragext;
-                    std::getline(ss, fragext, '.');
-                }
-
-                if (fragname == name && fragext == "frag")
+            for (auto& frag : pending)
+                if (frag.name == name && frag.ext == "frag")
                 {
-                    fragPath = fragFile;
+                    fragPath = frag.file;
                     break;
                 }
-            }
             if (fragPath == "")
             {
                 std::cout << "ERROR::ASSETIMPORT::SHADER::could not find fragment shader for " << file << std::endl;
@@ -243,7 +292,22 @@ void processFiles(std::shared_ptr<Scene> s)
             std::shared_ptr<Shader> shader(new Shader(name, file.c_str(), fragPath.c_str()));
             s->shaders.push_back(shader);
         }
+        else if (ext == "comp" && GL43::available)
+            s->computeShaders.push_back(std::shared_ptr<Shader>(new Shader(name, file.c_str())));
     }
+
+    // link g-buffer and indirect variants to the shaders they stand in for
+    for (size_t i = 0, count = s->shaders.size(); i < count; ++i)
+        linkShaderVariants(s, s->shaders[i]);
+
+    // file walk order isn't sorted, keep the default shader first since
+    // new renderers use shaders[0]
+    for (unsigned int i = 0; i < s->shaders.size(); ++i)
+        if (s->shaders[i]->name == "default")
+        {
+            std::rotate(s->shaders.begin(), s->shaders.begin() + i, s->shaders.begin() + i + 1);
+            break;
+        }
 }
 void Scene::loadAssets(const char* path)
 {
@@ -262,199 +326,1278 @@ void Scene::loadAssets(const char* path)
     processFiles(this->shared_from_this());
 }
 
-void findLightsRecursive(Scene* s, std::shared_ptr<Object> o)
+bool Scene::reloadAsset(AssetFile& asset)
 {
-    auto light = o->getComponent<Light>();
-    if (light && light->type == Light::Type::POINT && s->lights.size() < Scene::MAX_LIGHTS)
-        s->lights.push_back(light);
+    std::shared_ptr<Scene> s = shared_from_this();
+    if (AssetFile::isImage(asset.ext))
+    {
+        if (!asset.image.data)
+        {
+            std::cout << "WARN::HOT_RELOAD::could not decode " << asset.file << std::endl;
+            return false;
+        }
+        // an existing texture keeps drawing its old pixels until the new
+        // ones are streamed in
+        for (auto texture : textures)
+            if (texture->name == asset.name)
+            {
+                textureStreamer->upload(texture, asset.image);
+                asset.image.data = nullptr;
+                return true;
+            }
+        textures.push_back(importTexture(s, asset));
+        return true;
+    }
+
+    if (AssetFile::isModel(asset.ext))
+    {
+        std::shared_ptr<Object> blueprint;
+        for (auto b : blueprints)
+            if (b->getName() == "importedmodel_" + asset.name)
+                blueprint = b;
 
-    if (light && light->type == Light::Type::DIRECTIONAL)
+        // meshes the import adds go on the end of the list
+        size_t mark = meshes.size();
+        std::shared_ptr<Object> fresh = importModel(s, asset);
+        if (!blueprint)
+        {
+            if (!fresh)
+                meshes.erase(meshes.begin() + mark, meshes.end());
+            else
+                fresh->reparent(nullptr, true);
+            return fresh != nullptr;
+        }
+        std::vector<std::shared_ptr<Mesh>> imported(meshes.begin() + mark, meshes.end());
+        meshes.erase(meshes.begin() + mark, meshes.end());
+        if (!fresh)
+            return false;
+
+        // the new meshes go into the old ones, so the blueprint, its
+        // instances and anything else drawing them switch over. they're
+        // matched by name (node path), a model whose nodes changed can't
+        // be matched up and needs a restart
+        std::map<std::string, std::shared_ptr<Mesh>> current;
+        modelMeshes(blueprint, current);
+        bool matches = current.size() == imported.size();
+        for (auto mesh : imported)
+            matches = matches && current.count(mesh->name);
+        if (!matches)
+        {
+            std::cout << "WARN::HOT_RELOAD::" << asset.file << "::nodes changed, restart to pick it up" << std::endl;
+            return false;
+        }
+        for (auto mesh : imported)
+            current[mesh->name]->replace(*mesh);
+        staticBatches->dirty = true;
+        return true;
+    }
+
+    if (AssetFile::isShader(asset.ext))
+    {
+        // every program built from the file, g-buffer and indirect variants
+        // included (they're in the list too)
+        bool found = false, ok = true;
+        for (auto shader : shaders)
+            if (shader->vertPath == asset.file || shader->fragPath == asset.file)
+            {
+                found = true;
+                ok = shader->reload() && ok;
+            }
+        for (auto shader : computeShaders)
+            if (shader->computePath == asset.file)
+            {
+                found = true;
+                ok = shader->reload() && ok;
+            }
+        if (found)
+        {
+            // batchability can change with the vertex shader
+            staticBatches->dirty = true;
+            return ok;
+        }
+
+        // a new one
+        std::shared_ptr<Shader> shader;
+        std::string base = asset.file.substr(0, asset.file.size() - asset.ext.size());
+        if (asset.ext == "comp")
+        {
+            if (!GL43::available)
+                return true;
+            shader = std::shared_ptr<Shader>(new Shader(asset.name, asset.file.c_str()));
+            if (shader->valid)
+                computeShaders.push_back(shader);
+            return shader->valid;
+        }
+        // needs both halves, the other one may not be there yet
+        if (!std::ifstream(base + "vert") || !std::ifstream(base + "frag"))
+            return true;
+        shader = std::shared_ptr<Shader>(new Shader(asset.name, (base + "vert").c_str(), (base + "frag").c_str()));
+        if (!shader->valid)
+            return false;
+        shaders.push_back(shader);
+        linkShaderVariants(s, shader);
+        return true;
+    }
+    return true;
+}
+
+bool Scene::removeAsset(AssetFile& asset)
+{
+    // anything still used (by a renderer, a placed instance...) is kept,
+    // only unused assets leave the lists. last frame's indirect groups
+    // don't count, they're rebuilt before anything draws
+    indirectDraws->release();
+    if (AssetFile::isImage(asset.ext))
+    {
+        for (size_t i = 0; i < textures.size(); ++i)
+            if (textures[i]->name == asset.name)
+            {
+                if (textures[i].use_count() != 1)
+                    return false;
+                textures.erase(textures.begin() + i);
+                return true;
+            }
+    }
+    else if (AssetFile::isModel(asset.ext))
+    {
+        for (size_t i = 0; i < blueprints.size(); ++i)
+            if (blueprints[i]->getName() == "importedmodel_" + asset.name)
+            {
+                if (blueprints[i].use_count() != 1)
+                    return false;
+                std::map<std::string, std::shared_ptr<Mesh>> owned;
+                modelMeshes(blueprints[i], owned);
+                blueprints[i]->remove();
+                meshes.erase(std::remove_if(meshes.begin(), meshes.end(), [&owned](const std::shared_ptr<Mesh>& mesh) {
+                    auto it = owned.find(mesh->name);
+                    return it != owned.end() && it->second == mesh;
+                    }), meshes.end());
+                return true;
+            }
+    }
+    else if (AssetFile::isShader(asset.ext))
+    {
+        // an indirect variant is only unused once its shader has gone
+        for (bool erased = true; erased;)
+        {
+            erased = false;
+            for (size_t i = 0; i < shaders.size() && !erased; ++i)
+                if ((shaders[i]->vertPath == asset.file || shaders[i]->fragPath == asset.file) && shaders[i].use_count() == 1)
+                {
+                    shaders.erase(shaders.begin() + i);
+                    erased = true;
+                }
+        }
+        for (size_t i = 0; i < computeShaders.size(); ++i)
+            if (computeShaders[i]->computePath == asset.file && computeShaders[i].use_count() == 1)
+                computeShaders.erase(computeShaders.begin() + i--);
+        for (auto shader : shaders)
+            if (shader->vertPath == asset.file || shader->fragPath == asset.file)
+                return false;
+    }
+    return true;
+}
+
+Scene::~Scene()
+{
+    // objects go first, their lights unregister on the way out and the
+    // registry has to still be there for that
+    inspectedObject = nullptr;
+    activeCamera = nullptr;
+    staticBatches->clear();
+    objects.clear();
+    blueprints.clear();
+    windowUIs.clear();
+
+    // the scene's objects came out of the pool, hand the slabs back
+    Pool::trim();
+}
+
+void Scene::addObject(std::shared_ptr<Object> o)
+{
+    o->reparent(nullptr);
+}
+
+ObjectHandle Scene::registerObject(Object* o)
+{
+    std::lock_guard<std::mutex> guard(registryLock);
+    ObjectHandle handle;
+    if (!freeObjectSlots.empty())
+    {
+        handle.index = freeObjectSlots.back();
+        freeObjectSlots.pop_back();
+    }
+    else
+    {
+        handle.index = objectSlots.size();
+        objectSlots.push_back(ObjectSlot());
+    }
+    objectSlots[handle.index].object = o;
+    handle.generation = objectSlots[handle.index].generation;
+    return handle;
+}
+
+void Scene::unregisterObject(ObjectHandle handle)
+{
+    std::lock_guard<std::mutex> guard(registryLock);
+    if (handle.index >= objectSlots.size() || objectSlots[handle.index].generation != handle.generation)
+        return;
+    ObjectSlot& slot = objectSlots[handle.index];
+    slot.object = nullptr;
+    // old handles to this slot stop resolving, skip 0 (null handle) on wrap
+    if (++slot.generation == 0)
+        slot.generation = 1;
+    freeObjectSlots.push_back(handle.index);
+}
+
+std::shared_ptr<Object> Scene::find(ObjectHandle handle)
+{
+    std::lock_guard<std::mutex> guard(registryLock);
+    if (!handle.valid() || handle.index >= objectSlots.size())
+        return nullptr;
+    ObjectSlot& slot = objectSlots[handle.index];
+    if (slot.generation != handle.generation || !slot.object)
+        return nullptr;
+    return slot.object->shared_from_this();
+}
+
+void Scene::removeObjects(const std::vector<ObjectHandle>& handles)
+{
+    for (auto handle : handles)
+    {
+        std::shared_ptr<Object> o = find(handle);
+        if (o)
+            o->remove();
+    }
+}
+
+void Scene::reparentObjects(const std::vector<ObjectHandle>& handles, ObjectHandle parent)
+{
+    std::shared_ptr<Object> p = find(parent);
+    if (parent.valid() && !p)
+        return; // the new parent is gone
+    for (auto handle : handles)
+    {
+        std::shared_ptr<Object> o = find(handle);
+        if (o)
+            o->reparent(p);
+    }
+}
+
+// world space bounds of an object's own renderers
+static AABB worldBounds(std::shared_ptr<Object> o)
+{
+    AABB bounds;
+    std::shared_ptr<Transform> t = o->getComponent<Transform>();
+    if (!t)
+        return bounds;
+    glm::mat4 model = t->modelMatrix();
+    for (auto component : o->components)
+    {
+        Renderer* r = dynamic_cast<Renderer*>(component.get());
+        if (r && r->localBounds().valid())
+            bounds.expand(r->localBounds().transformed(model));
+    }
+    return bounds;
+}
+
+std::shared_ptr<Object> Scene::scatter(std::shared_ptr<Object> blueprint, const Scatter& settings)
+{
+    glm::vec3 center = settings.center;
+    glm::vec2 size = settings.size;
+    std::shared_ptr<Object> surface = find(settings.surface);
+    if (surface)
+    {
+        AABB bounds = worldBounds(surface);
+        if (bounds.valid())
+        {
+            center = glm::vec3(bounds.center().x, bounds.max.y, bounds.center().z);
+            size = glm::vec2(bounds.max.x - bounds.min.x, bounds.max.z - bounds.min.z);
+        }
+        else
+            std::cout << "WARN::SCENE::SCATTER::" << surface->getName() << " has no bounds, using the region" << std::endl;
+    }
+
+    std::shared_ptr<Object> group = makePooled<Object>(shared_from_this());
+    group->setName(blueprint->getName() + " (Scatter)");
+    group->components.push_back(makePooled<Transform>(group));
+
+    // room for everything up front, then every instance goes straight in
+    // (linking is O(1), nothing is searched)
+    group->children.reserve(settings.count);
+    world.reserve(world.capacity() + settings.count * 2);
+    {
+        std::lock_guard<std::mutex> guard(registryLock);
+        objectSlots.reserve(objectSlots.size() + settings.count * 2);
+    }
+
+    std::mt19937 random(settings.seed);
+    std::uniform_real_distribution<float> x(-0.5f, 0.5f);
+    std::uniform_real_distribution<float> yaw(settings.yaw.x, settings.yaw.y);
+    std::uniform_real_distribution<float> scale(settings.scale.x, settings.scale.y);
+    for (unsigned int i = 0; i < settings.count; ++i)
+    {
+        std::shared_ptr<Object> instance = blueprint->instantiate();
+        std::shared_ptr<Transform> t = instance->getComponent<Transform>();
+        if (!t)
+        {
+            t = makePooled<Transform>(instance);
+            instance->components.push_back(t);
+        }
+        // drawn in a fixed order so a seed always places the same way
+        float px = x(random), pz = x(random);
+        t->position() = center + glm::vec3(px * size.x, 0.0f, pz * size.y);
+        t->rotation().y += yaw(random);
+        t->scale() *= scale(random);
+        t->savePrevious();
+        instance->reparent(group);
+    }
+    addObject(group);
+    return group;
+}
+
+void Scene::registerLight(Light* light)
+{
+    registeredLights.push_back(light);
+    lightsDirty = true;
+}
+
+void Scene::unregisterLight(Light* light)
+{
+    auto it = std::find(registeredLights.begin(), registeredLights.end(), light);
+    if (it == registeredLights.end())
+        return;
+    registeredLights.erase(it);
+    lightsDirty = true;
+}
+
+// one light into the point light data at slot count, only flagging it
+// dirty if something actually moved or changed
+static void publishLight(Scene* s, unsigned int& count, Light* light, const glm::mat4* world)
+{
+    if (light->type == Light::Type::DIRECTIONAL)
+    {
         s->dirLight = light;
+        return;
+    }
 
-    for (auto obj : o->children)
-        findLightsRecursive(s, obj);
+    glm::vec4 posLinear(world ? glm::vec3((*world)[3]) : glm::vec3(0.0f), light->linearAttenuation);
+    glm::vec4 colorQuad(light->color, light->quadAttenuation);
+    if (world == nullptr)
+        colorQuad = glm::vec4(0.0f); // nowhere to put it, contributes nothing
+    if (count == s->lights.size())
+    {
+        s->lights.push_back(light);
+        s->pointLightData.push_back(posLinear);
+        s->pointLightData.push_back(colorQuad);
+        s->lightsDirty = true;
+    }
+    else if (s->lights[count] != light || s->pointLightData[count * 2] != posLinear || s->pointLightData[count * 2 + 1] != colorQuad)
+    {
+        s->lights[count] = light;
+        s->pointLightData[count * 2] = posLinear;
+        s->pointLightData[count * 2 + 1] = colorQuad;
+        s->lightsDirty = true;
+    }
+    count++;
 }
 
-void shaderUniforms(Scene* s)
+// split the lights by type and refresh the point light data
+void Scene::gatherLights()
 {
-    // reset light uniforms
-    for (auto shader : s->shaders)
+    unsigned int count = 0;
+    dirLight = nullptr;
+    if (ecsSystems)
+        world.each<TransformData, LightRef, InScene>([this, &count](size_t n, Entity*, TransformData* t, LightRef* l, InScene*) {
+            for (size_t i = 0; i < n; ++i)
+                publishLight(this, count, l[i].light, &t[i].worldMatrix);
+        });
+    else
+        for (auto light : registeredLights)
+            publishLight(this, count, light, light->transform ? &light->transform->worldMatrix() : nullptr);
+    if (count != lights.size())
+    {
+        lights.resize(count);
+        pointLightData.resize(count * 2);
+        lightsDirty = true;
+    }
+}
+
+glm::vec3 getSunDirection(Scene* s)
+{
+    return glm::rotate(
+        glm::quat(s->dirLight->transform->worldMatrix()),
+        glm::vec3(0, 1.0f, 0)
+    );
+}
+
+// the part of its blueprint an instance draws itself (everything it
+// hasn't overridden), at the instance's world matrix
+static void collectPrefabDraws(Scene* s, Object* o, const glm::mat4& world, bool isStatic)
+{
+    bool overridden = !o->children.empty();
+    for (auto& draw : o->getPrefab()->prefabDraws(s->drawListFrame))
+    {
+        if (overridden && o->overrides(draw.child))
+            continue;
+        glm::mat4 model = world * draw.model;
+        s->drawList.push_back(DrawItem(draw.renderer, model, draw.renderer->localBounds().transformed(model), isStatic || draw.isStatic));
+    }
+}
+
+// flatten the object tree into the draw list with world space bounds
+void collectDrawItems(Scene* s, std::shared_ptr<Object> o, bool isStatic = false)
+{
+    isStatic = isStatic || o->isStatic;
+    std::shared_ptr<Transform> t = o->getComponent<Transform>();
+    if (t)
     {
-        for (int i = 0; i < Scene::MAX_LIGHTS; ++i)
+        glm::mat4 model = t->worldMatrix();
+        for (auto component : o->components)
         {
-            glUniform3f(glGetUniformLocation(shader->id,
-                std::string("lights[" + std::to_string(i) + "].pos").c_str()),
-                0,
-                0,
-                0
-            );
-            glUniform3f(glGetUniformLocation(shader->id,
-                std::string("lights[" + std::to_string(i) + "].color").c_str()),
-                0,
-                0,
-                0
-            );
-            glUniform1f(glGetUniformLocation(shader->id,
-                std::string("lights[" + std::to_string(i) + "].linAttenuate").c_str()),
-                0
-            );
-            glUniform1f(glGetUniformLocation(shader->id,
-                std::string("lights[" + std::to_string(i) + "].quadAttenuate").c_str()),
-                0
-            );
+            Renderer* r = dynamic_cast<Renderer*>(component.get());
+            if (r && !(r->batched && s->staticBatching))
+                s->drawList.push_back(DrawItem(r, model, r->localBounds().transformed(model), isStatic));
         }
+        if (o->getPrefab())
+            collectPrefabDraws(s, o.get(), model, isStatic);
+    }
+    for (auto child : o->children)
+        collectDrawItems(s, child, isStatic);
+}
+
+void Scene::collectDrawList()
+{
+    drawList.clear();
+    drawListFrame++;
+    if (!ecsSystems)
+    {
+        for (auto obj : objects)
+            collectDrawItems(this, obj);
+        if (staticBatching)
+            staticBatches->appendDraws(drawList);
+        return;
+    }
+
+    // every entity with a transform and something to draw
+    world.each<TransformData, RendererSet, InScene>([this](size_t n, Entity*, TransformData* t, RendererSet* r, InScene*) {
+        for (size_t i = 0; i < n; ++i)
+            for (unsigned int j = 0; j < r[i].count; ++j)
+            {
+                Renderer* renderer = r[i].at(j);
+                if (renderer->batched && staticBatching)
+                    continue; // drawn by its static batch
+                const glm::mat4& model = t[i].worldMatrix;
+                drawList.push_back(DrawItem(renderer, model, renderer->localBounds().transformed(model), t[i].isStatic));
+            }
+    });
+    world.each<TransformData, PrefabRef, InScene>([this](size_t n, Entity*, TransformData* t, PrefabRef* p, InScene*) {
+        for (size_t i = 0; i < n; ++i)
+            collectPrefabDraws(this, p[i].object, t[i].worldMatrix, t[i].isStatic);
+    });
+    if (staticBatching)
+        staticBatches->appendDraws(drawList);
+}
+
+// cache world matrices down the tree, an object without a transform resets
+// the chain for its children (same as Transform::modelMatrix)
+void updateWorldMatrices(std::shared_ptr<Object> o, const glm::mat4& parent, float alpha)
+{
+    glm::mat4 world(1.0f);
+    std::shared_ptr<Transform> t = o->getComponent<Transform>();
+    if (t)
+    {
+        world = parent * t->interpolatedMatrix(alpha);
+        t->worldMatrix() = world;
+    }
+    for (auto child : o->children)
+        updateWorldMatrices(child, world, alpha);
+}
+
+// remember where everything was before a tick moves it
+void savePreviousTransforms(std::shared_ptr<Object> o)
+{
+    std::shared_ptr<Transform> t = o->getComponent<Transform>();
+    if (t)
+        t->savePrevious();
+    for (auto child : o->children)
+        savePreviousTransforms(child);
+}
+
+// static flag of an object or any of its parents, the slow way (for roots
+// of the transform hierarchy that still have a parent object)
+static bool inheritedStatic(Object* o)
+{
+    for (std::shared_ptr<Object> p = o->getParent(); p != nullptr; p = p->getParent())
+        if (p->isStatic)
+            return true;
+    return false;
+}
+
+// transforms grouped by depth, parents always in an earlier level than their
+// children. rebuilt when the world's structure changes, the pointers into
+// the columns are good until then
+void Scene::buildTransformLevels()
+{
+    transformLevels.clear();
+    transformChunks = world.chunks<TransformData, InScene>();
+
+    // depth of every entity with a transform, -1 = not known yet
+    std::vector<int> depth(world.capacity(), -1);
+    std::vector<Entity> entities;
+    world.each<TransformData, InScene>([&entities](size_t n, Entity* e, TransformData*, InScene*) {
+        entities.insert(entities.end(), e, e + n);
+    });
+    std::vector<Entity> chain;
+    for (Entity e : entities)
+    {
+        // walk up until we hit something we know (or the top), then fill in
+        // on the way back down
+        chain.clear();
+        Entity at = e;
+        int d = -1;
+        while (true)
+        {
+            if (depth[at.index] >= 0)
+            {
+                d = depth[at.index];
+                break;
+            }
+            chain.push_back(at);
+            Entity p = world.parent(at);
+            if (!world.has<TransformData>(p))
+                break;
+            at = p;
+        }
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+            depth[it->index] = ++d;
+    }
+
+    for (Entity e : entities)
+    {
+        size_t level = depth[e.index];
+        if (level >= transformLevels.size())
+            transformLevels.resize(level + 1);
+        TransformLink link;
+        link.transform = world.get<TransformData>(e);
+        link.parent = world.get<TransformData>(world.parent(e));
+        link.parentObject = world.parent(e).valid() && !link.parent;
+        transformLevels[level].push_back(link);
+    }
+    transformVersion = world.version;
+}
+
+void Scene::savePreviousTransforms()
+{
+    if (!ecsSystems)
+    {
+        JobSystem::get().parallelFor(objects.size(), 4, [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                ::savePreviousTransforms(objects[i]);
+        });
+        return;
+    }
+
+    std::vector<World::ChunkRef> chunks = world.chunks<TransformData>();
+    JobSystem::get().parallelFor(chunks.size(), 4, [this, &chunks](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c)
+            world.each<TransformData>(chunks[c], [](size_t n, Entity*, TransformData* t) {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    t[i].previousPosition = t[i].position;
+                    t[i].previousRotation = t[i].rotation;
+                    t[i].previousScale = t[i].scale;
+                }
+            });
+    });
+}
+
+// draws the visible part of the draw list for the current pass
+void renderDrawList(Scene* s)
+{
+    std::shared_ptr<Scene> scene = s->shared_from_this();
+    for (auto i : s->drawOrder)
+        if (s->drawList[i].visible)
+        {
+            s->currentFeatures = s->drawList[i].features;
+            s->drawList[i].renderer->render(scene, s->drawList[i].model);
+        }
+    s->currentFeatures = Shader::ALL_FEATURES;
+    // renderers leave the arena bound for the next one
+    GeometryArena::unbind();
+    s->indirectDraws->draw(s);
+}
+
+// the depth shader only does model and camera, anything with a vertex
+// shader that moves things around (batchable is false) can't take part
+static bool prepassable(const DrawItem& item)
+{
+    BatchMaterial material;
+    const void* geometry = nullptr;
+    return item.renderer->batchSource(material, geometry) && material.shader && material.shader->batchable;
+}
+
+// forward pass, with the depth pre-pass if it's on. shaderOverride draws
+// everything with one shader (the overdraw view)
+void renderForward(Scene* s, std::shared_ptr<Shader> depthShader, std::shared_ptr<Shader> shaderOverride = nullptr)
+{
+    if (!s->depthPrepass || !depthShader)
+    {
+        Profiler::Scope profile("forward", true);
+        std::shared_ptr<Scene> scene = s->shared_from_this();
+        for (auto i : s->drawOrder)
+            if (s->drawList[i].visible)
+            {
+                s->currentFeatures = s->drawList[i].features;
+                s->drawList[i].renderer->render(scene, s->drawList[i].model, shaderOverride);
+            }
+        s->currentFeatures = Shader::ALL_FEATURES;
+        GeometryArena::unbind();
+        s->indirectDraws->draw(s, shaderOverride);
+        return;
+    }
+
+    std::shared_ptr<Scene> scene = s->shared_from_this();
+    std::vector<char> early(s->drawList.size(), 0);
+    {
+        Profiler::Scope profile("depth prepass", true);
+        glm::mat4 cameraMat = s->activeCamera->getMatrix();
+        depthShader->activate();
+        glUniformMatrix4fv(glGetUniformLocation(depthShader->id, "lightViewProjection"), 1, GL_FALSE, glm::value_ptr(cameraMat));
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        for (auto i : s->drawOrder)
+        {
+            const DrawItem& item = s->drawList[i];
+            if (!item.visible || !prepassable(item))
+                continue;
+            early[i] = 1;
+            item.renderer->render(scene, item.model, depthShader);
+        }
+        GeometryArena::unbind();
+        s->indirectDraws->drawDepth(0, depthShader, cameraMat);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    }
+
+    Profiler::Scope profile("forward", true);
+    // only the nearest surface is left to pass, depth is already written
+    glDepthFunc(GL_EQUAL);
+    glDepthMask(GL_FALSE);
+    for (auto i : s->drawOrder)
+        if (early[i])
+        {
+            s->currentFeatures = s->drawList[i].features;
+            s->drawList[i].renderer->render(scene, s->drawList[i].model, shaderOverride);
+        }
+    s->currentFeatures = Shader::ALL_FEATURES;
+    GeometryArena::unbind();
+    s->indirectDraws->draw(s, shaderOverride);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+
+    // the rest the usual way
+    for (auto i : s->drawOrder)
+        if (s->drawList[i].visible && !early[i])
+        {
+            s->currentFeatures = s->drawList[i].features;
+            s->drawList[i].renderer->render(scene, s->drawList[i].model, shaderOverride);
+        }
+    s->currentFeatures = Shader::ALL_FEATURES;
+    GeometryArena::unbind();
+}
+
+// overdraw view, additive so each shaded fragment brightens its pixel
+void renderOverdraw(Scene* s, std::shared_ptr<Shader> depthShader)
+{
+    std::shared_ptr<Shader> overdrawShader;
+    for (auto shader : s->shaders)
+        if (shader->name == "overdraw")
+        {
+            overdrawShader = shader;
+            break;
+        }
+    if (!overdrawShader)
+    {
+        std::cout << "ERROR::RENDERER::could not find overdraw shader" << std::endl;
+        s->overdrawView = false;
+        return;
+    }
+
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    renderForward(s, depthShader, overdrawShader);
+    glDisable(GL_BLEND);
+}
+
+// shader features the whole frame needs, lights the scene doesn't have go
+static unsigned int sceneFeatures(Scene* s)
+{
+    unsigned int features = Shader::ALL_FEATURES;
+    if (!s->dirLight)
+        features &= ~Shader::SUN;
+    if (!s->lightClusters->lightCount)
+        features &= ~Shader::POINT_LIGHTS;
+    return features;
+}
+
+// everything a shader gets from the scene, once a frame
+static void shaderUniforms(Scene* s, std::shared_ptr<Shader> shader)
+{
+    shader->activate();
+
+    // reset light uniforms
+    glUniform3f(glGetUniformLocation(shader->id, "sun.dir"),
+        0,
+        0,
+        0
+    );
+    glUniform3f(glGetUniformLocation(shader->id, "sun.color"),
+        0,
+        0,
+        0
+    );
+
+    // scene ambient parameters
+    glUniform3f(glGetUniformLocation(shader->id, "ambientColor"),
+        s->ambientColor.r,
+        s->ambientColor.g,
+        s->ambientColor.b
+    );
+    glUniform1f(glGetUniformLocation(shader->id, "ambientIntensity"), s->ambientIntensity);
+
+    // specular lighting, camera position. from the interpolated world
+    // matrix like the view, not the local position as of the last tick
+    glm::vec3 cameraPos = glm::vec3(s->activeCamera->transform->worldMatrix()[3]);
+    glUniform3f(glGetUniformLocation(shader->id, "cameraPos"),
+        cameraPos.x,
+        cameraPos.y,
+        cameraPos.z
+    );
+
+    // background color of scene
+    glUniform3f(glGetUniformLocation(shader->id, "backgroundColor"),
+        s->backgroundColor.r,
+        s->backgroundColor.g,
+        s->backgroundColor.b
+    );
+
+    // camera matrix (view + projection) and fog params
+    glUniformMatrix4fv(glGetUniformLocation(shader->id, "cameraMat"), 1, GL_FALSE, glm::value_ptr(s->activeCamera->getMatrix()));
+    glUniformMatrix4fv(glGetUniformLocation(shader->id, "view"), 1, GL_FALSE, glm::value_ptr(s->activeCamera->getView()));
+    glUniform1f(glGetUniformLocation(shader->id, "farPlane"), s->activeCamera->far);
+    glUniform1f(glGetUniformLocation(shader->id, "fogOffset"), s->activeCamera->fogOffset);
+
+    // clustered point lights
+    s->lightClusters->setUniforms(shader);
+
+    // sun shadow cascades (the sampler is set even without a sun so it
+    // never shares a texture unit with a sampler of another type)
+    s->sunShadows->setUniforms(shader);
+
+    // extract rotation from directional light transform
+    if (s->dirLight)
+    {
+        glm::vec3 sunDirection = getSunDirection(s);
         glUniform3f(glGetUniformLocation(shader->id, "sun.dir"),
-            0,
-            0,
-            0
+            sunDirection.x,
+            sunDirection.y,
+            sunDirection.z
         );
         glUniform3f(glGetUniformLocation(shader->id, "sun.color"),
-            0,
-            0,
-            0
+            s->dirLight->color.r,
+            s->dirLight->color.g,
+            s->dirLight->color.b
         );
     }
+    // simulation clock, between the last two ticks like the transforms
+    glUniform1f(glGetUniformLocation(shader->id, "time"), (float)(s->time - (1.0 - s->interpolation) * s->dTime));
+}
+
+void shaderUniforms(Scene* s)
+{
+    for (auto shader : s->shaders)
+    {
+        shaderUniforms(s, shader);
+        for (auto& variant : shader->variants)
+            shaderUniforms(s, variant.second);
+    }
+}
+
+std::shared_ptr<Shader> Scene::shaderVariant(std::shared_ptr<Shader> shader, unsigned int features)
+{
+    features &= shader->keywords;
+    if (!shaderVariants || features == shader->features)
+        return shader;
+    auto it = shader->variants.find(features);
+    if (it != shader->variants.end())
+        return it->second;
 
-    // set uniforms
+    // first draw that needs it, it gets this frame's uniforms straight away
+    std::string name = shader->name + ":";
+    for (unsigned int f = 1; f < Shader::ALL_FEATURES; f <<= 1)
+        if (features & f)
+            name += std::string(" ") + Shader::featureName(f);
+    if (!features)
+        name += " none";
+    std::shared_ptr<Shader> variant(new Shader(name, shader->vertPath.c_str(), shader->fragPath.c_str(), shader->header, features));
+    shader->variants[features] = variant;
+    shaderUniforms(this, variant);
+    variantCount++;
+    return variant;
+}
+
+void renderDeferred(Scene* s)
+{
+    std::shared_ptr<Shader> lightingShader;
     for (auto shader : s->shaders)
+        if (shader->name == "deferred")
+        {
+            lightingShader = shader;
+            break;
+        }
+    if (!lightingShader)
     {
-        shader->activate();
+        std::cout << "ERROR::RENDERER::could not find deferred lighting shader" << std::endl;
+        s->renderPath = Scene::RenderPath::FORWARD;
+        return;
+    }
 
-        // scene ambient parameters
-        glUniform3f(glGetUniformLocation(shader->id, "ambientColor"),
-            s->ambientColor.r,
-            s->ambientColor.g,
-            s->ambientColor.b
-        );
-        glUniform1f(glGetUniformLocation(shader->id, "ambientIntensity"), s->ambientIntensity);
+    // (re)create g-buffer at screen size
+    const auto mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    if (!s->gBuffer || s->gBuffer->width != (unsigned int)mode->width || s->gBuffer->height != (unsigned int)mode->height)
+        s->gBuffer = std::shared_ptr<FBO>(new FBO(mode->width, mode->height, {
+            { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE },  // albedo
+            { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT },   // specular color, shininess
+            { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT }    // normal
+        }));
 
-        // specular lighting, camera position
-        glUniform3f(glGetUniformLocation(shader->id, "cameraPos"),
-            s->activeCamera->transform->position.x,
-            s->activeCamera->transform->position.y,
-            s->activeCamera->transform->position.z
-        );
+    // geometry pass, materials only
+    {
+        Profiler::Scope profile("gbuffer", true);
+        s->gBuffer->bind();
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        s->currentPass = Scene::Pass::GBUFFER_PASS;
+        renderDrawList(s);
+        s->gBuffer->unbind();
+    }
 
-        // background color of scene
-        glUniform3f(glGetUniformLocation(shader->id, "backgroundColor"),
-            s->backgroundColor.r,
-            s->backgroundColor.g,
-            s->backgroundColor.b
-        );
+    // lighting pass, one fullscreen triangle
+    {
+        Profiler::Scope profile("lighting", true);
+        lightingShader = s->shaderVariant(lightingShader, sceneFeatures(s));
+        lightingShader->activate();
+        for (unsigned int i = 0; i < s->gBuffer->colorTextures.size(); ++i)
+            s->gBuffer->colorTextures[i]->bind(GL_TEXTURE6 + i);
+        s->gBuffer->texture->bind(GL_TEXTURE9);
+        glUniform1i(glGetUniformLocation(lightingShader->id, "gAlbedo"), 6);
+        glUniform1i(glGetUniformLocation(lightingShader->id, "gSpecular"), 7);
+        glUniform1i(glGetUniformLocation(lightingShader->id, "gNormal"), 8);
+        glUniform1i(glGetUniformLocation(lightingShader->id, "gDepth"), 9);
+        glUniformMatrix4fv(glGetUniformLocation(lightingShader->id, "inverseCameraMat"), 1, GL_FALSE,
+            glm::value_ptr(glm::inverse(s->activeCamera->getMatrix())));
+
+        // the lighting shader writes the g-buffer depth out so the forward
+        // objects drawn after it are still depth tested against the scene
+        static GLuint emptyVAO = 0;
+        if (!emptyVAO)
+            glGenVertexArrays(1, &emptyVAO);
+        glBindVertexArray(emptyVAO);
+        glDepthFunc(GL_ALWAYS);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glDepthFunc(GL_LESS);
+        glBindVertexArray(0);
+    }
+
+    // anything without a g-buffer variant is still drawn forward
+    {
+        Profiler::Scope profile("forward", true);
+        s->currentPass = Scene::Pass::FALLBACK_PASS;
+        renderDrawList(s);
+    }
+    s->currentPass = Scene::Pass::FORWARD_PASS;
+}
+
+// scripts due this tick in update order, cut into steps. a parallel step is
+// a batch of scripts that don't touch each other's data, the others run in
+// order on the main thread (a script that has to run alone, or everything
+// when batching is off)
+struct ScriptStep {
+    std::vector<Script*> scripts;
+    bool parallel;
+};
+struct ScriptSchedule {
+    std::vector<ScriptStep> steps;
+    bool batched = true;
+    int segmentStart = 0; // first step after the last script that ran alone
+};
 
-        // camera matrix (view + projection) and fog params
-        glUniformMatrix4fv(glGetUniformLocation(shader->id, "cameraMat"), 1, GL_FALSE, glm::value_ptr(s->activeCamera->getMatrix()));
-        glUniformMatrix4fv(glGetUniformLocation(shader->id, "view"), 1, GL_FALSE, glm::value_ptr(s->activeCamera->getView()));
-        glUniform1f(glGetUniformLocation(shader->id, "farPlane"), s->activeCamera->far);
-        glUniform1f(glGetUniformLocation(shader->id, "fogOffset"), s->activeCamera->fogOffset);
+// walk the tree in the same order as the serial update. a script goes in the
+// earliest batch after the last script that ran alone and after the batch
+// that wrote what it reads (parentBatch/ownBatch, -1 if not written yet), so
+// a parent's bob and its child's bob land in consecutive batches instead of
+// cutting the batch for every object
+static void scheduleScripts(Scene* s, Object* o, ScriptSchedule& schedule, int parentBatch)
+{
+    std::vector<ScriptStep>& steps = schedule.steps;
+    int ownBatch = -1;
+    for (auto& script : o->scripts)
+    {
+        if (!script->due(s))
+            continue;
+        if (!script->stats)
+            script->stats = &s->scriptStats[script->getName()];
 
-        // lights
-        for (int i = 0; i < s->lights.size(); ++i)
+        if (!schedule.batched)
         {
-            glUniform3f(glGetUniformLocation(shader->id,
-                std::string("lights[" + std::to_string(i) + "].pos").c_str()),
-                s->lights[i]->transform->worldPos().x,
-                s->lights[i]->transform->worldPos().y,
-                s->lights[i]->transform->worldPos().z
-            );
-            glUniform3f(glGetUniformLocation(shader->id,
-                std::string("lights[" + std::to_string(i) + "].color").c_str()),
-                s->lights[i]->color.r,
-                s->lights[i]->color.g,
-                s->lights[i]->color.b
-            );
-            glUniform1f(glGetUniformLocation(shader->id,
-                std::string("lights[" + std::to_string(i) + "].linAttenuate").c_str()),
-                s->lights[i]->linearAttenuation
-            );
-            glUniform1f(glGetUniformLocation(shader->id,
-                std::string("lights[" + std::to_string(i) + "].quadAttenuate").c_str()),
-                s->lights[i]->quadAttenuation
-            );
+            if (steps.empty())
+                steps.push_back({ {}, false });
+            steps[0].scripts.push_back(script.get());
+            continue;
         }
-        // extract rotation from directional light transform
-        if (s->dirLight)
+        if (script->runsAlone())
         {
-            glm::vec3 sunDirection = glm::rotate(
-                glm::quat(s->dirLight->transform->modelMatrix()),
-                glm::vec3(0, 1.0f, 0)
-            );
-            glUniform3f(glGetUniformLocation(shader->id, "sun.dir"),
-                sunDirection.x,
-                sunDirection.y,
-                sunDirection.z
-            );
-            glUniform3f(glGetUniformLocation(shader->id, "sun.color"),
-                s->dirLight->color.r,
-                s->dirLight->color.g,
-                s->dirLight->color.b
-            );
-
-            // set depth buffer
-            s->sunShadowBuffer->texture->bind(GL_TEXTURE2);
-            glUniform1i(glGetUniformLocation(shader->id, "sunShadow"), 2);
-
-            // set sun space matrix for depth shader
-            glm::mat4 sunViewProjection =
-                glm::ortho(-200.0f, 200.0f, -200.0f, 200.0f, 0.1f, 600.0f) *
-                glm::lookAt(s->dirLight->transform->worldPos(), s->dirLight->transform->worldPos() + sunDirection, glm::vec3(0, 1.0f, 0));
-            glUniformMatrix4fv(glGetUniformLocation(shader->id, "sunViewProjection"), 1, GL_FALSE, glm::value_ptr(sunViewProjection));
+            steps.push_back({ { script.get() }, false });
+            schedule.segmentStart = steps.size();
+            continue;
         }
-        glUniform1f(glGetUniformLocation(shader->id, "time"), glfwGetTime());
+        unsigned int access = script->access();
+        int batch = schedule.segmentStart;
+        if (access & Script::PARENT_TRANSFORM)
+            batch = std::max(batch, parentBatch + 1);
+        if (access & Script::OWN_TRANSFORM)
+            batch = std::max(batch, ownBatch + 1);
+        if (batch == (int)steps.size())
+            steps.push_back({ {}, true });
+        steps[batch].scripts.push_back(script.get());
+        if (access & Script::OWN_TRANSFORM)
+            ownBatch = batch;
     }
+    for (auto& child : o->children)
+        scheduleScripts(s, child.get(), schedule, ownBatch);
 }
 
-void Scene::update() {
-    // calculate deltaTime
-    dTime = glfwGetTime() - dTime;
-    for (auto obj : objects)
-        obj->update(this->shared_from_this());
+// run scripts in order, timing each run of the same script type as one
+// (timing every call costs about as much as a BobAndSpin update)
+static void runScripts(Script* const* scripts, size_t count, std::shared_ptr<Scene>& s)
+{
+    size_t i = 0;
+    while (i < count)
+    {
+        ScriptStats* stats = scripts[i]->stats;
+        auto start = std::chrono::steady_clock::now();
+        size_t j = i;
+        for (; j < count && scripts[j]->stats == stats; ++j)
+            scripts[j]->run(s);
+        stats->ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        stats->calls += j - i;
+        i = j;
+    }
+}
+
+void Scene::updateScripts()
+{
+    Profiler::Scope profile("scripts");
+    std::shared_ptr<Scene> s = this->shared_from_this();
+
+    // batching only pays off with workers to hand the batches to. either
+    // way the result is the same as running them one by one in tree order
+    ScriptSchedule schedule;
+    schedule.batched = parallelScripts && JobSystem::get().workerCount() > 0;
+    for (auto& obj : objects)
+        scheduleScripts(this, obj.get(), schedule, -1);
+    for (auto& step : schedule.steps)
+    {
+        std::vector<Script*>& scripts = step.scripts;
+        if (!step.parallel)
+        {
+            runScripts(scripts.data(), scripts.size(), s);
+            continue;
+        }
+        JobSystem::get().parallelFor(scripts.size(), 512, [&scripts, &s](size_t begin, size_t end) {
+            runScripts(scripts.data() + begin, end - begin, s);
+        });
+    }
+    if (schedule.batched)
+        Profiler::get().count("script steps", schedule.steps.size());
+}
+
+void Scene::publishScriptStats()
+{
+    for (auto& it : scriptStats)
+    {
+        Profiler::get().count("script " + it.first + " calls", it.second.calls.exchange(0));
+        Profiler::get().count("script " + it.first + " ms", it.second.ns.exchange(0) / 1000000.0);
+    }
+}
+
+void Scene::tick(double step)
+{
+    savePreviousTransforms();
 
-    // set the dtime to current time for next frame calc
-    dTime = glfwGetTime();
+    // was there input since the last tick (for scripts that only run on input)
+    double cursorX = 0.0, cursorY = 0.0;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+    int mouseButtons = 0;
+    for (int button = GLFW_MOUSE_BUTTON_1; button <= GLFW_MOUSE_BUTTON_3; ++button)
+        if (glfwGetMouseButton(window, button) == GLFW_PRESS)
+            mouseButtons |= 1 << button;
+    inputThisTick = scrollX != 0.0f || scrollY != 0.0f
+        || mouseButtons != 0 || mouseButtons != lastMouseButtons // held, or just released
+        || cursorX != lastCursorX || cursorY != lastCursorY;
+    lastCursorX = cursorX;
+    lastCursorY = cursorY;
+    lastMouseButtons = mouseButtons;
 
-    // reset scroll values
+    dTime = step;
+    time += step;
+    updateScripts();
+    tickIndex++;
+
+    // scroll input has been used up
     scrollX = 0.0f;
     scrollY = 0.0f;
 }
 
+void Scene::simulate(double seconds)
+{
+    double step = 1.0 / tickRate;
+    for (double t = 0.0; t + step * 0.5 < seconds; t += step)
+        tick(step);
+}
+
+void Scene::update() {
+    // run as many fixed ticks as real time has passed, so the simulation
+    // doesn't speed up or get jumpy with the frame rate. the first frame
+    // gets one tick so scripts have run before anything is drawn
+    double now = glfwGetTime();
+    double step = 1.0 / tickRate;
+    accumulator += lastTime < 0.0 ? step : now - lastTime;
+    lastTime = now;
+
+    unsigned int ticks = 0;
+    while (accumulator >= step && ticks < (unsigned int)maxTicksPerFrame)
+    {
+        tick(step);
+        accumulator -= step;
+        ticks++;
+    }
+    // a frame took so long we'd need more than the cap to catch up, drop
+    // the backlog instead of spiralling (sim runs slower than real time)
+    if (accumulator >= step)
+        accumulator = std::fmod(accumulator, step);
+    interpolation = (float)(accumulator / step);
+    Profiler::get().count("ticks", ticks);
+    publishScriptStats();
+
+    // bring the world matrices up to date, in between the last two ticks
+    updateWorldMatrices();
+}
+
+void Scene::updateWorldMatrices()
+{
+    Profiler::Scope profile("world matrices");
+    if (!ecsSystems)
+    {
+        // root subtrees are independent so they go wide
+        JobSystem::get().parallelFor(objects.size(), 4, [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                ::updateWorldMatrices(objects[i], glm::mat4(1.0f), interpolation);
+        });
+        return;
+    }
+
+    if (transformVersion != world.version)
+        buildTransformLevels();
+
+    // local matrices straight down the columns
+    float alpha = interpolation;
+    JobSystem::get().parallelFor(transformChunks.size(), 4, [this, alpha](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c)
+            world.each<TransformData>(transformChunks[c], [alpha](size_t n, Entity*, TransformData* t) {
+                for (size_t i = 0; i < n; ++i)
+                    t[i].worldMatrix = Transform::interpolatedMatrix(t[i], alpha);
+            });
+    });
+
+    // then parents into children a level at a time, each level goes wide
+    for (auto& level : transformLevels)
+        JobSystem::get().parallelFor(level.size(), 1024, [&level](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                TransformLink& link = level[i];
+                TransformData* t = link.transform;
+                if (link.parent)
+                {
+                    t->worldMatrix = link.parent->worldMatrix * t->worldMatrix;
+                    t->isStatic = t->object->isStatic || link.parent->isStatic;
+                }
+                else
+                    t->isStatic = t->object->isStatic || (link.parentObject && inheritedStatic(t->object));
+            }
+        });
+}
+
 void Scene::render() {
-    // find all lights in scene
-    lights.clear();
-    dirLight = nullptr;
-    for (auto obj : objects)
-        findLightsRecursive(this, obj);
+    // changed assets go in before anything looks at them this frame
+    assetReloader->apply(this);
+    textureStreamer->update();
 
-    // set all shader uniforms that can be set
-    shaderUniforms(this);
+    // nothing to look through (the camera object was deleted)
+    if (!activeCamera)
+        return;
 
-    // render to shadowbuffer
+    // bin point lights into clusters for this frame's view
+    {
+        Profiler::Scope profile("light binning");
+        gatherLights();
+        lightClusters->update(activeCamera, pointLightData, lightsDirty);
+        lightClusters->bind();
+        lightsDirty = false;
+    }
+
+    // everything that draws this frame
+    if (staticBatches->dirty)
+    {
+        Profiler::Scope profile("static batching");
+        staticBatches->build(this);
+        occlusion->forget();
+    }
+    collectDrawList();
+
+    std::shared_ptr<Shader> depthShader;
     if (dirLight)
     {
-        std::shared_ptr<Shader> depthShader;
         for (auto shader : shaders)
-            if (shader->name.find("depth_") != std::string::npos)
+            if (shader->name.find("depth_") == 0)
             {
                 depthShader = shader;
                 break;
             }
-        if (depthShader)
+        if (!depthShader)
+            std::cout << "ERROR::RENDERER::could not find depth shader" << std::endl;
+    }
+
+    // frustum cull the camera passes, shadows cull per cascade themselves
+    glm::mat4 viewProjection = activeCamera->getMatrix();
+    {
+        Profiler::Scope profile("culling");
+        Frustum frustum(viewProjection);
+        JobSystem::get().parallelFor(drawList.size(), 256, [this, &frustum](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                drawList[i].visible = frustum.intersects(drawList[i].bounds);
+        });
+    }
+    {
+        Profiler::Scope profile("occlusion");
+        occlusion->cull(drawList, viewProjection);
+    }
+
+    // the shader features each visible draw needs: textures it has bound,
+    // point lights that reach its bounds, fog if it can be far enough away
+    {
+        Profiler::Scope profile("shader features");
+        unsigned int frame = shaderVariants ? sceneFeatures(this) : Shader::ALL_FEATURES;
+        glm::mat4 view = activeCamera->getView();
+        float fogStart = activeCamera->far - activeCamera->fogOffset;
+        bool fog = activeCamera->fogOffset > 0.0f;
+        JobSystem::get().parallelFor(drawList.size(), 256, [this, frame, &view, fogStart, fog](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                DrawItem& item = drawList[i];
+                item.features = frame;
+                if (!shaderVariants || !item.visible || !item.bounds.valid())
+                    continue;
+                BatchMaterial material;
+                const void* geometry = nullptr;
+                if (item.renderer->batchSource(material, geometry))
+                {
+                    if (!material.diffuseTex)
+                        item.features &= ~Shader::DIFFUSE_TEX;
+                    if (!material.specularTex)
+                        item.features &= ~Shader::SPECULAR_TEX;
+                    // a vertex shader that moves things can take them out of their bounds
+                    if (material.shader && !material.shader->batchable)
+                        continue;
+                }
+                if ((item.features & Shader::POINT_LIGHTS) && !lightClusters->reaches(item.bounds))
+                    item.features &= ~Shader::POINT_LIGHTS;
+                // depth is -view z, its largest over the box is at the corner
+                // picked axis by axis
+                float z = view[3][2];
+                for (int a = 0; a < 3; ++a)
+                    z += std::min(view[a][2] * item.bounds.min[a], view[a][2] * item.bounds.max[a]);
+                if (fog && -z <= fogStart)
+                    item.features &= ~Shader::FOG;
+            }
+        });
+    }
+
+    // nearest first, so the depth test rejects more of what's behind
+    {
+        Profiler::Scope profile("draw sort");
+        drawOrder.resize(drawList.size());
+        for (unsigned int i = 0; i < drawOrder.size(); ++i)
+            drawOrder[i] = i;
+        if (sortFrontToBack)
         {
-            glViewport(0, 0, sunShadowBuffer->width, sunShadowBuffer->height);
-            sunShadowBuffer->bind();
-            glClear(GL_DEPTH_BUFFER_BIT);
-            for (auto obj : objects)
-                obj->render(this->shared_from_this(), depthShader);
-            sunShadowBuffer->unbind();
-            const auto mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
-            glViewport(0, 0, mode->width, mode->height);
+            glm::vec3 eye = glm::vec3(glm::inverse(activeCamera->getView())[3]);
+            std::vector<float> distance(drawList.size());
+            for (size_t i = 0; i < drawList.size(); ++i)
+            {
+                const AABB& b = drawList[i].bounds;
+                // unbounded things (skyboxes and such) last
+                distance[i] = b.valid() ? glm::length(glm::clamp(eye, b.min, b.max) - eye) : std::numeric_limits<float>::max();
+            }
+            std::stable_sort(drawOrder.begin(), drawOrder.end(), [&distance](unsigned int a, unsigned int b) {
+                return distance[a] < distance[b];
+            });
         }
-        else std::cout << "ERROR::RENDERER::could not find depth shader" << std::endl;
+    }
+
+    // whatever can go through multi-draw indirect is culled on the gpu
+    // (again, plus the shadow cascades), it keeps the occlusion results
+    {
+        Profiler::Scope profile("indirect build");
+        indirectDraws->build(this, drawList, drawOrder, depthShader);
+    }
+    unsigned int visible = 0;
+    for (auto& item : drawList)
+        visible += item.visible;
+    Profiler::get().count("visible draws", visible);
+
+    // fit the shadow cascades to the camera before the uniforms go out
+    if (depthShader)
+    {
+        Profiler::Scope profile("shadow fit");
+        sunShadows->update(activeCamera, getSunDirection(this), drawList);
+    }
+
+    {
+        Profiler::Scope profile("indirect cull", true);
+        indirectDraws->cull(this);
+    }
+
+    // set all shader uniforms that can be set
+    shaderUniforms(this);
+
+    // render to shadow cascades
+    if (dirLight && depthShader)
+    {
+        Profiler::Scope profile("shadow", true);
+        sunShadows->render(this->shared_from_this(), depthShader, drawList);
+        const auto mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+        glViewport(0, 0, mode->width, mode->height);
     }
 
     // render to screen
-    for (auto obj : objects)
-        obj->render(this->shared_from_this());
+    if (overdrawView)
+        renderOverdraw(this, depthShader);
+    else if (renderPath == RenderPath::DEFERRED)
+        renderDeferred(this);
+    else
+        renderForward(this, depthShader);
 }
 
 void Scene::renderUI() {
@@ -476,11 +1619,16 @@ void Scene::save(std::string filename)
 {
     YAML::Emitter serialiser;
 
-    // objects as sequence of maps
-    serialiser << YAML::BeginSeq;
+    // objects as sequence of maps, they refer to each other by id
+    serialiser << YAML::BeginMap;
+    if (activeCamera)
+        serialiser << YAML::Key << "activeCamera" << YAML::Value << activeCamera->getObject()->getHandle().index;
+    serialiser << YAML::Key << "objects";
+    serialiser << YAML::Value << YAML::BeginSeq;
     for (auto obj : objects)
         serialiser << *obj; // expect map
     serialiser << YAML::EndSeq;
+    serialiser << YAML::EndMap;
 
     std::ofstream outfile(filename);
     if (outfile)
@@ -496,19 +1644,32 @@ void Scene::save(std::string filename)
 void Scene::load(std::string filename)
 {
     YAML::Node sceneNode = YAML::LoadFile(filename);
-    if (!sceneNode || !sceneNode.IsSequence())
+    // older saves are just the object sequence
+    YAML::Node objectsNode = sceneNode.IsMap() ? sceneNode["objects"] : sceneNode;
+    if (!objectsNode || !objectsNode.IsSequence())
         std::cout << "ERROR::SCENE::DESERIALISER::can't read file" << std::endl;
 
-    for (auto it = sceneNode.begin(); it != sceneNode.end(); ++it)
-        objects.push_back(Object::deserialise(*it, this->shared_from_this()));
+    std::map<unsigned int, std::shared_ptr<Object>> ids;
+    for (auto it = objectsNode.begin(); it != objectsNode.end(); ++it)
+        addObject(Object::deserialise(*it, this->shared_from_this(), &ids));
 
-    for (auto obj : objects)
+    if (sceneNode.IsMap() && sceneNode["activeCamera"])
     {
-        auto cam = obj->getComponent<Camera>();
-        if (cam)
+        auto it = ids.find(sceneNode["activeCamera"].as<unsigned int>());
+        if (it != ids.end())
+            activeCamera = it->second->getComponent<Camera>();
+    }
+    if (!activeCamera)
+        for (auto obj : objects)
         {
-            activeCamera = cam;
-            break;
+            auto cam = obj->getComponent<Camera>();
+            if (cam)
+            {
+                activeCamera = cam;
+                break;
+            }
         }
-    }
+
+    // merge the static geometry on the first frame, once everything's placed
+    staticBatches->dirty = true;
 }
\ No newline at end of file
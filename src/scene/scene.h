@@ -1,17 +1,32 @@
 #pragma once
 
 #include <scene/object/object.h>
+#include <scene/object/objectHandle.h>
+#include <scene/ecs/world.h>
+#include <scene/ecs/components.h>
 #include <scene/object/components/camera.h>
+#include <scene/lightClusters.h>
+#include <scene/shadowCascades.h>
+#include <scene/staticBatches.h>
+#include <scene/indirectDraws.h>
+#include <scene/occlusionCuller.h>
+#include <scene/assetReloader.h>
+#include <scene/drawItem.h>
 #include <ui/window.h>
 #include <util/shader.h>
 #include <util/mesh.h>
 #include <util/texture.h>
 #include <util/fbo.h>
+#include <util/textureStreamer.h>
 
 #include <GLFW/glfw3.h>
 
 #include <vector>
 #include <memory>
+#include <map>
+#include <string>
+#include <atomic>
+#include <mutex>
 
 class Object;
 class Window;
@@ -19,6 +34,13 @@ class Shader;
 class Camera;
 class Light;
 
+// time spent in and calls to one script type, summed from whichever thread
+// ran them and handed to the profiler once a frame
+struct ScriptStats {
+    std::atomic<unsigned long long> ns{ 0 };
+    std::atomic<unsigned int> calls{ 0 };
+};
+
 class Scene : public std::enable_shared_from_this<Scene>
 {
 public:
@@ -29,29 +51,114 @@ public:
             s->scrollX += x;
             s->scrollY += y;
             });
-        sunShadowBuffer = std::shared_ptr<FBO>(new FBO(2048, 2048, GL_DEPTH_ATTACHMENT));
+        sunShadows = std::shared_ptr<ShadowCascades>(new ShadowCascades());
+        lightClusters = std::shared_ptr<LightClusters>(new LightClusters());
+        staticBatches = std::shared_ptr<StaticBatches>(new StaticBatches());
+        indirectDraws = std::shared_ptr<IndirectDraws>(new IndirectDraws());
+        occlusion = std::shared_ptr<OcclusionCuller>(new OcclusionCuller());
+        assetReloader = std::shared_ptr<AssetReloader>(new AssetReloader());
+        textureStreamer = std::shared_ptr<TextureStreamer>(new TextureStreamer());
     }
+    ~Scene();
     // WARNING: THIS MUST BE CALLED AFTER CONSTRUCTOR!
     //          (relies on shared_from_this())
     void loadAssets(const char* path = "./res");
 
+    // hot reload (main thread, see AssetReloader). a changed asset is
+    // rebuilt inside the objects already using it, a new one is imported
+    // like loadAssets would. false (and the old version kept) if it fails
+    bool reloadAsset(AssetFile& asset);
+    // a deleted file, unused assets leave the lists. false if it's still in
+    // use (drawn with, placed) and was kept
+    bool removeAsset(AssetFile& asset);
+    std::shared_ptr<AssetReloader> assetReloader;
+    // image textures upload through this over a few frames (loading and
+    // reloading), drawn with a placeholder until they're in
+    std::shared_ptr<TextureStreamer> textureStreamer;
+
     void update();
     void render();
     void renderUI();
 
-    static const int MAX_LIGHTS = 16;
-    std::vector<std::shared_ptr<Light>> lights;
-    std::shared_ptr<Light> dirLight;
-    std::shared_ptr<FBO> sunShadowBuffer;
+    // light registry, lights add themselves when they are created and take
+    // themselves out when removed so we never search the object tree for them
+    void registerLight(Light* light);
+    void unregisterLight(Light* light);
+    std::vector<Light*> registeredLights;
+
+    // gathered from the registry each frame. pointLightData is the dense
+    // upload layout (2 texels per point light: pos + linear, color + quadratic)
+    // and lightsDirty is set when it changed since the last upload
+    std::vector<Light*> lights;
+    Light* dirLight = nullptr;
+    std::vector<glm::vec4> pointLightData;
+    bool lightsDirty = true;
+    std::shared_ptr<ShadowCascades> sunShadows;
+    std::shared_ptr<LightClusters> lightClusters;
+    std::shared_ptr<StaticBatches> staticBatches;
+    bool staticBatching = true; // draw the batches instead of the renderers merged into them
+    std::shared_ptr<IndirectDraws> indirectDraws; // GL 4.3 only, see IndirectDraws::enabled
+    std::shared_ptr<OcclusionCuller> occlusion;
+    std::shared_ptr<FBO> gBuffer; // created on first deferred frame
     glm::vec3 backgroundColor = glm::vec3(0.0f, 0.0f, 0.0f);
 
     std::shared_ptr<Camera> activeCamera;
     std::shared_ptr<Object> inspectedObject;
 
+    // component data for the systems (world matrices, light gather, draw
+    // list), every object has an entity in here. declared before the objects
+    // so it outlives them
+    World world;
+    // false walks the object tree instead, kept for comparison
+    bool ecsSystems = true;
+
+    // scene roots, read only. add with addObject (or Object::reparent)
     std::vector<std::shared_ptr<Object>> objects;
+    void addObject(std::shared_ptr<Object> o);
+    // bumps whenever an object is linked, unlinked or renamed, for views of
+    // the hierarchy that cache it (main thread)
+    unsigned long long hierarchyVersion = 0;
+
+    // object registry, every object gets a generational handle when it's
+    // created. find() is for the main thread (ui, editor tools)
+    ObjectHandle registerObject(Object* o);
+    void unregisterObject(ObjectHandle handle);
+    std::shared_ptr<Object> find(ObjectHandle handle);
+    struct ObjectSlot {
+        Object* object = nullptr;
+        unsigned int generation = 1;
+    };
+    std::vector<ObjectSlot> objectSlots;
+    std::vector<unsigned int> freeObjectSlots;
+    std::mutex registryLock;
+
+    // bulk edits for big selections, handles that no longer resolve (the
+    // object or one of its parents went earlier in the batch) are skipped.
+    // an invalid parent handle reparents to the scene root
+    void removeObjects(const std::vector<ObjectHandle>& handles);
+    void reparentObjects(const std::vector<ObjectHandle>& handles, ObjectHandle parent);
+
+    // lots of instances of a blueprint at once (vegetation and such), spread
+    // over a region with a random yaw and scale. the same seed gives the
+    // same placement every time
+    struct Scatter {
+        unsigned int count = 100;
+        unsigned int seed = 1;
+        glm::vec3 center = glm::vec3(0.0f); // y is the height they stand at
+        glm::vec2 size = glm::vec2(50.0f);  // x/z extent of the region
+        ObjectHandle surface; // if set, region and height come from the top of this object's bounds
+        glm::vec2 yaw = glm::vec2(0.0f, 360.0f); // degrees, min/max
+        glm::vec2 scale = glm::vec2(0.8f, 1.2f); // uniform, min/max
+    };
+    // the instances go under a new scene root, which is returned
+    std::shared_ptr<Object> scatter(std::shared_ptr<Object> blueprint, const Scatter& settings);
+    std::vector<DrawItem> drawList; // rebuilt every frame in render()
+    std::vector<unsigned int> drawOrder; // drawList indices in the order the camera passes draw them
+    unsigned long long drawListFrame = 0; // bumped per rebuild, prefab draw lists refresh with it
     std::vector<std::shared_ptr<Window>> windowUIs;
 
     std::vector<std::shared_ptr<Shader>> shaders;
+    std::vector<std::shared_ptr<Shader>> computeShaders; // GL 4.3 only
     std::vector<std::shared_ptr<Texture>> textures;
     std::vector<std::shared_ptr<Mesh>> meshes;
     std::vector<std::shared_ptr<Object>> blueprints;
@@ -61,12 +168,83 @@ public:
 
     GLFWwindow* window;
 
+    // forward shades every fragment drawn (overdraw pays for lighting),
+    // deferred writes materials to the g-buffer and lights each pixel once
+    enum RenderPath {
+        FORWARD,
+        DEFERRED
+    };
+    RenderPath renderPath = FORWARD;
+
+    // which pass renderers are drawing for, lets them pick a shader variant
+    enum Pass {
+        FORWARD_PASS,
+        GBUFFER_PASS,   // shaders with a gbuffer_ variant
+        FALLBACK_PASS   // forward pass for shaders without one (deferred only)
+    };
+    Pass currentPass = FORWARD_PASS;
+
+    // forward path overdraw. with the pre-pass everything whose vertex
+    // shader puts it where the depth shader does is drawn depth only first,
+    // then shaded with GL_EQUAL so each pixel is lit once. sorting nearest
+    // first lets the depth test throw out more without it
+    bool depthPrepass = false;
+    bool sortFrontToBack = true;
+    // debug, every shaded fragment adds to the pixel instead of lighting it
+    bool overdrawView = false;
+
+    // shader keyword variants (see Shader::Feature). every visible draw
+    // works out the features it needs and renderers draw with the variant
+    // of their shader built for them, compiled the first time it's used.
+    // currentFeatures is the draw being rendered's, like currentPass
+    bool shaderVariants = true;
+    unsigned int currentFeatures = Shader::ALL_FEATURES;
+    std::shared_ptr<Shader> shaderVariant(std::shared_ptr<Shader> shader, unsigned int features);
+    unsigned int variantCount = 0; // built so far
+
     bool vsync = true;
     glm::vec3 ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
     float ambientIntensity = 0.0f;
-    double dTime = 0.0;
+
+    // fixed timestep simulation. update() runs scripts in ticks of
+    // 1 / tickRate seconds (at most maxTicksPerFrame a frame) and renders
+    // transforms interpolated between the last two ticks
+    double tickRate = 60.0;
+    int maxTicksPerFrame = 5;
+    double accumulator = 0.0;
+    double lastTime = -1.0;
+    float interpolation = 0.0f; // 0 = previous tick, 1 = latest tick
+    double dTime = 0.0; // tick length while scripts run
+    double time = 0.0;  // simulation time, the same for every script in a tick
+    unsigned long long tickIndex = 0;
+    bool inputThisTick = false; // mouse moved/pressed/released or scrolled, for Script::runOnInput
+    void tick(double step);
+    void simulate(double seconds); // ticks back to back, no clock or rendering
+    void updateWorldMatrices(); // Transform::worldMatrix for everything, at the current interpolation
+    void savePreviousTransforms();
+    void gatherLights(); // dirLight, lights and pointLightData
+    void collectDrawList(); // drawList, everything with a renderer
+
+    // world matrix levels for the ecs path, see buildTransformLevels
+    struct TransformLink {
+        TransformData* transform;
+        TransformData* parent;  // null for roots
+        bool parentObject;      // root, but under an object without a transform
+    };
+    std::vector<std::vector<TransformLink>> transformLevels;
+    std::vector<World::ChunkRef> transformChunks;
+    unsigned long long transformVersion = ~0ull;
+    void buildTransformLevels();
+
+    // run independent scripts in parallel batches (see Script::access)
+    bool parallelScripts = true;
+    void updateScripts();
+    std::map<std::string, ScriptStats> scriptStats; // by script name
+    void publishScriptStats();
 
     // scroll values because glfw handles scroll with callbacks
     float scrollX = 0.0f;
     float scrollY = 0.0f;
+    double lastCursorX = 0.0, lastCursorY = 0.0;
+    int lastMouseButtons = 0;
 };
\ No newline at end of file
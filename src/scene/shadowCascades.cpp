@@ -0,0 +1,230 @@
+#include "shadowCascades.h"
+
+#include <scene/scene.h>
+#include <scene/object/components/camera.h>
+#include <scene/object/components/renderer/renderer.h>
+#include <util/shader.h>
+#include <util/texture.h>
+#include <util/profiler.h>
+#include <util/geometryArena.h>
+
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// texture unit the cascade array is bound to (same as the old single map)
+static const GLint SHADOW_SLOT = 2;
+
+ShadowCascades::ShadowCascades(unsigned int resolution)
+    : resolution(resolution)
+{
+    buffer = std::shared_ptr<FBO>(new FBO(resolution, resolution, GL_DEPTH_ATTACHMENT, MAX_CASCADES));
+    staticBuffer = std::shared_ptr<FBO>(new FBO(resolution, resolution, GL_DEPTH_ATTACHMENT, MAX_CASCADES));
+    for (unsigned int i = 0; i < MAX_CASCADES; ++i)
+    {
+        viewProjection[i] = glm::mat4(1.0f);
+        splits[i] = 0.0f;
+        texelSize[i] = 0.0f;
+        casterCount[i] = 0;
+    }
+}
+
+// fnv-1a over the static casters' renderers, transforms and bounds,
+// cheap enough to do every frame and catches any edit to them
+static uint64_t signature(const std::vector<DrawItem>& drawList)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    };
+    for (auto& item : drawList)
+        if (item.isStatic)
+        {
+            mix(&item.renderer, sizeof(item.renderer));
+            mix(&item.model, sizeof(item.model));
+            mix(&item.bounds, sizeof(item.bounds));
+        }
+    return hash;
+}
+
+void ShadowCascades::update(std::shared_ptr<Camera> camera, glm::vec3 lightDirection, const std::vector<DrawItem>& drawList)
+{
+    cascadeCount = glm::clamp(cascadeCount, 1u, MAX_CASCADES);
+
+    // split distances, a blend of uniform and logarithmic
+    // (log gives the near cascades most of the resolution)
+    float near = camera->near, far = camera->far;
+    for (unsigned int i = 0; i < cascadeCount; ++i)
+    {
+        float t = (float)(i + 1) / cascadeCount;
+        float logSplit = near * std::pow(far / near, t);
+        float uniformSplit = near + (far - near) * t;
+        splits[i] = splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+    }
+
+    // a static caster was added, removed or edited, start over
+    uint64_t newSignature = signature(drawList);
+    if (newSignature != staticSignature || !cacheStatic)
+        for (auto& fit : fits)
+            fit.valid = false;
+    staticSignature = newSignature;
+
+    glm::vec3 dir = glm::normalize(lightDirection);
+    float refitCos = std::cos(glm::radians(refitAngle));
+
+    glm::mat4 inverseView = glm::inverse(camera->getView());
+    float aspect = (float)camera->width / camera->height;
+    float tanY = std::tan(glm::radians(camera->FOV) * 0.5f);
+    float tanX = tanY * aspect;
+    float sliceNear = near;
+    for (unsigned int c = 0; c < cascadeCount; ++c)
+    {
+        float sliceFar = splits[c];
+
+        // bounding sphere of the frustum slice, its size doesn't depend on
+        // the camera rotation so the map scale stays fixed while looking around
+        glm::vec3 corners[8];
+        for (int i = 0; i < 8; ++i)
+        {
+            float d = (i & 4) ? sliceFar : sliceNear;
+            glm::vec3 viewCorner((i & 1 ? 1.0f : -1.0f) * tanX * d, (i & 2 ? 1.0f : -1.0f) * tanY * d, -d);
+            corners[i] = glm::vec3(inverseView * glm::vec4(viewCorner, 1.0f));
+        }
+        glm::vec3 centre(0.0f);
+        for (int i = 0; i < 8; ++i)
+            centre += corners[i] / 8.0f;
+        float radius = 0.0f;
+        for (int i = 0; i < 8; ++i)
+            radius = std::max(radius, glm::length(corners[i] - centre));
+
+        // keep the old fit while the slice is still inside it and the sun
+        // hasn't moved too far
+        Fit& fit = fits[c];
+        if (!fit.valid || fit.near != sliceNear || fit.far != sliceFar
+            || glm::dot(fit.direction, dir) < refitCos
+            || glm::length(centre - fit.centre) + radius > fit.radius)
+        {
+            fit.near = sliceNear;
+            fit.far = sliceFar;
+            refit(c, dir, centre, cacheStatic ? radius * fitPadding : radius, drawList);
+        }
+
+        // dynamic casters move, cull them against the fit every frame
+        // (without caching everything was drawn as static in the refit)
+        dynamicCasters[c].clear();
+        for (size_t i = 0; i < drawList.size() && cacheStatic; ++i)
+        {
+            // indirect ones are culled on the gpu
+            if (drawList[i].isStatic || drawList[i].indirect)
+                continue;
+            AABB b = drawList[i].bounds.transformed(fit.lightView);
+            if (b.valid() && (b.max.x < fit.lightBox.min.x || b.min.x > fit.lightBox.max.x
+                || b.max.y < fit.lightBox.min.y || b.min.y > fit.lightBox.max.y
+                || b.max.z < fit.lightBox.min.z))
+                continue;
+            dynamicCasters[c].push_back(i);
+        }
+        casterCount[c] = staticCasters[c].size() + dynamicCasters[c].size();
+        sliceNear = sliceFar;
+    }
+}
+
+void ShadowCascades::refit(unsigned int c, glm::vec3 direction, glm::vec3 centre, float radius, const std::vector<DrawItem>& drawList)
+{
+    Fit& fit = fits[c];
+    fit.valid = true;
+    fit.redrawStatic = true;
+    fit.direction = direction;
+    fit.centre = centre;
+    fit.radius = std::ceil(radius * 16.0f) / 16.0f; // keep float noise from changing the size
+    refits++;
+
+    // light view, rotation only. pick an up vector that isn't parallel
+    // to the light when the sun is straight up or down
+    glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    fit.lightView = glm::lookAt(glm::vec3(0.0f), direction, up);
+
+    // snap the centre to whole texels in light space
+    float texel = 2.0f * fit.radius / resolution;
+    glm::vec3 lightCentre = glm::vec3(fit.lightView * glm::vec4(centre, 1.0f));
+    lightCentre.x = std::floor(lightCentre.x / texel) * texel;
+    lightCentre.y = std::floor(lightCentre.y / texel) * texel;
+
+    // receivers are inside the sphere, casters can be anywhere between
+    // it and the light (+z in light space). cull the static casters on the
+    // xy box and grow the depth range to fit the ones that survive, dynamic
+    // casters closer to the light than that get clamped (GL_DEPTH_CLAMP)
+    AABB box(lightCentre - glm::vec3(fit.radius), lightCentre + glm::vec3(fit.radius));
+    float maxZ = box.max.z;
+    staticCasters[c].clear();
+    for (size_t i = 0; i < drawList.size(); ++i)
+    {
+        if (!drawList[i].isStatic && cacheStatic)
+            continue;
+        AABB b = drawList[i].bounds.transformed(fit.lightView);
+        if (b.valid() && (b.max.x < box.min.x || b.min.x > box.max.x
+            || b.max.y < box.min.y || b.min.y > box.max.y
+            || b.max.z < box.min.z))
+            continue;
+        if (b.valid())
+            maxZ = std::max(maxZ, b.max.z);
+        staticCasters[c].push_back(i);
+    }
+    box.max.z = maxZ;
+    fit.lightBox = box;
+
+    glm::mat4 projection = glm::ortho(box.min.x, box.max.x, box.min.y, box.max.y, -box.max.z, -box.min.z);
+    viewProjection[c] = projection * fit.lightView;
+    texelSize[c] = texel;
+}
+
+void ShadowCascades::render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> depthShader, const std::vector<DrawItem>& drawList)
+{
+    drawCalls = 0;
+    glViewport(0, 0, resolution, resolution);
+    glEnable(GL_DEPTH_CLAMP);
+    depthShader->activate();
+    for (unsigned int c = 0; c < cascadeCount; ++c)
+    {
+        glUniformMatrix4fv(glGetUniformLocation(depthShader->id, "lightViewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection[c]));
+
+        // redraw the static casters if the fit changed
+        if (fits[c].redrawStatic)
+        {
+            staticBuffer->bindLayer(c);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            for (auto i : staticCasters[c])
+                drawList[i].renderer->render(s, drawList[i].model, depthShader);
+            drawCalls += staticCasters[c].size();
+            fits[c].redrawStatic = false;
+        }
+
+        // start from the cached static depth, then add the dynamic casters
+        staticBuffer->bindLayer(c, GL_READ_FRAMEBUFFER);
+        buffer->bindLayer(c, GL_DRAW_FRAMEBUFFER);
+        glBlitFramebuffer(0, 0, resolution, resolution, 0, 0, resolution, resolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        buffer->bindLayer(c);
+        for (auto i : dynamicCasters[c])
+            drawList[i].renderer->render(s, drawList[i].model, depthShader);
+        drawCalls += dynamicCasters[c].size();
+        s->indirectDraws->drawShadow(c, depthShader, viewProjection[c]);
+    }
+    glDisable(GL_DEPTH_CLAMP);
+    GeometryArena::unbind();
+    buffer->unbind();
+    Profiler::get().count("shadow draw calls", drawCalls);
+}
+
+void ShadowCascades::setUniforms(std::shared_ptr<Shader> shader)
+{
+    buffer->texture->bind(GL_TEXTURE0 + SHADOW_SLOT);
+    glUniform1i(glGetUniformLocation(shader->id, "sunShadow"), SHADOW_SLOT);
+    glUniformMatrix4fv(glGetUniformLocation(shader->id, "sunViewProjection"), cascadeCount, GL_FALSE, glm::value_ptr(viewProjection[0]));
+    glUniform4fv(glGetUniformLocation(shader->id, "cascadeSplits"), 1, splits);
+    glUniform4fv(glGetUniformLocation(shader->id, "cascadeTexelSize"), 1, texelSize);
+    glUniform1i(glGetUniformLocation(shader->id, "cascadeCount"), cascadeCount);
+}
\ No newline at end of file
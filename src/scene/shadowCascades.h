@@ -0,0 +1,75 @@
+#pragma once
+
+#include <scene/drawItem.h>
+#include <util/fbo.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class Scene;
+class Camera;
+class Shader;
+
+// cascaded shadow maps for the sun
+// the camera frustum (near to far) is split into up to MAX_CASCADES slices,
+// each slice gets its own orthographic shadow map fitted around it, stored
+// as layers of one depth texture array. the fit is a bounding sphere so it
+// doesn't change size when the camera turns, and it moves in whole texels
+// so edges don't shimmer when the camera moves
+//
+// static casters are cached: each cascade keeps its fit until the camera
+// leaves the (padded) sphere or the sun turns more than refitAngle, and only
+// then redraws the static casters into a second texture array. every frame
+// the cached depth is copied over and only the dynamic casters are drawn
+class ShadowCascades {
+public:
+    ShadowCascades(unsigned int resolution = 2048);
+
+    static const unsigned int MAX_CASCADES = 4;
+    unsigned int cascadeCount = 4;
+    float splitLambda = 0.75f; // 0 = uniform splits, 1 = logarithmic
+    bool cacheStatic = true;
+    float refitAngle = 2.0f;   // degrees the sun can turn before the cascades are refitted
+    float fitPadding = 1.25f;  // cascade sphere scale, room for the camera to move before a refit
+
+    // fit the cascades to the camera and find the casters for each
+    void update(std::shared_ptr<Camera> camera, glm::vec3 lightDirection, const std::vector<DrawItem>& drawList);
+    // render the casters into each cascade's layer
+    void render(std::shared_ptr<Scene> s, std::shared_ptr<Shader> depthShader, const std::vector<DrawItem>& drawList);
+    void setUniforms(std::shared_ptr<Shader> shader);
+
+    std::shared_ptr<FBO> buffer;
+    const unsigned int resolution;
+
+    // per cascade, also shown in the overview
+    glm::mat4 viewProjection[MAX_CASCADES];
+    float splits[MAX_CASCADES];    // far distance of each cascade from the camera
+    float texelSize[MAX_CASCADES]; // world units covered by one shadow map texel
+    unsigned int casterCount[MAX_CASCADES];
+
+    // stats
+    unsigned int drawCalls = 0; // last frame
+    unsigned int refits = 0;    // since startup
+
+private:
+    struct Fit {
+        bool valid = false;
+        float near = 0.0f, far = 0.0f; // slice it was fitted for
+        glm::vec3 direction;
+        glm::vec3 centre;
+        float radius = 0.0f;
+        glm::mat4 lightView;
+        AABB lightBox;
+        bool redrawStatic = false;
+    };
+    Fit fits[MAX_CASCADES];
+    void refit(unsigned int c, glm::vec3 direction, glm::vec3 centre, float radius, const std::vector<DrawItem>& drawList);
+
+    std::shared_ptr<FBO> staticBuffer; // cached static caster depth
+    uint64_t staticSignature = 0;      // changes when any static caster changes
+    std::vector<unsigned int> staticCasters[MAX_CASCADES]; // indices into the draw list, valid on redraw frames
+    std::vector<unsigned int> dynamicCasters[MAX_CASCADES];
+};
\ No newline at end of file
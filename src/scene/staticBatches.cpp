@@ -0,0 +1,130 @@
+#include "staticBatches.h"
+
+#include <scene/scene.h>
+#include <scene/object/components/renderer/batchRenderer.h>
+
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <chrono>
+#include <map>
+#include <tuple>
+
+void StaticBatches::clear()
+{
+    if (scene)
+    {
+        // un-flag whatever we merged (everything still around)
+        scene->world.each<RendererSet>([](size_t n, Entity*, RendererSet* r) {
+            for (size_t i = 0; i < n; ++i)
+                for (unsigned int j = 0; j < r[i].count; ++j)
+                    r[i].at(j)->batched = false;
+        });
+    }
+    batches.clear();
+    holders.clear();
+    scene = nullptr;
+    batchCount = 0;
+    sourceCount = 0;
+    vertexCount = 0;
+}
+
+void StaticBatches::build(Scene* s)
+{
+    auto start = std::chrono::steady_clock::now();
+    clear();
+    scene = s;
+    dirty = false;
+
+    // everything that would be drawn, unbatched
+    bool enabled = s->staticBatching;
+    s->staticBatching = false;
+    s->updateWorldMatrices();
+    s->collectDrawList();
+    s->staticBatching = enabled;
+
+    // static renderers by material, then by grid cell
+    struct Source {
+        const DrawItem* item;
+        const void* geometry;
+    };
+    typedef std::pair<BatchMaterial, std::tuple<int, int, int>> Key;
+    std::map<Key, std::vector<Source>> groups;
+    for (auto& item : s->drawList)
+    {
+        if (!item.isStatic || !item.bounds.valid())
+            continue;
+        // prefab instances draw their blueprint's renderers, those are
+        // shared and can't be flagged for one instance
+        if (!s->world.has<InScene>(item.renderer->getObject()->getEntity()))
+            continue;
+        BatchMaterial material;
+        const void* geometry = nullptr;
+        if (!item.renderer->batchSource(material, geometry) || !material.shader || !material.shader->batchable)
+            continue;
+        glm::ivec3 cell = glm::ivec3(glm::floor(item.bounds.center() / cellSize));
+        groups[Key(material, std::make_tuple(cell.x, cell.y, cell.z))].push_back({ &item, geometry });
+    }
+
+    // read back each piece of geometry once
+    struct Geometry {
+        std::vector<GLfloat> vertices;
+        std::vector<GLuint> indices;
+    };
+    std::map<const void*, Geometry> geometries;
+    std::vector<GLfloat> vertices;
+    std::vector<GLuint> indices;
+    for (auto& group : groups)
+    {
+        if (group.second.size() < minSources)
+            continue;
+
+        vertices.clear();
+        indices.clear();
+        AABB bounds;
+        for (auto& source : group.second)
+        {
+            auto found = geometries.find(source.geometry);
+            if (found == geometries.end())
+            {
+                found = geometries.insert(std::make_pair(source.geometry, Geometry())).first;
+                source.item->renderer->readGeometry(found->second.vertices, found->second.indices);
+            }
+            const Geometry& g = found->second;
+
+            // into world space, normals with the inverse transpose
+            const glm::mat4& model = source.item->model;
+            glm::mat3 normalMat = glm::inverseTranspose(glm::mat3(model));
+            GLuint base = vertices.size() / 8;
+            for (size_t v = 0; v + 7 < g.vertices.size(); v += 8)
+            {
+                glm::vec3 p = glm::vec3(model * glm::vec4(g.vertices[v], g.vertices[v + 1], g.vertices[v + 2], 1.0f));
+                glm::vec3 n = glm::normalize(normalMat * glm::vec3(g.vertices[v + 3], g.vertices[v + 4], g.vertices[v + 5]));
+                vertices.insert(vertices.end(), { p.x, p.y, p.z, n.x, n.y, n.z, g.vertices[v + 6], g.vertices[v + 7] });
+            }
+            for (GLuint index : g.indices)
+                indices.push_back(base + index);
+            bounds.expand(source.item->bounds);
+            source.item->renderer->batched = true;
+        }
+        if (indices.empty())
+            continue;
+
+        std::shared_ptr<Object> holder = makePooled<Object>(s->shared_from_this());
+        holder->setName("Static Batch");
+        std::shared_ptr<BatchRenderer> batch = makePooled<BatchRenderer>(holder, group.first.first, vertices, indices, bounds, group.second.size());
+        holder->components.push_back(batch);
+        holders.push_back(holder);
+        batches.push_back(batch.get());
+        batchCount++;
+        sourceCount += group.second.size();
+        vertexCount += batch->vertexCount;
+    }
+    s->drawList.clear();
+    buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void StaticBatches::appendDraws(std::vector<DrawItem>& drawList)
+{
+    for (auto batch : batches)
+        drawList.push_back(DrawItem(batch, glm::mat4(1.0f), batch->localBounds(), true));
+}
\ No newline at end of file
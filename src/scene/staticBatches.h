@@ -0,0 +1,45 @@
+#pragma once
+
+#include <scene/drawItem.h>
+
+#include <vector>
+#include <memory>
+
+class Scene;
+class Object;
+class BatchRenderer;
+
+// static geometry batching
+// static renderers that share a shader and material are merged into big
+// pre-transformed vertex/index buffers, one per cell of a world space grid
+// so the batches still frustum cull. the merged renderers are flagged
+// (Renderer::batched) and left out of the draw list, the batches go in
+// instead. built on the first frame after a scene load, when a batched
+// renderer goes away, and on demand from the overview. moving a static
+// object needs a rebuild to show
+class StaticBatches {
+public:
+    // from the static part of the scene as it is now (needs a gl context)
+    void build(Scene* s);
+    // back to drawing every renderer on its own. the scene calls this
+    // before it goes, the batches' objects need it
+    void clear();
+    // the batches, drawn with an identity model matrix
+    void appendDraws(std::vector<DrawItem>& drawList);
+
+    float cellSize = 32.0f; // world units
+    unsigned int minSources = 2; // a cell needs at least this many renderers to merge
+    bool dirty = false; // rebuild before the next frame
+
+    // stats for the overview
+    unsigned int batchCount = 0;
+    unsigned int sourceCount = 0; // renderers merged into the batches
+    size_t vertexCount = 0;
+    double buildMs = 0.0;
+
+private:
+    // batches need an object to belong to, these are never in the scene
+    std::vector<std::shared_ptr<Object>> holders;
+    std::vector<BatchRenderer*> batches;
+    Scene* scene = nullptr;
+};
\ No newline at end of file
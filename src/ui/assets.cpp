@@ -5,6 +5,8 @@
 #include <scene/scene.h>
 #include <scene/object/components/renderer/meshRenderer.h>
 
+#include <algorithm>
+
 void Assets::render() {
     ImGui::Begin("Assets");
 
@@ -89,8 +91,48 @@ void Assets::render() {
                 ImGui::Text(blueprint->getName().c_str());
                 if(ImGui::SmallButton("Instantiate"))
                 {
-                    auto clone = blueprint->clone();
-                    clone->reparent(nullptr); // reparent to scene
+                    auto instance = blueprint->instantiate();
+                    instance->reparent(nullptr); // reparent to scene
+                }
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Scatter"))
+                    ImGui::OpenPopup("scatter");
+                if (ImGui::BeginPopup("scatter"))
+                {
+                    // lots of instances at once, see Scene::scatter
+                    Scene::Scatter& settings = scatterSettings;
+                    int count = settings.count, seed = settings.seed;
+                    if (ImGui::DragInt("Count", &count, 10.0f, 1, 1000000))
+                        settings.count = std::max(count, 1);
+                    if (ImGui::InputInt("Seed", &seed))
+                        settings.seed = seed;
+                    ImGui::DragFloat2("Yaw", &settings.yaw.x, 1.0f, -360.0f, 360.0f);
+                    ImGui::DragFloat2("Scale", &settings.scale.x, 0.01f, 0.01f, 100.0f);
+
+                    std::shared_ptr<Object> surface = scene->find(settings.surface);
+                    if (!surface)
+                    {
+                        settings.surface = ObjectHandle();
+                        ImGui::DragFloat3("Center", &settings.center.x, 0.1f);
+                        ImGui::DragFloat2("Size", &settings.size.x, 0.1f, 0.0f);
+                    }
+                    ImGui::Button(surface ? std::string("Surface: " + surface->getName()).c_str() : "Drop Surface Object Here");
+                    if (ImGui::BeginDragDropTarget())
+                        if (const ImGuiPayload* p = ImGui::AcceptDragDropPayload("HIERARCHY_OBJECT"))
+                            settings.surface = *(ObjectHandle*)p->Data;
+                    if (surface)
+                    {
+                        ImGui::SameLine();
+                        if (ImGui::SmallButton("Clear"))
+                            settings.surface = ObjectHandle();
+                    }
+
+                    if (ImGui::Button("Place"))
+                    {
+                        scene->scatter(blueprint, settings);
+                        ImGui::CloseCurrentPopup();
+                    }
+                    ImGui::EndPopup();
                 }
 
                 ImGui::PopID();
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <ui/window.h>
+#include <scene/scene.h>
 
 class Assets : public Window {
 public:
     Assets(std::shared_ptr<Scene> s) : Window(s) {}
     void render() override;
+
+private:
+    Scene::Scatter scatterSettings; // kept between uses of the scatter tool
 };
\ No newline at end of file
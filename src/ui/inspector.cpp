@@ -19,6 +19,9 @@ void Inspector::render() {
     strcpy(name, scene->inspectedObject->getName().c_str());
     if (ImGui::InputText("Object Name", name, 128))
         scene->inspectedObject->setName(std::string(name));
+    ImGui::Checkbox("Static", &scene->inspectedObject->isStatic);
+    if (scene->inspectedObject->getPrefab())
+        ImGui::Text(std::string("Instance of " + scene->inspectedObject->getPrefab()->getName()).c_str());
 
     std::shared_ptr<Transform> transform = nullptr;
     for (auto component : scene->inspectedObject->components)
@@ -27,7 +30,7 @@ void Inspector::render() {
             transform = std::dynamic_pointer_cast<Transform>(component);
             break;
         }
-    if (transform != nullptr && transform->scale.x > 0 && transform->scale.y > 0 && transform->scale.z > 0)
+    if (transform != nullptr && transform->scale().x > 0 && transform->scale().y > 0 && transform->scale().z > 0)
     {
         if (!currentGizmoOperation) currentGizmoOperation = ImGuizmo::TRANSLATE;
         if (ImGui::RadioButton("Translate", currentGizmoOperation == ImGuizmo::TRANSLATE))
@@ -51,7 +54,7 @@ void Inspector::render() {
                     view = view * std::dynamic_pointer_cast<Transform>(component)->modelMatrix();
                     break;
                 }
-        ImGuizmo::Manipulate(
+        bool moved = ImGuizmo::Manipulate(
             glm::value_ptr(view),
             glm::value_ptr(scene->activeCamera->getPerspective()),
             (ImGuizmo::OPERATION)currentGizmoOperation,
@@ -59,18 +62,23 @@ void Inspector::render() {
             glm::value_ptr(modmat)
         );
 
-        glm::vec3 t;
-        glm::quat r;
-        glm::vec3 s;
-        glm::vec3 skew;
-        glm::vec4 pers;
-        glm::decompose(modmat, s, r, t, skew, pers);
-        transform->position = t;
-        transform->rotation = glm::degrees(glm::eulerAngles(r));
-        transform->scale = s;
-        transform->scale.x = std::max(transform->scale.x, 0.01f);
-        transform->scale.y = std::max(transform->scale.y, 0.01f);
-        transform->scale.z = std::max(transform->scale.z, 0.01f);
+        // only write back when the gizmo moved it, decomposing every frame
+        // jitters the transform (and would invalidate cached static shadows)
+        if (moved)
+        {
+            glm::vec3 t;
+            glm::quat r;
+            glm::vec3 s;
+            glm::vec3 skew;
+            glm::vec4 pers;
+            glm::decompose(modmat, s, r, t, skew, pers);
+            transform->position() = t;
+            transform->rotation() = glm::degrees(glm::eulerAngles(r));
+            transform->scale() = s;
+            transform->scale().x = std::max(transform->scale().x, 0.01f);
+            transform->scale().y = std::max(transform->scale().y, 0.01f);
+            transform->scale().z = std::max(transform->scale().z, 0.01f);
+        }
     }
 
     ImGui::Separator();
@@ -91,7 +99,10 @@ void Inspector::render() {
         if (ImGui::Button("Delete"))
             script->remove();
         else
+        {
             script->renderInspector();
+            script->wake(); // settings might have changed
+        }
         ImGui::PopID();
     }
 
@@ -5,66 +5,244 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
-void renderObjectNode(std::shared_ptr<Object> o, Scene* s)
+#include <algorithm>
+#include <cctype>
+
+static std::string lowercase(const std::string& s)
 {
-    ImGui::PushID(o.get());
-    if (s->inspectedObject == o)
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 0, 0, 1));
-    bool expanded = ImGui::TreeNode(o->getName().c_str());
-    if (s->inspectedObject == o)
-        ImGui::PopStyleColor();
+    std::string lower(s);
+    for (auto& c : lower)
+        c = std::tolower((unsigned char)c);
+    return lower;
+}
 
-    if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None))
+void ObjectHierarchy::addRows(Object* o, int depth, int parent)
+{
+    std::shared_ptr<Object> prefab = o->getPrefab();
+    int index = rows.size();
+    rows.push_back({ o->getHandle(), nullptr, parent, depth, !o->children.empty() || (prefab && !prefab->children.empty()) });
+    if (!expanded.count(NodeKey(o->getHandle(), ObjectHandle())))
+        return;
+    for (auto child : o->children)
+        addRows(child.get(), depth + 1, index);
+    for (auto source : o->prefabChildren())
+        addPrefabRows(o, source.get(), depth + 1, index);
+}
+
+void ObjectHierarchy::addPrefabRows(Object* instance, Object* source, int depth, int parent)
+{
+    int index = rows.size();
+    rows.push_back({ instance->getHandle(), source, parent, depth, !source->children.empty() });
+    if (!expanded.count(NodeKey(instance->getHandle(), source->getHandle())))
+        return;
+    for (auto child : source->children)
+        addPrefabRows(instance, child.get(), depth + 1, index);
+}
+
+void ObjectHierarchy::buildIndex()
+{
+    nameIndex.clear();
+    std::vector<Object*> stack;
+    for (auto root : scene->objects)
+        stack.push_back(root.get());
+    while (!stack.empty())
     {
-        Object* ptr = o.get();
-        ImGui::SetDragDropPayload("HIERARCHY_OBJECT", &ptr, sizeof(Object*)); // this is a little dirty i know
-        ImGui::Text(o->getName().c_str());
-        ImGui::EndDragDropSource();
-    }
+        Object* o = stack.back();
+        stack.pop_back();
+        for (auto child : o->children)
+            stack.push_back(child.get());
 
-    if (ImGui::BeginDragDropTarget())
-        if (const ImGuiPayload* p = ImGui::AcceptDragDropPayload("HIERARCHY_OBJECT"))
+        std::string name = lowercase(o->getName());
+        nameIndex.push_back({ name, o->getHandle() });
+        size_t start = 0;
+        while (start < name.size())
         {
-            (*((Object**)p->Data))->reparent(o);
+            // words are split on anything that isn't a letter or digit
+            while (start < name.size() && !std::isalnum((unsigned char)name[start]))
+                start++;
+            size_t end = start;
+            while (end < name.size() && std::isalnum((unsigned char)name[end]))
+                end++;
+            if (end > start && (start > 0 || end < name.size()))
+                nameIndex.push_back({ name.substr(start, end - start), o->getHandle() });
+            start = end;
         }
+    }
+    std::sort(nameIndex.begin(), nameIndex.end(), [](const std::pair<std::string, ObjectHandle>& a, const std::pair<std::string, ObjectHandle>& b) {
+        return a.first < b.first;
+    });
+    indexVersion = scene->hierarchyVersion;
+}
 
-    ImGui::SameLine();
-    if (ImGui::SmallButton(std::string("Inspect##" + o->getName()).c_str()))
-        s->inspectedObject = o;
-    ImGui::SameLine();
-    if (ImGui::SmallButton(std::string("Clone##" + o->getName()).c_str()))
-        s->objects.push_back(o->clone());
-    ImGui::SameLine();
-    if (ImGui::SmallButton(std::string("Delete##" + o->getName()).c_str()))
+void ObjectHierarchy::pruneExpanded()
+{
+    for (auto it = expanded.begin(); it != expanded.end();)
+        if (!scene->find(it->object) || (it->source.valid() && !scene->find(it->source)))
+            it = expanded.erase(it);
+        else
+            ++it;
+}
+
+void ObjectHierarchy::rebuild()
+{
+    if (builtVersion != scene->hierarchyVersion)
+        pruneExpanded();
+    rows.clear();
+    if (query.empty())
     {
-        o->remove();
-        ImGui::PopID();
-        if (expanded) ImGui::TreePop();
+        for (auto root : scene->objects)
+            addRows(root.get(), 0, -1);
+    }
+    else
+    {
+        // flat list of matches, each object once
+        if (indexVersion != scene->hierarchyVersion)
+            buildIndex();
+        std::vector<ObjectHandle> matches;
+        auto it = std::lower_bound(nameIndex.begin(), nameIndex.end(), query, [](const std::pair<std::string, ObjectHandle>& entry, const std::string& q) {
+            return entry.first < q;
+        });
+        for (; it != nameIndex.end() && it->first.compare(0, query.size(), query) == 0; ++it)
+            matches.push_back(it->second);
+        std::sort(matches.begin(), matches.end(), [](const ObjectHandle& a, const ObjectHandle& b) { return a.index < b.index; });
+        matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+        for (auto handle : matches)
+            rows.push_back({ handle, nullptr, -1, 0, false });
+    }
+    builtVersion = scene->hierarchyVersion;
+    dirty = false;
+}
+
+void ObjectHierarchy::renderRow(int index)
+{
+    const Row& row = rows[index];
+    std::shared_ptr<Object> o = scene->find(row.handle);
+    if (!o)
+    {
+        // went this frame, the list is rebuilt next frame
+        ImGui::TextDisabled("...");
         return;
     }
 
-    ImGui::PopID();
-    if (expanded) {
-        for (auto child : o->children)
-            if (child)
-                renderObjectNode(child, s);
-        ImGui::TreePop();
+    ImGui::PushID(index);
+    float indent = row.depth * ImGui::GetStyle().IndentSpacing;
+    if (indent > 0.0f)
+        ImGui::Indent(indent);
+
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_OpenOnArrow;
+    if (!row.hasChildren)
+        flags |= ImGuiTreeNodeFlags_Leaf;
+    NodeKey key(o->getHandle(), row.source ? row.source->getHandle() : ObjectHandle());
+    ImGui::SetNextItemOpen(expanded.count(key) != 0);
+
+    if (row.source)
+    {
+        // part of an instance still drawn from its blueprint. editing it
+        // overrides it (and everything above it on the way down from the
+        // instance) so the blueprint itself is never touched
+        ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyle().Colors[ImGuiCol_TextDisabled]);
+        ImGui::TreeNodeEx("prefab", flags, "%s", row.source->getName().c_str());
+        ImGui::PopStyleColor();
+        if (ImGui::IsItemToggledOpen())
+        {
+            if (!expanded.erase(key))
+                expanded.insert(key);
+            dirty = true;
+        }
+
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Edit"))
+        {
+            std::vector<Object*> path;
+            int r = index;
+            for (; r >= 0 && rows[r].source; r = rows[r].parent)
+                path.push_back(rows[r].source);
+            std::shared_ptr<Object> edited = o;
+            for (auto it = path.rbegin(); it != path.rend() && edited; ++it)
+                edited = edited->overridePrefabChild((*it)->shared_from_this());
+            if (edited)
+                scene->inspectedObject = edited;
+        }
+    }
+    else
+    {
+        if (scene->inspectedObject == o)
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 0, 0, 1));
+        ImGui::TreeNodeEx("object", flags, "%s", o->getName().c_str());
+        if (scene->inspectedObject == o)
+            ImGui::PopStyleColor();
+        if (ImGui::IsItemToggledOpen())
+        {
+            if (!expanded.erase(key))
+                expanded.insert(key);
+            dirty = true;
+        }
+
+        if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None))
+        {
+            ObjectHandle handle = o->getHandle();
+            ImGui::SetDragDropPayload("HIERARCHY_OBJECT", &handle, sizeof(ObjectHandle));
+            ImGui::Text("%s", o->getName().c_str());
+            ImGui::EndDragDropSource();
+        }
+
+        if (ImGui::BeginDragDropTarget())
+            if (const ImGuiPayload* p = ImGui::AcceptDragDropPayload("HIERARCHY_OBJECT"))
+            {
+                std::shared_ptr<Object> dropped = scene->find(*(ObjectHandle*)p->Data);
+                if (dropped)
+                    dropped->reparent(o);
+            }
+
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Inspect"))
+            scene->inspectedObject = o;
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Clone"))
+            scene->addObject(o->clone());
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Delete"))
+            o->remove();
     }
+
+    if (indent > 0.0f)
+        ImGui::Unindent(indent);
+    ImGui::PopID();
 }
 
 void ObjectHierarchy::render() {
     ImGui::Begin("Object Hierarchy");
-    for (auto obj : scene->objects)
-        if (obj)
-            renderObjectNode(obj, scene.get());
 
-    if (ImGui::Button("Create Empty Object###createEmptyObject"))
-        scene->objects.push_back(std::shared_ptr<Object>(new Object(scene)));
-    ImGui::Separator();
+    if (ImGui::InputTextWithHint("##filter", "Filter by name", filter, sizeof(filter)))
+    {
+        query = lowercase(filter);
+        query.erase(0, query.find_first_not_of(' '));
+        dirty = true;
+    }
 
+    if (ImGui::Button("Create Empty Object###createEmptyObject"))
+        scene->addObject(makePooled<Object>(scene->shared_from_this()));
+    ImGui::SameLine();
     ImGui::Text("Drop Here To Unparent");
     if (ImGui::BeginDragDropTarget())
         if (const ImGuiPayload* p = ImGui::AcceptDragDropPayload("HIERARCHY_OBJECT"))
-            (*((Object**)p->Data))->reparent(nullptr);
+        {
+            std::shared_ptr<Object> dropped = scene->find(*(ObjectHandle*)p->Data);
+            if (dropped)
+                dropped->reparent(nullptr);
+        }
+    ImGui::Separator();
+
+    if (dirty || builtVersion != scene->hierarchyVersion)
+        rebuild();
+
+    // only the rows in view
+    ImGui::BeginChild("rows");
+    ImGuiListClipper clipper;
+    clipper.Begin(rows.size());
+    while (clipper.Step())
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+            renderRow(i);
+    ImGui::EndChild();
     ImGui::End();
 }
\ No newline at end of file
@@ -1,9 +1,62 @@
 #pragma once
 
 #include <ui/window.h>
+#include <scene/object/objectHandle.h>
 
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Object;
+
+// the hierarchy is drawn from a flat list of the rows that are showing
+// (expanded parents' children, or the filter's matches), rebuilt only when
+// the scene's hierarchy or what's expanded changes. only the rows on screen
+// are submitted to imgui each frame
 class ObjectHierarchy : public Window {
 public:
     ObjectHierarchy(std::shared_ptr<Scene> s) : Window(s) {}
     void render() override;
+
+private:
+    struct Row {
+        ObjectHandle handle;    // the object, or the instance a prefab row belongs to
+        Object* source;         // blueprint node for parts of an instance still drawn from it, else nullptr
+        int parent;             // row above us in the tree, -1 for roots
+        int depth;
+        bool hasChildren;
+    };
+    std::vector<Row> rows;
+    unsigned long long builtVersion = ~0ull;
+    bool dirty = true;
+    void rebuild();
+    void addRows(Object* o, int depth, int parent);
+    void addPrefabRows(Object* instance, Object* source, int depth, int parent);
+    void renderRow(int index);
+
+    // expanded tree nodes, (object, null handle) for objects and (instance,
+    // blueprint node) for the greyed out parts of instances. handles so an
+    // object reusing a freed one's memory doesn't open expanded, the ones
+    // that stop resolving are dropped on rebuild
+    struct NodeKey {
+        ObjectHandle object, source;
+        NodeKey(ObjectHandle object, ObjectHandle source) : object(object), source(source) {}
+        bool operator < (const NodeKey& other) const
+        {
+            return std::make_pair(std::make_pair(object.index, object.generation), std::make_pair(source.index, source.generation))
+                < std::make_pair(std::make_pair(other.object.index, other.object.generation), std::make_pair(other.source.index, other.source.generation));
+        }
+    };
+    std::set<NodeKey> expanded;
+    void pruneExpanded();
+
+    // name filter. the index has every word of every name (and the whole
+    // name) lowercased and sorted, a query matches names with a word that
+    // starts with it
+    char filter[128] = "";
+    std::string query;
+    std::vector<std::pair<std::string, ObjectHandle>> nameIndex;
+    unsigned long long indexVersion = ~0ull;
+    void buildIndex();
 };
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "overview.h"
 #include <scene/scene.h>
+#include <util/profiler.h>
+#include <util/geometryArena.h>
+#include <util/shaderCache.h>
+#include <util/textureStreamer.h>
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -7,11 +11,139 @@
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+
 void Overview::render() {
     ImGui::Begin("Overview");
 
     ImGui::Text("Performance:");
     ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    ImGui::Text("Point Lights: %u (%u cluster entries, max %u per cluster)",
+        scene->lightClusters->lightCount,
+        scene->lightClusters->indexCount,
+        scene->lightClusters->maxPerCluster
+    );
+
+    if (ImGui::TreeNode("Shadow Cascades"))
+    {
+        auto shadows = scene->sunShadows;
+        for (unsigned int i = 0; i < shadows->cascadeCount; ++i)
+            ImGui::Text("%u: to %.1f, %.3f units/texel, %u casters", i, shadows->splits[i], shadows->texelSize[i], shadows->casterCount[i]);
+        int count = shadows->cascadeCount;
+        if (ImGui::SliderInt("Cascades", &count, 1, ShadowCascades::MAX_CASCADES))
+            shadows->cascadeCount = count;
+        ImGui::SliderFloat("Split Lambda", &shadows->splitLambda, 0.0f, 1.0f);
+        ImGui::Checkbox("Cache Static Casters", &shadows->cacheStatic);
+        ImGui::SliderFloat("Refit Angle", &shadows->refitAngle, 0.0f, 10.0f);
+        ImGui::Text("%u draw calls, %u refits", shadows->drawCalls, shadows->refits);
+        ImGui::TreePop();
+    }
+    if (ImGui::TreeNode("Static Batches"))
+    {
+        auto batches = scene->staticBatches;
+        ImGui::Checkbox("Draw Batches", &scene->staticBatching);
+        ImGui::DragFloat("Cell Size", &batches->cellSize, 1.0f, 1.0f, 1000.0f);
+        if (ImGui::Button("Rebuild"))
+            batches->dirty = true;
+        ImGui::Text("%u batches from %u renderers, %zu vertices, built in %.1f ms",
+            batches->batchCount, batches->sourceCount, batches->vertexCount, batches->buildMs);
+        ImGui::TreePop();
+    }
+    if (ImGui::TreeNode("Occlusion Culling"))
+    {
+        auto occlusion = scene->occlusion;
+        ImGui::Checkbox("Enabled", &occlusion->enabled);
+        ImGui::DragFloat("Occluder Size", &occlusion->occluderSize, 1.0f, 0.0f, 1000.0f);
+        int maxOccluders = occlusion->maxOccluders;
+        if (ImGui::SliderInt("Max Occluders", &maxOccluders, 0, 256))
+            occlusion->maxOccluders = maxOccluders;
+        int resolution[2] = { occlusion->width, occlusion->height };
+        if (ImGui::DragInt2("Resolution", resolution, 1.0f, 16, 1024))
+        {
+            occlusion->width = resolution[0];
+            occlusion->height = resolution[1];
+        }
+        ImGui::Text("%u occluders, %zu triangles, %.2f ms", occlusion->occluderCount, occlusion->triangleCount, occlusion->rasterMs);
+        ImGui::Text("%u of %u tested draws hidden, %.2f ms", occlusion->occludedCount, occlusion->testedCount, occlusion->testMs);
+        ImGui::TreePop();
+    }
+    if (ImGui::TreeNode("Indirect Draws"))
+    {
+        auto indirect = scene->indirectDraws;
+        if (!indirect->supported(scene))
+            ImGui::Text("needs GL 4.3, drawing everything one by one");
+        ImGui::Checkbox("Enabled", &indirect->enabled);
+        ImGui::Text("%u instances in %u groups, %u multi-draws",
+            indirect->instanceCount, indirect->groupCount, indirect->multiDraws);
+        ImGui::TreePop();
+    }
+    if (ImGui::TreeNode("Shader Cache"))
+    {
+        auto& st = ShaderCache::stats;
+        if (!ShaderCache::available)
+            ImGui::Text("no program binaries from this driver, compiling everything");
+        ImGui::Checkbox("Enabled", &ShaderCache::enabled);
+        ImGui::Text("%u hits, %u misses (%u stale, %u rejected), %u stored", st.hits, st.misses, st.stale, st.rejected, st.stored);
+        ImGui::Text("programs built in %.1f ms, %u keyword variants", st.buildMs, scene->variantCount);
+        ImGui::TreePop();
+    }
+    if (ImGui::TreeNode("Hot Reload"))
+    {
+        auto reloader = scene->assetReloader;
+        if (!reloader->running())
+            ImGui::Text("not watching the asset folder");
+        ImGui::Text("%u reloaded, %u failed (old version kept), %u removed", reloader->reloaded, reloader->failed, reloader->removed);
+        if (reloader->waiting())
+            ImGui::Text("%zu removed but still in use", reloader->waiting());
+        for (auto it = reloader->history.rbegin(); it != reloader->history.rend(); ++it)
+            ImGui::Text("%s %s: %.1f ms decode, %.1f ms apply, %.1f ms latency", it->file.c_str(),
+                it->removed ? "removed" : it->ok ? "reloaded" : "FAILED", it->decodeMs, it->applyMs, it->latencyMs);
+        ImGui::TreePop();
+    }
+    if (ImGui::TreeNode("Texture Streaming"))
+    {
+        auto streamer = scene->textureStreamer;
+        if (!TextureStreamer::persistent)
+            ImGui::Text("no buffer storage, upload buffer mapped per frame");
+        int budget = (int)(streamer->bytesPerFrame >> 10);
+        if (ImGui::DragInt("Budget (KB/frame)", &budget, 64.0f, 64, 65536))
+            streamer->bytesPerFrame = (size_t)std::max(budget, 64) << 10;
+        ImGui::Text("%zu queued, %u done, %.1f KB last frame, %.3f ms stalled",
+            streamer->pending(), streamer->completed, streamer->uploadedBytes / 1024.0, streamer->stallMs);
+        ImGui::TreePop();
+    }
+    if (ImGui::TreeNode("Geometry Arenas"))
+    {
+        for (auto arena : GeometryArena::arenas())
+        {
+            GeometryArena::Stats st = arena->stats();
+            ImGui::PushID(arena);
+            ImGui::Text("%s: %zu allocations", arena->name.c_str(), st.allocations);
+            ImGui::Text("  vertices %zu / %zu (%.1f%%), %.1f MB", st.vertexUsed, st.vertexCapacity,
+                100.0 * st.vertexUsed / st.vertexCapacity, st.vertexCapacity * arena->stride / (1024.0 * 1024.0));
+            ImGui::Text("  indices %zu / %zu (%.1f%%), %.1f MB", st.indexUsed, st.indexCapacity,
+                100.0 * st.indexUsed / st.indexCapacity, st.indexCapacity * sizeof(GLuint) / (1024.0 * 1024.0));
+            ImGui::Text("  %zu free blocks, largest %zu vertices / %zu indices", st.freeBlocks, st.largestFreeVertices, st.largestFreeIndices);
+            ImGui::Text("  grown %u times, defragmented %u times", st.grows, st.defrags);
+            if (ImGui::Button("Defragment"))
+                arena->defragment();
+            ImGui::PopID();
+        }
+        ImGui::TreePop();
+    }
+    if (ImGui::TreeNode("Profiler"))
+    {
+        for (auto& it : Profiler::get().stats())
+        {
+            if (it.second.counter)
+                ImGui::Text("%s: %.0f", it.first.c_str(), it.second.count);
+            else if (it.second.gpu)
+                ImGui::Text("%s: %.3f ms cpu, %.3f ms gpu", it.first.c_str(), it.second.cpuMs, it.second.gpuMs);
+            else
+                ImGui::Text("%s: %.3f ms cpu", it.first.c_str(), it.second.cpuMs);
+        }
+        ImGui::TreePop();
+    }
 
     ImGui::Separator();
 
@@ -23,6 +155,25 @@ void Overview::render() {
     ImGui::Text("Settings:");
     if (ImGui::Checkbox("VSync", &(scene->vsync)))  // has vsync changed
         glfwSwapInterval(scene->vsync); // set vsync
+    int renderPath = scene->renderPath;
+    ImGui::Text("Renderer:");
+    ImGui::SameLine();
+    ImGui::RadioButton("Forward", &renderPath, Scene::RenderPath::FORWARD);
+    ImGui::SameLine();
+    ImGui::RadioButton("Deferred", &renderPath, Scene::RenderPath::DEFERRED);
+    scene->renderPath = (Scene::RenderPath)renderPath;
+    ImGui::Checkbox("Depth Pre-Pass", &scene->depthPrepass);
+    ImGui::SameLine();
+    ImGui::Checkbox("Front To Back", &scene->sortFrontToBack);
+    ImGui::Checkbox("Overdraw View", &scene->overdrawView);
+    ImGui::SameLine();
+    ImGui::Checkbox("Shader Variants", &scene->shaderVariants);
+    ImGui::Checkbox("Parallel Scripts", &scene->parallelScripts);
+    ImGui::Checkbox("ECS Systems", &scene->ecsSystems);
+    float tickRate = scene->tickRate;
+    if (ImGui::SliderFloat("Tick Rate", &tickRate, 10.0f, 240.0f, "%.0f Hz"))
+        scene->tickRate = tickRate;
+    ImGui::SliderInt("Max Ticks/Frame", &scene->maxTicksPerFrame, 1, 20);
 
     ImGui::Separator();
     ImGui::ColorEdit3("Ambient Color", glm::value_ptr(scene->ambientColor));
@@ -33,8 +184,8 @@ void Overview::render() {
     if (ImGui::BeginDragDropTarget())
         if (const ImGuiPayload* p = ImGui::AcceptDragDropPayload("HIERARCHY_OBJECT"))
         {
-            Object* obj = (*((Object**)p->Data));
-            auto camera = obj->getComponent<Camera>();
+            std::shared_ptr<Object> obj = scene->find(*(ObjectHandle*)p->Data);
+            auto camera = obj ? obj->getComponent<Camera>() : nullptr;
             if (camera)
                 scene->activeCamera = camera;
         }
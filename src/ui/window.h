@@ -5,9 +5,9 @@
 class Scene;
 class Window {
 public:
-    Window(std::shared_ptr<Scene> s) : scene(s) {}
+    Window(std::shared_ptr<Scene> s) : scene(s.get()) {}
     virtual void render() = 0;
 
 protected:
-    std::shared_ptr<Scene> scene;
+    Scene* scene; // owned by the scene
 };
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <limits>
+
+// axis aligned bounding box, starts out empty (min > max) so
+// expanding it with the first point just takes that point
+struct AABB {
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    AABB() {}
+    AABB(glm::vec3 min, glm::vec3 max) : min(min), max(max) {}
+
+    bool valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+    void expand(glm::vec3 p)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+    void expand(const AABB& other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    bool intersects(const AABB& other) const
+    {
+        return min.x <= other.max.x && max.x >= other.min.x
+            && min.y <= other.max.y && max.y >= other.min.y
+            && min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    // box enclosing this box after transforming it, without transforming
+    // all 8 corners (the extents just go through the absolute matrix)
+    AABB transformed(const glm::mat4& m) const
+    {
+        if (!valid())
+            return *this;
+        glm::vec3 c = glm::vec3(m * glm::vec4(center(), 1.0f));
+        glm::mat3 a = glm::mat3(m);
+        for (int i = 0; i < 3; ++i)
+            a[i] = glm::abs(a[i]);
+        glm::vec3 e = a * extents();
+        return AABB(c - e, c + e);
+    }
+};
\ No newline at end of file
@@ -27,4 +27,14 @@ void EBO::bind()
 void EBO::unbind()
 {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+std::vector<GLuint> EBO::read()
+{
+    std::vector<GLuint> data(size / sizeof(GLuint));
+    glBindBuffer(GL_COPY_READ_BUFFER, id);
+    if (!data.empty())
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, data.size() * sizeof(GLuint), &data[0]);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return data;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <glad/glad.h>
 
 #include <memory>
+#include <vector>
 
 class VAO;
 
@@ -17,4 +18,6 @@ public:
 
     void bind();
     void unbind();
+    // copy of the buffer's contents (stalls, for build steps only)
+    std::vector<GLuint> read();
 };
\ No newline at end of file
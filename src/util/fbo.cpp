@@ -2,10 +2,13 @@
 
 #include <util/texture.h>
 
-FBO::FBO(unsigned int width, unsigned int height, GLenum type)
+#include <iostream>
+
+FBO::FBO(unsigned int width, unsigned int height, GLenum type, unsigned int layers)
     : width(width),
     height(height),
-    attachmentType(type)
+    attachmentType(type),
+    layers(layers)
 {
     // gen FBO
     glGenFramebuffers(1, &id);
@@ -13,16 +16,22 @@ FBO::FBO(unsigned int width, unsigned int height, GLenum type)
     {
     case GL_DEPTH_ATTACHMENT:
     {
-        // generate texture
-        texture = std::shared_ptr<Texture>(new Texture(width, height, GL_DEPTH_COMPONENT));
+        // generate texture, a texture array if layered
+        if (layers)
+            texture = std::shared_ptr<Texture>(new Texture(width, height, layers, GL_DEPTH_COMPONENT));
+        else
+            texture = std::shared_ptr<Texture>(new Texture(width, height, GL_DEPTH_COMPONENT));
         texture->bind(GL_TEXTURE0);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(texture->type, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glTexParameteri(texture->type, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
         texture->unbind();
 
-        // attach to fbo
+        // attach to fbo (first layer, see bindLayer)
         bind();
-        glFramebufferTexture2D(GL_FRAMEBUFFER, type, GL_TEXTURE_2D, texture->ID, 0);
+        if (layers)
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, type, texture->ID, 0, 0);
+        else
+            glFramebufferTexture2D(GL_FRAMEBUFFER, type, GL_TEXTURE_2D, texture->ID, 0);
         // we don't care about colors, just want z-values
         glDrawBuffer(GL_NONE);
         glReadBuffer(GL_NONE);
@@ -31,10 +40,45 @@ FBO::FBO(unsigned int width, unsigned int height, GLenum type)
         break;
     }
     default:
+        std::cout << "WARN::FBO::unsupported attachment type " << type << std::endl;
         break;
-        // TODO: warn here or smth idk
     }
 }
+
+FBO::FBO(unsigned int width, unsigned int height, std::vector<Attachment> colorAttachments, bool depth)
+    : width(width),
+    height(height),
+    attachmentType(GL_COLOR_ATTACHMENT0),
+    layers(0)
+{
+    // gen FBO
+    glGenFramebuffers(1, &id);
+    bind();
+
+    // generate and attach color textures
+    std::vector<GLenum> drawBuffers;
+    for (unsigned int i = 0; i < colorAttachments.size(); ++i)
+    {
+        const Attachment& a = colorAttachments[i];
+        std::shared_ptr<Texture> t(new Texture(width, height, a.internalFormat, a.format, a.pixelType));
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, t->ID, 0);
+        colorTextures.push_back(t);
+        drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+    }
+    if (drawBuffers.size())
+        glDrawBuffers(drawBuffers.size(), &drawBuffers[0]);
+
+    // depth + stencil texture, samplable so depth can be read back later
+    if (depth)
+    {
+        texture = std::shared_ptr<Texture>(new Texture(width, height, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8));
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, texture->ID, 0);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FBO::framebuffer incomplete" << std::endl;
+    unbind();
+}
 FBO::~FBO()
 {
     glDeleteFramebuffers(1, &id);
@@ -44,6 +88,11 @@ void FBO::bind()
 {
     glBindFramebuffer(GL_FRAMEBUFFER, id);
 }
+void FBO::bindLayer(unsigned int layer, GLenum target)
+{
+    glBindFramebuffer(target, id);
+    glFramebufferTextureLayer(target, attachmentType, texture->ID, 0, layer);
+}
 void FBO::unbind()
 {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
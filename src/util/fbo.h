@@ -3,19 +3,33 @@
 #include <glad/glad.h>
 
 #include <memory>
+#include <vector>
 
 class Texture;
 
 class FBO {
 public:
+    // format of one color attachment (the args glTexImage2D wants)
+    struct Attachment {
+        GLenum internalFormat;
+        GLenum format;
+        GLenum pixelType;
+    };
+
     GLuint id;
     const unsigned int width, height;
     const GLenum attachmentType;
-    FBO(unsigned int width, unsigned int height, GLenum type);
+    const unsigned int layers; // 0 if not layered
+    FBO(unsigned int width, unsigned int height, GLenum type, unsigned int layers = 0);
+    // multiple render targets, color attachments are bound to
+    // GL_COLOR_ATTACHMENT0.. in order, optional depth+stencil texture
+    FBO(unsigned int width, unsigned int height, std::vector<Attachment> colorAttachments, bool depth = true);
     ~FBO();
 
     void bind();
+    void bindLayer(unsigned int layer, GLenum target = GL_FRAMEBUFFER); // bind with only this layer attached
     void unbind();
 
-    std::shared_ptr<Texture> texture;
+    std::shared_ptr<Texture> texture; // depth
+    std::vector<std::shared_ptr<Texture>> colorTextures;
 };
\ No newline at end of file
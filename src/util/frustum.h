@@ -0,0 +1,41 @@
+#pragma once
+
+#include <util/aabb.h>
+
+#include <glm/glm.hpp>
+
+// view frustum as 6 planes pulled straight out of a view projection matrix
+// (gribb/hartmann), normals point inwards
+struct Frustum {
+    glm::vec4 planes[6];
+
+    Frustum() {}
+    Frustum(const glm::mat4& viewProjection)
+    {
+        glm::mat4 m = glm::transpose(viewProjection);
+        planes[0] = m[3] + m[0]; // left
+        planes[1] = m[3] - m[0]; // right
+        planes[2] = m[3] + m[1]; // bottom
+        planes[3] = m[3] - m[1]; // top
+        planes[4] = m[3] + m[2]; // near
+        planes[5] = m[3] - m[2]; // far
+        for (int i = 0; i < 6; ++i)
+            planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+
+    // conservative, boxes near the corners can pass without being inside
+    bool intersects(const AABB& box) const
+    {
+        if (!box.valid())
+            return true; // no bounds, always drawn
+        glm::vec3 c = box.center(), e = box.extents();
+        for (int i = 0; i < 6; ++i)
+        {
+            glm::vec3 n = glm::vec3(planes[i]);
+            float r = glm::dot(e, glm::abs(n));
+            if (glm::dot(n, c) + planes[i].w < -r)
+                return false;
+        }
+        return true;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include "geometryArena.h"
+
+#include <util/vao.h>
+#include <util/vbo.h>
+#include <util/ebo.h>
+#include <util/profiler.h>
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+void FreeList::reset(size_t newCapacity, size_t newUsed)
+{
+    capacity = newCapacity;
+    used = newUsed;
+    free.clear();
+    if (capacity > used)
+        free[used] = capacity - used;
+}
+
+bool FreeList::allocate(size_t count, size_t& offset)
+{
+    if (count == 0)
+    {
+        offset = 0;
+        return true;
+    }
+    // smallest block it fits in, less left over to fragment
+    auto best = free.end();
+    for (auto it = free.begin(); it != free.end(); ++it)
+        if (it->second >= count && (best == free.end() || it->second < best->second))
+        {
+            best = it;
+            if (it->second == count)
+                break;
+        }
+    if (best == free.end())
+        return false;
+
+    offset = best->first;
+    size_t left = best->second - count;
+    free.erase(best);
+    if (left)
+        free[offset + count] = left;
+    used += count;
+    return true;
+}
+
+void FreeList::release(size_t offset, size_t count)
+{
+    if (count == 0)
+        return;
+    used -= count;
+    auto next = free.lower_bound(offset);
+    // merge into the block before us if it ends where we start
+    if (next != free.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            count += prev->second;
+            free.erase(prev);
+        }
+    }
+    if (next != free.end() && offset + count == next->first)
+    {
+        count += next->second;
+        free.erase(next);
+    }
+    free[offset] = count;
+}
+
+size_t FreeList::largest() const
+{
+    size_t biggest = 0;
+    for (auto& block : free)
+        biggest = std::max(biggest, block.second);
+    return biggest;
+}
+
+GeometryArena* GeometryArena::current = nullptr;
+std::vector<GeometryArena*> GeometryArena::all;
+std::shared_ptr<GeometryArena> GeometryArena::standardArena;
+
+static GLsizei strideOf(const std::vector<GLuint>& attributes)
+{
+    GLsizei floats = 0;
+    for (GLuint a : attributes)
+        floats += a;
+    return floats * sizeof(GLfloat);
+}
+
+GeometryArena::GeometryArena(std::string name, std::vector<GLuint> attributes, size_t vertexCapacity, size_t indexCapacity)
+    : name(name), stride(strideOf(attributes)), attributes(attributes)
+{
+    slots.resize(1);
+    vertexSpace.reset(vertexCapacity);
+    indexSpace.reset(indexCapacity);
+    rebuild(vertexCapacity, indexCapacity, false);
+    all.push_back(this);
+}
+
+GeometryArena::~GeometryArena()
+{
+    if (current == this)
+        current = nullptr;
+    all.erase(std::remove(all.begin(), all.end(), this), all.end());
+}
+
+std::shared_ptr<GeometryArena> GeometryArena::standard()
+{
+    if (!standardArena)
+        standardArena = std::shared_ptr<GeometryArena>(new GeometryArena("standard", { 3, 3, 2 }));
+    return standardArena;
+}
+
+void GeometryArena::shutdown()
+{
+    standardArena = nullptr;
+}
+
+void GeometryArena::rebuild(size_t vertexCapacity, size_t indexCapacity, bool packed)
+{
+    std::shared_ptr<VAO> newVao(new VAO());
+    std::shared_ptr<VBO> newVbo(new VBO(newVao, nullptr, vertexCapacity * stride));
+    std::shared_ptr<EBO> newEbo(new EBO(newVao, nullptr, indexCapacity * sizeof(GLuint)));
+    GLuint location = 0;
+    size_t offset = 0;
+    for (GLuint components : attributes)
+    {
+        newVao->link(newVbo, location++, components, GL_FLOAT, stride, (void*)offset);
+        offset += components * sizeof(GLfloat);
+    }
+
+    if (vbo)
+    {
+        // copy targets, so no VAO's element binding changes
+        size_t nextVertex = 0, nextIndex = 0;
+        for (auto& slot : slots)
+        {
+            if (!slot.live)
+                continue;
+            Range& r = slot.range;
+            size_t vertexTo = packed ? nextVertex : r.baseVertex;
+            size_t indexTo = packed ? nextIndex : r.firstIndex;
+            if (r.vertexCount)
+            {
+                glBindBuffer(GL_COPY_READ_BUFFER, vbo->id);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, newVbo->id);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, r.baseVertex * stride, vertexTo * stride, r.vertexCount * stride);
+            }
+            if (r.indexCount)
+            {
+                glBindBuffer(GL_COPY_READ_BUFFER, ebo->id);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, newEbo->id);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, r.firstIndex * sizeof(GLuint), indexTo * sizeof(GLuint), r.indexCount * sizeof(GLuint));
+            }
+            r.baseVertex = vertexTo;
+            r.firstIndex = indexTo;
+            nextVertex += r.vertexCount;
+            nextIndex += r.indexCount;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        if (packed)
+        {
+            vertexSpace.reset(vertexCapacity, nextVertex);
+            indexSpace.reset(indexCapacity, nextIndex);
+        }
+    }
+
+    vao = newVao;
+    vbo = newVbo;
+    ebo = newEbo;
+    linkInstanceIds();
+    // linking left no VAO bound
+    current = nullptr;
+}
+
+bool GeometryArena::fit(size_t vertexCount, size_t indexCount, size_t& vertexOffset, size_t& indexOffset)
+{
+    if (!vertexSpace.allocate(vertexCount, vertexOffset))
+        return false;
+    if (!indexSpace.allocate(indexCount, indexOffset))
+    {
+        vertexSpace.release(vertexOffset, vertexCount);
+        return false;
+    }
+    return true;
+}
+
+GeometryArena::Handle GeometryArena::add(const GLfloat* vertices, size_t vertexCount, const GLuint* indices, size_t indexCount)
+{
+    size_t vertexOffset, indexOffset;
+    if (!fit(vertexCount, indexCount, vertexOffset, indexOffset))
+    {
+        // enough room if it was all in one place, compact. otherwise grow,
+        // packed while we're copying anyway
+        bool roomy = vertexSpace.capacity - vertexSpace.used >= vertexCount && indexSpace.capacity - indexSpace.used >= indexCount;
+        size_t vertexCapacity = vertexSpace.capacity, indexCapacity = indexSpace.capacity;
+        if (!roomy)
+        {
+            while (vertexCapacity - vertexSpace.used < vertexCount)
+                vertexCapacity *= 2;
+            while (indexCapacity - indexSpace.used < indexCount)
+                indexCapacity *= 2;
+            grows++;
+        }
+        else
+            defrags++;
+        rebuild(vertexCapacity, indexCapacity, true);
+        if (!fit(vertexCount, indexCount, vertexOffset, indexOffset))
+        {
+            std::cout << "ERROR::GEOMETRY_ARENA::" << name << "::no room for " << vertexCount << " vertices" << std::endl;
+            return 0;
+        }
+    }
+
+    Handle h;
+    if (!freeSlots.empty())
+    {
+        h = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        h = slots.size();
+        slots.push_back(Slot());
+    }
+    Slot& slot = slots[h];
+    slot.live = true;
+    slot.range.baseVertex = vertexOffset;
+    slot.range.vertexCount = vertexCount;
+    slot.range.firstIndex = indexOffset;
+    slot.range.indexCount = indexCount;
+    liveCount++;
+
+    if (vertexCount)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vbo->id);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, vertexOffset * stride, vertexCount * stride, vertices);
+    }
+    if (indexCount)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ebo->id);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset * sizeof(GLuint), indexCount * sizeof(GLuint), indices);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return h;
+}
+
+void GeometryArena::remove(Handle h)
+{
+    if (h == 0 || h >= slots.size() || !slots[h].live)
+        return;
+    Slot& slot = slots[h];
+    vertexSpace.release(slot.range.baseVertex, slot.range.vertexCount);
+    indexSpace.release(slot.range.firstIndex, slot.range.indexCount);
+    slot = Slot();
+    freeSlots.push_back(h);
+    liveCount--;
+}
+
+void GeometryArena::read(Handle h, std::vector<GLfloat>& vertices, std::vector<GLuint>& indices)
+{
+    const Range& r = range(h);
+    vertices.resize(r.vertexCount * stride / sizeof(GLfloat));
+    indices.resize(r.indexCount);
+    if (r.vertexCount)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, vbo->id);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, r.baseVertex * stride, r.vertexCount * stride, &vertices[0]);
+    }
+    if (r.indexCount)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, ebo->id);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, r.firstIndex * sizeof(GLuint), r.indexCount * sizeof(GLuint), &indices[0]);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+void GeometryArena::bind()
+{
+    if (current == this)
+        return;
+    vao->bind();
+    current = this;
+    Profiler::get().count("vao binds");
+}
+
+void GeometryArena::unbind()
+{
+    if (!current)
+        return;
+    glBindVertexArray(0);
+    current = nullptr;
+}
+
+void GeometryArena::draw(Handle h)
+{
+    const Range& r = slots[h].range;
+    glDrawElementsBaseVertex(GL_TRIANGLES, r.indexCount, GL_UNSIGNED_INT, (void*)(r.firstIndex * sizeof(GLuint)), r.baseVertex);
+}
+
+void GeometryArena::defragment()
+{
+    rebuild(vertexSpace.capacity, indexSpace.capacity, true);
+    defrags++;
+}
+
+void GeometryArena::setInstanceIds(GLuint buffer, GLuint location)
+{
+    if (instanceIds && !buffer)
+    {
+        vao->bind();
+        glDisableVertexAttribArray(instanceIdLocation);
+        vao->unbind();
+        current = nullptr;
+    }
+    instanceIds = buffer;
+    instanceIdLocation = location;
+    linkInstanceIds();
+}
+
+void GeometryArena::linkInstanceIds()
+{
+    if (!instanceIds)
+        return;
+    vao->bind();
+    glBindBuffer(GL_ARRAY_BUFFER, instanceIds);
+    glVertexAttribPointer(instanceIdLocation, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), (void*)0);
+    glEnableVertexAttribArray(instanceIdLocation);
+    glVertexAttribDivisor(instanceIdLocation, 1);
+    vao->unbind();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    current = nullptr;
+}
+
+GeometryArena::Stats GeometryArena::stats() const
+{
+    Stats s;
+    s.vertexCapacity = vertexSpace.capacity;
+    s.vertexUsed = vertexSpace.used;
+    s.indexCapacity = indexSpace.capacity;
+    s.indexUsed = indexSpace.used;
+    s.allocations = liveCount;
+    s.freeBlocks = vertexSpace.blocks() + indexSpace.blocks();
+    s.largestFreeVertices = vertexSpace.largest();
+    s.largestFreeIndices = indexSpace.largest();
+    s.grows = grows;
+    s.defrags = defrags;
+    return s;
+}
\ No newline at end of file
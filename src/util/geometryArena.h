@@ -0,0 +1,122 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class VAO; class VBO; class EBO;
+
+// offset allocator over [0, capacity) in whole elements. free space is kept
+// as a list of blocks sorted by offset, allocations take the smallest block
+// that fits and freed blocks merge with their neighbours
+class FreeList {
+public:
+    void reset(size_t capacity, size_t used = 0); // [0, used) taken, the rest free
+    bool allocate(size_t count, size_t& offset);
+    void release(size_t offset, size_t count);
+
+    size_t capacity = 0;
+    size_t used = 0;
+    size_t blocks() const { return free.size(); }
+    size_t largest() const;
+
+private:
+    std::map<size_t, size_t> free; // offset -> count
+};
+
+// shared vertex/index storage for every mesh with the same vertex layout.
+// geometry is suballocated out of one big VBO and EBO that sit behind a
+// single VAO, and drawn with glDrawElementsBaseVertex so the indices stay
+// relative to the mesh. anything drawn from the same arena goes back to
+// back without touching the VAO. the buffers double when full, and get
+// compacted instead when there's enough free space but it's in pieces.
+// either moves geometry around, so hold on to the handle and look the
+// range up when drawing
+class GeometryArena {
+public:
+    typedef unsigned int Handle; // 0 = nothing
+
+    // attributes are float vectors at consecutive locations, sizes in floats
+    GeometryArena(std::string name, std::vector<GLuint> attributes, size_t vertexCapacity = 1 << 16, size_t indexCapacity = 1 << 18);
+    GeometryArena(const GeometryArena& other) = delete;
+    ~GeometryArena();
+
+    // position, normal, texcoord. everything the engine draws today
+    static std::shared_ptr<GeometryArena> standard();
+    // lets go of the standard arena, before the GL context goes (a static
+    // would be destroyed after glfwTerminate)
+    static void shutdown();
+    static const std::vector<GeometryArena*>& arenas() { return all; }
+
+    Handle add(const GLfloat* vertices, size_t vertexCount, const GLuint* indices, size_t indexCount);
+    void remove(Handle h);
+
+    struct Range {
+        GLint baseVertex = 0;
+        size_t vertexCount = 0;
+        size_t firstIndex = 0;
+        size_t indexCount = 0;
+    };
+    const Range& range(Handle h) const { return slots[h].range; }
+    // copy back from the gpu (stalls, for build steps only)
+    void read(Handle h, std::vector<GLfloat>& vertices, std::vector<GLuint>& indices);
+
+    // bind is a no-op if this arena's VAO is already bound. unbind before
+    // anything else binds a VAO
+    void bind();
+    static void unbind();
+    void draw(Handle h);
+
+    // move everything to the front of the buffers, one free block left
+    void defragment();
+
+    // a per instance float attribute (divisor 1) at location, for indirect
+    // draws to find their record through baseInstance. 0 to detach
+    void setInstanceIds(GLuint buffer, GLuint location);
+
+    const std::string name;
+    const GLsizei stride; // bytes per vertex
+
+    struct Stats {
+        size_t vertexCapacity, vertexUsed;
+        size_t indexCapacity, indexUsed;
+        size_t allocations;
+        size_t freeBlocks;        // vertex and index free lists together
+        size_t largestFreeVertices;
+        size_t largestFreeIndices;
+        unsigned int grows, defrags;
+    };
+    Stats stats() const;
+
+private:
+    struct Slot {
+        Range range;
+        bool live = false;
+    };
+    std::vector<Slot> slots; // slot 0 is never used
+    std::vector<Handle> freeSlots;
+    FreeList vertexSpace;
+    FreeList indexSpace;
+    size_t liveCount = 0;
+    unsigned int grows = 0;
+    unsigned int defrags = 0;
+
+    std::vector<GLuint> attributes;
+    std::shared_ptr<VAO> vao;
+    std::shared_ptr<VBO> vbo;
+    std::shared_ptr<EBO> ebo;
+    GLuint instanceIds = 0;
+    GLuint instanceIdLocation = 0;
+    void linkInstanceIds();
+    // new buffers at these capacities, with the live ranges copied over.
+    // packed moves them all to the front
+    void rebuild(size_t vertexCapacity, size_t indexCapacity, bool packed);
+    bool fit(size_t vertexCount, size_t indexCount, size_t& vertexOffset, size_t& indexOffset);
+
+    static GeometryArena* current; // whose VAO is bound
+    static std::vector<GeometryArena*> all;
+    static std::shared_ptr<GeometryArena> standardArena;
+};
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include "gl43.h"
+
+#include <iostream>
+
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect = nullptr;
+PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = nullptr;
+PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = nullptr;
+
+bool GL43::available = false;
+
+bool GL43::load(GLADloadproc loader)
+{
+    available = false;
+    if (GLVersion.major < 4 || (GLVersion.major == 4 && GLVersion.minor < 3))
+        return false;
+
+    glad_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)loader("glMultiDrawElementsIndirect");
+    glad_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)loader("glDispatchCompute");
+    glad_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)loader("glMemoryBarrier");
+    if (!glad_glMultiDrawElementsIndirect || !glad_glDispatchCompute || !glad_glMemoryBarrier)
+    {
+        std::cout << "WARN::GL43::context is " << GLVersion.major << "." << GLVersion.minor << " but some entry points are missing" << std::endl;
+        return false;
+    }
+    available = true;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// the bits of GL 4.3 the optional indirect path needs. glad is generated
+// for 3.3 core, so these are loaded by hand once there's a context and
+// stay null on anything older. check GL43::available before using them
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect;
+extern PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute;
+extern PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier;
+#define glMultiDrawElementsIndirect glad_glMultiDrawElementsIndirect
+#define glDispatchCompute glad_glDispatchCompute
+#define glMemoryBarrier glad_glMemoryBarrier
+
+class GL43 {
+public:
+    // after gladLoadGL, with the context current. true if the context is
+    // 4.3 or newer and everything loaded
+    static bool load(GLADloadproc loader);
+    static bool available;
+};
\ No newline at end of file
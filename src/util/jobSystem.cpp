@@ -0,0 +1,237 @@
+#include "jobSystem.h"
+
+#include <util/profiler.h>
+
+#include <algorithm>
+#include <chrono>
+
+// which queue the current thread owns, 0 for the main thread (the one that
+// called start). any other thread has none, it pushes onto the main
+// thread's queue and only steals while it waits
+static const unsigned int OUTSIDE = ~0u;
+static thread_local unsigned int queueIndex = OUTSIDE;
+
+JobSystem& JobSystem::get()
+{
+    static JobSystem jobSystem;
+    return jobSystem;
+}
+
+void JobSystem::start(int workerCount)
+{
+    stop();
+    if (workerCount < 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+    queueIndex = 0;
+    queues.clear();
+    for (int i = 0; i <= workerCount; ++i)
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+
+    running = true;
+    for (int i = 1; i <= workerCount; ++i)
+        workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+}
+
+void JobSystem::stop()
+{
+    if (!running)
+        return;
+
+    // finish whatever is left so no counter is left hanging
+    while (runOne(0)) {}
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        running = false;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+JobSystem::CounterPtr JobSystem::run(Job job, CounterPtr dependency, CounterPtr counter)
+{
+    if (!counter)
+        counter = CounterPtr(new Counter());
+    counter->pending++;
+
+    // no workers started, just run it
+    if (!running)
+    {
+        if (dependency)
+            wait(dependency);
+        job();
+        finish(counter);
+        return counter;
+    }
+
+    // park it on the dependency if that hasn't finished yet
+    if (dependency)
+    {
+        std::lock_guard<std::mutex> guard(dependency->lock);
+        if (!dependency->done())
+        {
+            dependency->continuations.push_back(std::make_pair(job, counter));
+            return counter;
+        }
+    }
+    push(job, counter);
+    return counter;
+}
+
+void JobSystem::push(Job job, CounterPtr counter)
+{
+    Queue& q = *queues[queueIndex == OUTSIDE ? 0 : queueIndex];
+    {
+        std::lock_guard<std::mutex> guard(q.lock);
+        q.jobs.push_back(std::make_pair(job, counter));
+    }
+    {
+        // under the sleep lock so a worker can't miss it between checking
+        // for jobs and going to sleep
+        std::lock_guard<std::mutex> guard(sleepLock);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+void JobSystem::finish(CounterPtr counter)
+{
+    if (--counter->pending > 0)
+        return;
+
+    // last job under this counter, release anything waiting on it
+    std::vector<std::pair<Job, CounterPtr>> continuations;
+    {
+        std::lock_guard<std::mutex> guard(counter->lock);
+        continuations.swap(counter->continuations);
+    }
+    for (auto& c : continuations)
+    {
+        if (running)
+            push(c.first, c.second);
+        else
+        {
+            c.first();
+            finish(c.second);
+        }
+    }
+}
+
+bool JobSystem::runOne(unsigned int self)
+{
+    std::pair<Job, CounterPtr> job;
+    bool found = false;
+
+    // own queue first, newest job (it's the most likely to be in cache)
+    if (self != OUTSIDE)
+    {
+        Queue& q = *queues[self];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (!q.jobs.empty())
+        {
+            job = q.jobs.back();
+            q.jobs.pop_back();
+            found = true;
+        }
+    }
+
+    // steal the oldest job from someone else (anyone, without a queue)
+    unsigned int own = self == OUTSIDE ? 0 : self;
+    for (unsigned int i = self == OUTSIDE ? 0 : 1; i < queues.size() && !found; ++i)
+    {
+        Queue& q = *queues[(own + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (!q.jobs.empty())
+        {
+            job = q.jobs.front();
+            q.jobs.pop_front();
+            found = true;
+            steals++;
+        }
+    }
+
+    if (!found)
+        return false;
+    queued--;
+    auto start = std::chrono::steady_clock::now();
+    job.first();
+    busyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    jobsRun++;
+    finish(job.second);
+    return true;
+}
+
+void JobSystem::workerLoop(unsigned int self)
+{
+    queueIndex = self;
+    while (true)
+    {
+        if (runOne(self))
+            continue;
+
+        // nothing to do, sleep until something is queued
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this]() { return !running || queued > 0; });
+        if (!running)
+            return;
+    }
+}
+
+void JobSystem::wait(CounterPtr counter)
+{
+    while (!counter->done())
+    {
+        // help out instead of blocking. GL jobs can only run on the main
+        // thread, so only it takes those too
+        if (queueIndex == 0)
+            runMainThreadJobs();
+        if (!runOne(queueIndex))
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, std::function<void(size_t begin, size_t end)> body)
+{
+    if (count == 0)
+        return;
+    grain = std::max<size_t>(grain, 1);
+    if (!running || count <= grain)
+    {
+        body(0, count);
+        return;
+    }
+
+    CounterPtr counter(new Counter());
+    for (size_t begin = 0; begin < count; begin += grain)
+    {
+        size_t end = std::min(begin + grain, count);
+        run([body, begin, end]() { body(begin, end); }, nullptr, counter);
+    }
+    wait(counter);
+}
+
+void JobSystem::runOnMainThread(Job job)
+{
+    std::lock_guard<std::mutex> guard(mainLock);
+    mainJobs.push_back(job);
+}
+
+void JobSystem::runMainThreadJobs()
+{
+    std::vector<Job> jobs;
+    {
+        std::lock_guard<std::mutex> guard(mainLock);
+        jobs.swap(mainJobs);
+    }
+    for (auto& job : jobs)
+        job();
+}
+
+void JobSystem::publishStats()
+{
+    Profiler::get().count("jobs", jobsRun.exchange(0));
+    Profiler::get().count("job steals", steals.exchange(0));
+    Profiler::get().count("job busy ms", busyNs.exchange(0) / 1000000.0);
+}
\ No newline at end of file
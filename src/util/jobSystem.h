@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// work stealing job scheduler
+// every worker has its own deque, it pushes and pops its own jobs at the
+// back and steals from the front of the others when it runs dry. the main
+// thread (the one that calls start) has a deque too (index 0) and helps out
+// while it waits on jobs, other threads can queue and wait but only steal.
+// jobs report completion through a Counter, which other jobs can wait on
+// (continuations) so dependent work doesn't block a thread.
+// GL calls can only happen on the main thread, those go through
+// runOnMainThread and are run by runMainThreadJobs (once a frame, and while
+// the main thread waits)
+class JobSystem {
+public:
+    static JobSystem& get();
+
+    typedef std::function<void()> Job;
+
+    // pending job count, done when it reaches zero
+    class Counter {
+    public:
+        bool done() { return pending.load() == 0; }
+    private:
+        friend class JobSystem;
+        std::atomic<int> pending{ 0 };
+        std::mutex lock;
+        std::vector<std::pair<Job, std::shared_ptr<Counter>>> continuations;
+    };
+    typedef std::shared_ptr<Counter> CounterPtr;
+
+    // workers < 0 uses one per core (minus the main thread), 0 still queues
+    // jobs but only the main thread runs them
+    void start(int workers = -1);
+    void stop();
+    unsigned int workerCount() { return workers.size(); }
+
+    // run a job, after dependency has finished if given. the returned counter
+    // finishes with the job, pass one in to group several jobs under it
+    CounterPtr run(Job job, CounterPtr dependency = nullptr, CounterPtr counter = nullptr);
+    // block until the counter is done, running other jobs meanwhile
+    void wait(CounterPtr counter);
+    // split [0, count) into chunks of at most grain and run them in parallel,
+    // returns when all chunks are done
+    void parallelFor(size_t count, size_t grain, std::function<void(size_t begin, size_t end)> body);
+
+    // queue GL work (or anything else that must be on the main thread)
+    void runOnMainThread(Job job);
+    void runMainThreadJobs();
+
+    // hand the job stats for the last frame to the profiler and reset them
+    // (main thread, once a frame)
+    void publishStats();
+
+private:
+    JobSystem() {}
+    ~JobSystem() { stop(); }
+
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::pair<Job, CounterPtr>> jobs;
+    };
+
+    void push(Job job, CounterPtr counter);
+    bool runOne(unsigned int self);
+    void finish(CounterPtr counter);
+    void workerLoop(unsigned int self);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues; // 0 = main thread
+    std::atomic<bool> running{ false };
+    std::atomic<int> queued{ 0 };
+    std::mutex sleepLock;
+    std::condition_variable wake;
+
+    std::mutex mainLock;
+    std::vector<Job> mainJobs;
+
+    std::atomic<unsigned int> jobsRun{ 0 };
+    std::atomic<unsigned int> steals{ 0 };
+    std::atomic<unsigned long long> busyNs{ 0 }; // time spent running jobs, all threads
+};
\ No newline at end of file
@@ -1,25 +1,49 @@
 #include "mesh.h"
 
 #include <memory>
-#include <util/vao.h>
-#include <util/vbo.h>
-#include <util/ebo.h>
 
 void Mesh::constructMesh(std::vector<GLfloat>& vertexData, std::vector<GLuint>& indices)
 {
-    vao = std::shared_ptr<VAO>(new VAO());
-    vbo = std::shared_ptr<VBO>(new VBO(vao, &vertexData[0], vertexData.size() * sizeof(GLfloat)));
-    ebo = std::shared_ptr<EBO>(new EBO(vao, &indices[0], indices.size() * sizeof(GLuint)));
+    // object space bounds for culling
+    bounds = AABB();
+    for (size_t i = 0; i + 2 < vertexData.size(); i += 8)
+        bounds.expand(glm::vec3(vertexData[i], vertexData[i + 1], vertexData[i + 2]));
 
-    // set buffer attributes
-    // vertex positions
-    vao->link(vbo, 0, 3, GL_FLOAT, 8 * sizeof(GLfloat), (void*)0); // vertex coords
-    // normals 
-    vao->link(vbo, 1, 3, GL_FLOAT, 8 * sizeof(GLfloat), (void*)(3 * sizeof(float))); // vertex coords
-    // texcoords 
-    vao->link(vbo, 2, 2, GL_FLOAT, 8 * sizeof(GLfloat), (void*)(6 * sizeof(float))); // vertex coords
+    if (arena)
+        arena->remove(geometry);
+    arena = GeometryArena::standard();
+    geometry = arena->add(vertexData.data(), vertexData.size() / 8, indices.data(), indices.size());
 }
 
-size_t Mesh::indices() { return ebo->size; }
-void Mesh::bind() { vao->bind(); }
-void Mesh::unbind() { vao->unbind(); }
\ No newline at end of file
+Mesh::~Mesh()
+{
+    if (arena)
+        arena->remove(geometry);
+}
+
+size_t Mesh::indices() { return arena ? arena->range(geometry).indexCount : 0; }
+void Mesh::draw()
+{
+    if (!arena)
+        return;
+    arena->bind();
+    arena->draw(geometry);
+}
+void Mesh::read(std::vector<GLfloat>& vertexData, std::vector<GLuint>& indexData)
+{
+    if (arena)
+        arena->read(geometry, vertexData, indexData);
+}
+void Mesh::replace(Mesh& other)
+{
+    if (arena)
+        arena->remove(geometry);
+    arena = other.arena;
+    geometry = other.geometry;
+    other.arena = nullptr;
+    other.geometry = 0;
+    bounds = other.bounds;
+    diffuseColor = other.diffuseColor;
+    specularColor = other.specularColor;
+    shininess = other.shininess;
+}
\ No newline at end of file
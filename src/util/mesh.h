@@ -4,32 +4,42 @@
 
 #include <glm/glm.hpp>
 
+#include <util/aabb.h>
+#include <util/geometryArena.h>
+
 #include <string>
 #include <memory>
 #include <vector>
 
-class VAO; class EBO; class VBO;
 class Texture;
 
 class Mesh : public std::enable_shared_from_this<Mesh> {
 public:
     std::string name;
+    ~Mesh();
     // for now this function expects the vertex data to be laid as follows
     // layout (location = 0) in vec3 aPos;
     // layout (location = 1) in vec3 aNormal;
     // layout (location = 2) in vec2 aTexCoords;
     void constructMesh(std::vector<GLfloat>& vertexData, std::vector<GLuint>& indices);
     size_t indices();
-    void bind();
-    void unbind();
+    // binds the arena (if it isn't already) and draws
+    void draw();
+    GeometryArena::Handle getGeometry() const { return geometry; } // in GeometryArena::standard()
+    // the vertex and index data back from the gpu (static batching)
+    void read(std::vector<GLfloat>& vertexData, std::vector<GLuint>& indexData);
+    // takes other's geometry, bounds and material colours (hot reload, other
+    // is left empty). textures set on this mesh stay
+    void replace(Mesh& other);
 
     glm::vec3 diffuseColor = glm::vec3(0.0f);
     glm::vec3 specularColor = glm::vec3(0.0f);
     float shininess = 1.0f;
     std::shared_ptr<Texture> diffuseTex = nullptr;
     std::shared_ptr<Texture> specularTex = nullptr;
+    AABB bounds; // object space, from the vertex positions
 private:
-    std::shared_ptr<VAO> vao;
-    std::shared_ptr<VBO> vbo;
-    std::shared_ptr<EBO> ebo;
+    // vertices and indices live in the shared arena
+    std::shared_ptr<GeometryArena> arena;
+    GeometryArena::Handle geometry = 0;
 };
\ No newline at end of file
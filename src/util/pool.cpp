@@ -0,0 +1,117 @@
+#include "pool.h"
+
+#include <algorithm>
+#include <new>
+
+Pool::SizeClass Pool::classes[Pool::MAX_BLOCK / Pool::ALIGN];
+
+static size_t classIndex(size_t size)
+{
+    return (std::max(size, (size_t)1) + Pool::ALIGN - 1) / Pool::ALIGN - 1;
+}
+
+void* Pool::allocate(size_t size)
+{
+    if (size > MAX_BLOCK)
+        return ::operator new(size);
+
+    size_t index = classIndex(size);
+    SizeClass& c = classes[index];
+    std::lock_guard<std::mutex> guard(c.lock);
+    if (!c.freeList)
+    {
+        // new slab, thread all of its blocks onto the free list
+        size_t blockSize = (index + 1) * ALIGN;
+        char* slab = (char*)::operator new(SLAB_SIZE);
+        c.slabs.insert(std::upper_bound(c.slabs.begin(), c.slabs.end(), slab), slab);
+        for (size_t offset = SLAB_SIZE / blockSize * blockSize; offset > 0; offset -= blockSize)
+        {
+            void* block = slab + offset - blockSize;
+            *(void**)block = c.freeList;
+            c.freeList = block;
+        }
+    }
+    void* block = c.freeList;
+    c.freeList = *(void**)block;
+    c.live++;
+    return block;
+}
+
+void Pool::deallocate(void* p, size_t size)
+{
+    if (!p)
+        return;
+    if (size > MAX_BLOCK)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    SizeClass& c = classes[classIndex(size)];
+    std::lock_guard<std::mutex> guard(c.lock);
+    *(void**)p = c.freeList;
+    c.freeList = p;
+    c.live--;
+}
+
+size_t Pool::trim()
+{
+    size_t released = 0;
+    for (size_t index = 0; index < MAX_BLOCK / ALIGN; ++index)
+    {
+        SizeClass& c = classes[index];
+        std::lock_guard<std::mutex> guard(c.lock);
+        if (c.slabs.empty())
+            continue;
+
+        // count free blocks per slab, a slab is empty when all of them are
+        size_t blockSize = (index + 1) * ALIGN;
+        size_t perSlab = SLAB_SIZE / blockSize;
+        std::vector<size_t> freeCount(c.slabs.size(), 0);
+        auto slabOf = [&c](void* block) {
+            return std::upper_bound(c.slabs.begin(), c.slabs.end(), (char*)block) - c.slabs.begin() - 1;
+        };
+        for (void* block = c.freeList; block; block = *(void**)block)
+            freeCount[slabOf(block)]++;
+
+        // rebuild the free list without the empty slabs
+        void* freeList = nullptr;
+        for (void* block = c.freeList; block;)
+        {
+            void* next = *(void**)block;
+            if (freeCount[slabOf(block)] != perSlab)
+            {
+                *(void**)block = freeList;
+                freeList = block;
+            }
+            block = next;
+        }
+        c.freeList = freeList;
+
+        std::vector<char*> kept;
+        for (size_t i = 0; i < c.slabs.size(); ++i)
+            if (freeCount[i] == perSlab)
+            {
+                ::operator delete(c.slabs[i]);
+                released++;
+            }
+            else
+                kept.push_back(c.slabs[i]);
+        c.slabs.swap(kept);
+    }
+    return released;
+}
+
+Pool::Stats Pool::stats()
+{
+    Stats s;
+    for (size_t index = 0; index < MAX_BLOCK / ALIGN; ++index)
+    {
+        SizeClass& c = classes[index];
+        std::lock_guard<std::mutex> guard(c.lock);
+        s.slabs += c.slabs.size();
+        s.blocks += c.live;
+    }
+    s.bytes = s.slabs * SLAB_SIZE;
+    return s;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// slab allocator for the small, numerous scene types (objects, components,
+// scripts). blocks are grouped by size class so every object of a type ends
+// up next to its siblings in a handful of 64k slabs instead of scattered
+// over the heap, and freed blocks go on a free list for the next clone.
+// anything bigger than MAX_BLOCK goes straight to the heap.
+// thread safe (one lock per size class)
+class Pool {
+public:
+    static const size_t ALIGN = 16;
+    static const size_t MAX_BLOCK = 1024;
+    static const size_t SLAB_SIZE = 64 * 1024;
+
+    static void* allocate(size_t size);
+    static void deallocate(void* p, size_t size);
+
+    // give slabs with nothing alive in them back to the heap (scene unload)
+    static size_t trim();
+
+    struct Stats {
+        size_t slabs = 0;
+        size_t blocks = 0; // live
+        size_t bytes = 0;  // held in slabs
+    };
+    static Stats stats();
+
+private:
+    struct SizeClass {
+        std::mutex lock;
+        void* freeList = nullptr;
+        std::vector<char*> slabs; // sorted
+        size_t live = 0;
+    };
+    static SizeClass classes[MAX_BLOCK / ALIGN];
+};
+
+// std allocator on top of the pool, for allocate_shared (object and control
+// block in one pooled block) and containers
+template <typename T>
+class PoolAllocator {
+public:
+    typedef T value_type;
+    PoolAllocator() {}
+    template <typename U> PoolAllocator(const PoolAllocator<U>&) {}
+    T* allocate(size_t n) { return (T*)Pool::allocate(n * sizeof(T)); }
+    void deallocate(T* p, size_t n) { Pool::deallocate(p, n * sizeof(T)); }
+    template <typename U> bool operator == (const PoolAllocator<U>&) const { return true; }
+    template <typename U> bool operator != (const PoolAllocator<U>&) const { return false; }
+};
+
+// use instead of std::shared_ptr<T>(new T(...)) for scene types
+template <typename T, typename... Args>
+std::shared_ptr<T> makePooled(Args&&... args)
+{
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
\ No newline at end of file
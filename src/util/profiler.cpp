@@ -0,0 +1,106 @@
+#include "profiler.h"
+
+Profiler& Profiler::get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+// smoothing for the displayed values so the numbers are readable
+static const double SMOOTHING = 0.9;
+
+void Profiler::beginFrame()
+{
+    // collect gpu timings that have finished
+    for (auto& it : timings)
+    {
+        Timing& t = it.second;
+        for (int i = 0; i < QUERY_FRAMES; ++i)
+        {
+            if (!t.pending[i]) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(t.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(t.queries[i], GL_QUERY_RESULT, &ns);
+            t.pending[i] = false;
+
+            Stat& s = sections[it.first];
+            double ms = ns / 1000000.0;
+            s.gpuMs = s.gpuSamples ? s.gpuMs * SMOOTHING + ms * (1.0 - SMOOTHING) : ms;
+            s.totalGpuMs += ms;
+            s.gpuSamples++;
+        }
+    }
+
+    // publish last frame's counters
+    for (auto& it : sections)
+        if (it.second.counter)
+            it.second.count = 0.0;
+    for (auto& it : frameCounts)
+    {
+        Stat& s = sections[it.first];
+        s.counter = true;
+        s.count = it.second;
+        s.totalCount += it.second;
+        s.cpuSamples++;
+    }
+    frameCounts.clear();
+
+    frameIndex++;
+}
+
+void Profiler::begin(const std::string& section, bool gpu)
+{
+    Timing& t = timings[section];
+    t.start = std::chrono::steady_clock::now();
+    if (gpu)
+    {
+        int slot = frameIndex % QUERY_FRAMES;
+        if (!t.queries[0])
+            glGenQueries(QUERY_FRAMES, t.queries);
+        // skip the gpu timing if this slot is still in flight (gpu is more
+        // than QUERY_FRAMES behind), better than stalling
+        if (!t.pending[slot])
+        {
+            glBeginQuery(GL_TIME_ELAPSED, t.queries[slot]);
+            t.pending[slot] = true;
+            sections[section].gpu = true;
+        }
+    }
+}
+
+void Profiler::end(const std::string& section)
+{
+    Timing& t = timings[section];
+    Stat& s = sections[section];
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t.start).count();
+    s.cpuMs = s.cpuSamples ? s.cpuMs * SMOOTHING + ms * (1.0 - SMOOTHING) : ms;
+    s.totalCpuMs += ms;
+    s.cpuSamples++;
+
+    if (s.gpu && t.pending[frameIndex % QUERY_FRAMES])
+    {
+        GLint active = 0;
+        glGetQueryiv(GL_TIME_ELAPSED, GL_CURRENT_QUERY, &active);
+        if ((GLuint)active == t.queries[frameIndex % QUERY_FRAMES])
+            glEndQuery(GL_TIME_ELAPSED);
+    }
+}
+
+void Profiler::count(const std::string& counter, double amount)
+{
+    frameCounts[counter] += amount;
+}
+
+void Profiler::reset()
+{
+    for (auto& it : sections)
+    {
+        it.second.totalCpuMs = 0.0;
+        it.second.totalGpuMs = 0.0;
+        it.second.totalCount = 0.0;
+        it.second.cpuSamples = 0;
+        it.second.gpuSamples = 0;
+    }
+}
\ No newline at end of file
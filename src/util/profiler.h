@@ -0,0 +1,61 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string>
+#include <map>
+#include <vector>
+#include <chrono>
+
+// tiny frame profiler, named sections with cpu time and (optionally) gpu
+// time from timer queries, plus named counters (draw calls etc.)
+// gpu results are read back a couple of frames late so we never stall
+// waiting on the driver. only one gpu section can be open at a time
+// (GL_TIME_ELAPSED queries don't nest). main thread only, jobs report
+// through JobSystem::publishStats
+class Profiler {
+public:
+    static Profiler& get();
+
+    struct Stat {
+        double cpuMs = 0.0;     // smoothed, for display
+        double gpuMs = 0.0;
+        double count = 0.0;     // counters only, last frame
+        double totalCpuMs = 0.0; // accumulated since the last reset, for benchmarks
+        double totalGpuMs = 0.0;
+        double totalCount = 0.0;
+        unsigned int cpuSamples = 0;
+        unsigned int gpuSamples = 0;
+        bool gpu = false;
+        bool counter = false;
+    };
+
+    void beginFrame();
+    void begin(const std::string& section, bool gpu = false);
+    void end(const std::string& section);
+    void count(const std::string& counter, double amount = 1.0);
+    void reset(); // clear accumulated totals
+
+    const std::map<std::string, Stat>& stats() { return sections; }
+    unsigned int frame() { return frameIndex; }
+
+    // RAII helper, times the enclosing block
+    struct Scope {
+        Scope(const std::string& section, bool gpu = false) : section(section) { Profiler::get().begin(section, gpu); }
+        ~Scope() { Profiler::get().end(section); }
+        std::string section;
+    };
+
+private:
+    Profiler() {}
+    static const int QUERY_FRAMES = 3;
+    struct Timing {
+        std::chrono::steady_clock::time_point start;
+        GLuint queries[QUERY_FRAMES] = { 0, 0, 0 };
+        bool pending[QUERY_FRAMES] = { false, false, false };
+    };
+    std::map<std::string, Stat> sections;
+    std::map<std::string, Timing> timings;
+    std::map<std::string, double> frameCounts;
+    unsigned int frameIndex = 0;
+};
\ No newline at end of file
@@ -1,12 +1,24 @@
 #include "shader.h"
 
+#include <util/gl43.h>
+#include <util/shaderCache.h>
+
 #include <fstream>
 #include <iostream>
+#include <cstring>
+#include <chrono>
 
 char* readShaderFile(const char* path) {
     char* retbuf;
 
     std::ifstream f(path, std::ios::binary);
+    if (!f)
+    { // gone (hot reload can get here mid-save), empty source won't compile
+        std::cout << "ERROR::SHADER::FILE::could not read " << path << std::endl;
+        retbuf = new char[1];
+        retbuf[0] = 0;
+        return retbuf;
+    }
     f.seekg(0, std::ios::end);
 
     int len;
@@ -20,13 +32,14 @@ char* readShaderFile(const char* path) {
     return retbuf;
 }
 
-void checkErrors(GLuint shader, GLenum type, const char* shaderPath)
+bool checkErrors(GLuint shader, GLenum type, const char* shaderPath)
 {
     GLint compiled;
     char errors[1024];
     switch(type) {
         case GL_VERTEX_SHADER:
         case GL_FRAGMENT_SHADER:
+        case GL_COMPUTE_SHADER:
             glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
             if (compiled == GL_FALSE) {
                 glGetShaderInfoLog(shader, 1024, NULL, errors);
@@ -34,45 +47,173 @@ void checkErrors(GLuint shader, GLenum type, const char* shaderPath)
             }
         break;
         default:
-            glGetProgramiv(shader, GL_COMPILE_STATUS, &compiled);
+            glGetProgramiv(shader, GL_LINK_STATUS, &compiled);
             if (compiled == GL_FALSE) {
-                glGetShaderInfoLog(shader, 1024, NULL, errors);
-                std::cout << "ERROR::SHADER::LINK::" << errors << std::endl;
+                glGetProgramInfoLog(shader, 1024, NULL, errors);
+                std::cout << "ERROR::SHADER::LINK::" << shaderPath << "::" << errors << std::endl;
             }
     }
+    return compiled != GL_FALSE;
+}
+
+// the source with its #version line swapped for header, so variants can be
+// compiled from the same files with a newer version and some #defines
+static std::string withHeader(const char* src, const std::string& header)
+{
+    std::string source(src);
+    if (header.empty())
+        return source;
+    size_t version = source.find("#version");
+    if (version == std::string::npos)
+        return header + source;
+    size_t end = source.find('\n', version);
+    return source.substr(0, version) + header + (end == std::string::npos ? "" : source.substr(end + 1));
+}
+
+static const char* FEATURE_NAMES[] = { "DIFFUSE_TEX", "SPECULAR_TEX", "SUN", "POINT_LIGHTS", "FOG" };
+
+const char* Shader::featureName(unsigned int feature)
+{
+    for (unsigned int i = 0; i < sizeof(FEATURE_NAMES) / sizeof(FEATURE_NAMES[0]); ++i)
+        if (feature == 1u << i)
+            return FEATURE_NAMES[i];
+    return "";
+}
+
+// features named on "#pragma keywords" lines (the compiler ignores pragmas
+// it doesn't know)
+static unsigned int declaredKeywords(const char* src, const char* path)
+{
+    unsigned int keywords = 0;
+    const char* line = src;
+    while ((line = strstr(line, "#pragma keywords")))
+    {
+        line += strlen("#pragma keywords");
+        const char* end = strchr(line, '\n');
+        std::string words(line, end ? end - line : strlen(line));
+        size_t start = words.find_first_not_of(" \t\r");
+        while (start != std::string::npos)
+        {
+            size_t stop = words.find_first_of(" \t\r", start);
+            std::string word = words.substr(start, stop == std::string::npos ? std::string::npos : stop - start);
+            unsigned int feature = 0;
+            for (unsigned int i = 0; i < sizeof(FEATURE_NAMES) / sizeof(FEATURE_NAMES[0]); ++i)
+                if (word == FEATURE_NAMES[i])
+                    feature = 1u << i;
+            if (!feature)
+                std::cout << "WARN::SHADER::" << path << "::unknown keyword " << word << std::endl;
+            keywords |= feature;
+            start = stop == std::string::npos ? stop : words.find_first_not_of(" \t\r", stop);
+        }
+    }
+    return keywords;
 }
 
-Shader::Shader(std::string name, const char* vertFile, const char* fragFile)
+// #defines go right after the #version line
+static std::string withDefines(const std::string& source, unsigned int features)
 {
+    std::string defines;
+    for (unsigned int i = 0; i < sizeof(FEATURE_NAMES) / sizeof(FEATURE_NAMES[0]); ++i)
+        if (features & (1u << i))
+            defines += std::string("#define ") + FEATURE_NAMES[i] + "\n";
+    if (defines.empty())
+        return source;
+    size_t version = source.find("#version");
+    size_t end = version == std::string::npos ? std::string::npos : source.find('\n', version);
+    if (end == std::string::npos)
+        return defines + source;
+    return source.substr(0, end + 1) + defines + source.substr(end + 1);
+}
+
+Shader::Shader(std::string name, const char* vertFile, const char* fragFile, std::string header, unsigned int features)
+    : vertPath(vertFile), fragPath(fragFile), header(header)
+{
+    auto start = std::chrono::steady_clock::now();
     this->name = name;
 
     // read src
-    const char* vertSrc = readShaderFile(vertFile);
-    const char* fragSrc = readShaderFile(fragFile);
-
-    // compile vertex shader
-    GLuint vert = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vert, 1, &vertSrc, NULL);
-    glCompileShader(vert);
-    checkErrors(vert, GL_VERTEX_SHADER, vertFile);
-
-    // comppile fragment shader
-    GLuint frag = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(frag, 1, &fragSrc, NULL);
-    glCompileShader(frag);
-    checkErrors(frag, GL_FRAGMENT_SHADER, fragFile);
-
-    id = glCreateProgram();
-    glAttachShader(id, vert);
-    glAttachShader(id, frag);
-    glLinkProgram(id);
-    checkErrors(id, 0, NULL);
-
-    // cleanup
-    delete[] (char*) vertSrc;
-    delete[] (char*) fragSrc;
-    glDeleteShader(vert);
-    glDeleteShader(frag);
+    const char* vertFileSrc = readShaderFile(vertFile);
+    const char* fragFileSrc = readShaderFile(fragFile);
+    hasIndirect = strstr(vertFileSrc, "#ifdef INDIRECT") != nullptr;
+    keywords = declaredKeywords(vertFileSrc, vertFile) | declaredKeywords(fragFileSrc, fragFile);
+    this->features = features & keywords;
+    std::string sources[2] = {
+        withDefines(withHeader(vertFileSrc, header), this->features),
+        withDefines(withHeader(fragFileSrc, header), this->features)
+    };
+    const char* vertSrc = sources[0].c_str();
+    const char* fragSrc = sources[1].c_str();
+    delete[] (char*) vertFileSrc;
+    delete[] (char*) fragFileSrc;
+
+    unsigned long long key = ShaderCache::key(sources, 2);
+    id = ShaderCache::fetch(name, key);
+    valid = id != 0;
+    if (!id)
+    {
+        // compile vertex shader
+        GLuint vert = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vert, 1, &vertSrc, NULL);
+        glCompileShader(vert);
+        valid = checkErrors(vert, GL_VERTEX_SHADER, vertFile);
+
+        // comppile fragment shader
+        GLuint frag = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(frag, 1, &fragSrc, NULL);
+        glCompileShader(frag);
+        valid = checkErrors(frag, GL_FRAGMENT_SHADER, fragFile) && valid;
+
+        id = glCreateProgram();
+        glAttachShader(id, vert);
+        glAttachShader(id, frag);
+        ShaderCache::prepare(id);
+        glLinkProgram(id);
+        valid = checkErrors(id, 0, name.c_str()) && valid;
+        if (valid)
+            ShaderCache::store(name, key, id);
+
+        // cleanup
+        glDeleteShader(vert);
+        glDeleteShader(frag);
+    }
+    // from the linked program, a word in a comment or a longer name
+    // (lifetime) doesn't count and anything included or defined in does
+    batchable = !valid || glGetUniformLocation(id, "time") == -1;
+    ShaderCache::stats.buildMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Shader::Shader(std::string name, const char* computeFile)
+    : computePath(computeFile)
+{
+    auto start = std::chrono::steady_clock::now();
+    this->name = name;
+    const char* src = readShaderFile(computeFile);
+    std::string source(src);
+    delete[] (char*) src;
+    src = source.c_str();
+
+    // own file name, a compute and a vertex/fragment shader can share a name
+    unsigned long long key = ShaderCache::key(&source, 1);
+    id = ShaderCache::fetch(name + ".comp", key);
+    valid = id != 0;
+    if (!id)
+    {
+        GLuint comp = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(comp, 1, &src, NULL);
+        glCompileShader(comp);
+        valid = checkErrors(comp, GL_COMPUTE_SHADER, computeFile);
+
+        id = glCreateProgram();
+        glAttachShader(id, comp);
+        ShaderCache::prepare(id);
+        glLinkProgram(id);
+        valid = checkErrors(id, 0, name.c_str()) && valid;
+        if (valid)
+            ShaderCache::store(name + ".comp", key, id);
+
+        glDeleteShader(comp);
+    }
+    ShaderCache::stats.buildMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
 Shader::~Shader()
@@ -80,7 +221,26 @@ Shader::~Shader()
     glDeleteProgram(id);
 }
 
+bool Shader::reload()
+{
+    std::shared_ptr<Shader> fresh(computePath.empty()
+        ? new Shader(name, vertPath.c_str(), fragPath.c_str(), header)
+        : new Shader(name, computePath.c_str()));
+    if (!fresh->valid)
+        return false;
+
+    // the old program goes with fresh
+    std::swap(id, fresh->id);
+    valid = true;
+    batchable = fresh->batchable;
+    hasIndirect = fresh->hasIndirect;
+    keywords = fresh->keywords;
+    features = fresh->features;
+    variants.clear();
+    return true;
+}
+
 void Shader::activate()
 {
     glUseProgram(id);
-}
+}
\ No newline at end of file
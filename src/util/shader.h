@@ -4,14 +4,64 @@
 
 #include <string>
 #include <memory>
+#include <map>
 
 class Shader : public std::enable_shared_from_this<Shader> {
 public:
     GLuint id;
     std::string name;
 
-    Shader(std::string name, const char* vertPath, const char* fragPath);
+    // g-buffer version of this shader for the deferred renderer
+    // (gbuffer_<name>), null if it can only be drawn forward
+    std::shared_ptr<Shader> gbufferVariant;
+
+    // false if the program reads the time uniform (the vertex stage may
+    // animate in object space), its meshes can't be pre-transformed into a
+    // static batch
+    bool batchable = true;
+
+    // version of this shader for multi-draw indirect (compiled from the same
+    // files as GLSL 4.30 with INDIRECT defined), null if the vertex shader
+    // has no INDIRECT path or there's no GL 4.3
+    std::shared_ptr<Shader> indirectVariant;
+    bool hasIndirect = false;
+    std::string vertPath;
+    std::string fragPath;
+    std::string computePath;
+    std::string header;
+    bool valid = false; // compiled and linked
+
+    // compile time features. a shader lists the ones it has on a
+    // "#pragma keywords ..." line and wraps them in #ifdef, the shader as
+    // loaded is built with all of them defined. a draw that doesn't need
+    // some (no texture bound, no point light in reach...) gets a variant
+    // built without them, see Scene::shaderVariant
+    enum Feature : unsigned int {
+        DIFFUSE_TEX = 1 << 0,
+        SPECULAR_TEX = 1 << 1,
+        SUN = 1 << 2,          // the directional light and its shadows
+        POINT_LIGHTS = 1 << 3,
+        FOG = 1 << 4,
+        ALL_FEATURES = (1 << 5) - 1
+    };
+    static const char* featureName(unsigned int feature);
+    unsigned int keywords = 0; // declared by the sources
+    unsigned int features = 0; // defined in this build
+    // built so far, by features
+    std::map<unsigned int, std::shared_ptr<Shader>> variants;
+
+    // header replaces the sources' #version line when it's given (variants),
+    // features are the keywords to define
+    Shader(std::string name, const char* vertPath, const char* fragPath, std::string header = "", unsigned int features = ALL_FEATURES);
+    // compute only (GL 4.3)
+    Shader(std::string name, const char* computePath);
     ~Shader();
 
+    // rebuilds from the files it was loaded from (hot reload) and takes the
+    // new program over, everything holding this shader picks it up. built
+    // variants are dropped and rebuilt on their next use. false if it
+    // doesn't compile or link, the old program is kept
+    bool reload();
+
     void activate();
 };
\ No newline at end of file
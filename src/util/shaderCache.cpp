@@ -0,0 +1,186 @@
+#include "shaderCache.h"
+
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = nullptr;
+
+bool ShaderCache::available = false;
+bool ShaderCache::enabled = true;
+std::string ShaderCache::directory = "shadercache";
+std::string ShaderCache::driver;
+ShaderCache::Stats ShaderCache::stats;
+
+// bumped if the file layout changes
+static const char MAGIC[4] = { 'S', 'H', 'D', 'R' };
+static const unsigned int FORMAT_VERSION = 1;
+
+bool ShaderCache::load(GLADloadproc loader)
+{
+    available = false;
+    bool core = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 1);
+    bool extension = false;
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions && !core && !extension; ++i)
+        extension = strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_get_program_binary") == 0;
+    if (!core && !extension)
+        return false;
+
+    glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)loader("glGetProgramBinary");
+    glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)loader("glProgramBinary");
+    glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)loader("glProgramParameteri");
+    if (!glad_glGetProgramBinary || !glad_glProgramBinary || !glad_glProgramParameteri)
+        return false;
+    // the driver can support the calls and still have no format to save in
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats < 1)
+        return false;
+
+    driver = std::string((const char*)glGetString(GL_VENDOR)) + "\n"
+        + (const char*)glGetString(GL_RENDERER) + "\n"
+        + (const char*)glGetString(GL_VERSION);
+    available = true;
+    return true;
+}
+
+// fnv-1a, no need for anything stronger to spot a change
+static void hash(unsigned long long& h, const char* data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ull;
+    }
+}
+
+unsigned long long ShaderCache::key(const std::string* sources, size_t count)
+{
+    unsigned long long h = 14695981039346656037ull;
+    hash(h, driver.c_str(), driver.size() + 1);
+    for (size_t i = 0; i < count; ++i)
+        hash(h, sources[i].c_str(), sources[i].size() + 1); // the 0 keeps "ab" "c" and "a" "bc" apart
+    return h;
+}
+
+std::string ShaderCache::path(const std::string& name)
+{
+    std::string file = name;
+    for (auto& c : file)
+        if (!isalnum((unsigned char)c) && c != '_' && c != '-')
+            c = '_';
+    return directory + "/" + file + ".bin";
+}
+
+GLuint ShaderCache::fetch(const std::string& name, unsigned long long key)
+{
+    if (!available || !enabled)
+        return 0;
+
+    std::ifstream f(path(name), std::ios::binary);
+    if (!f)
+    {
+        stats.misses++;
+        return 0;
+    }
+    char magic[4];
+    unsigned int version = 0;
+    unsigned long long savedKey = 0;
+    GLenum format = 0;
+    GLint length = 0;
+    f.read(magic, sizeof(magic));
+    f.read((char*)&version, sizeof(version));
+    f.read((char*)&savedKey, sizeof(savedKey));
+    f.read((char*)&format, sizeof(format));
+    f.read((char*)&length, sizeof(length));
+    if (!f || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != FORMAT_VERSION || savedKey != key || length <= 0)
+    {
+        stats.stale++;
+        stats.misses++;
+        return 0;
+    }
+    std::vector<char> binary(length);
+    f.read(binary.data(), length);
+    if (!f)
+    {
+        stats.stale++;
+        stats.misses++;
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), length);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        glDeleteProgram(program);
+        stats.rejected++;
+        stats.misses++;
+        return 0;
+    }
+    stats.hits++;
+    return program;
+}
+
+void ShaderCache::prepare(GLuint program)
+{
+    if (available && enabled)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ShaderCache::store(const std::string& name, unsigned long long key, GLuint program)
+{
+    if (!available || !enabled)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+    // written next to it and moved over, a crash halfway can't leave a
+    // truncated file behind
+    std::string file = path(name);
+    std::string temp = file + ".tmp";
+    {
+        std::ofstream f(temp, std::ios::binary | std::ios::trunc);
+        f.write(MAGIC, sizeof(MAGIC));
+        f.write((const char*)&FORMAT_VERSION, sizeof(FORMAT_VERSION));
+        f.write((const char*)&key, sizeof(key));
+        f.write((const char*)&format, sizeof(format));
+        f.write((const char*)&length, sizeof(length));
+        f.write(binary.data(), length);
+        if (!f)
+        {
+            std::cout << "WARN::SHADER_CACHE::could not write " << temp << std::endl;
+            return;
+        }
+    }
+    std::remove(file.c_str()); // rename won't replace on windows
+    if (std::rename(temp.c_str(), file.c_str()) != 0)
+    {
+        std::cout << "WARN::SHADER_CACHE::could not write " << file << std::endl;
+        return;
+    }
+    stats.stored++;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string>
+
+// program binary entry points (GL 4.1 / ARB_get_program_binary), glad is
+// generated for 3.3 so they're loaded by hand like the 4.3 ones
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+extern PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC glad_glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri;
+#define glGetProgramBinary glad_glGetProgramBinary
+#define glProgramBinary glad_glProgramBinary
+#define glProgramParameteri glad_glProgramParameteri
+
+// linked programs saved to disk so the next launch skips compiling. one
+// file per shader (variants have their own names), holding a hash of
+// everything that went into it: the sources as compiled (defines and
+// version header included) and the driver's vendor, renderer and version.
+// a file whose hash doesn't match is stale and gets rebuilt and
+// overwritten, as does one the driver won't take back
+class ShaderCache {
+public:
+    // after gladLoadGL, with the context current. false if the driver
+    // can't hand out program binaries, everything compiles as before
+    static bool load(GLADloadproc loader);
+    static bool available;
+    static bool enabled;
+    static std::string directory; // relative to the working directory
+
+    // key for a set of sources, driver included
+    static unsigned long long key(const std::string* sources, size_t count);
+    // program from the cache into a new program object, 0 on a miss
+    static GLuint fetch(const std::string& name, unsigned long long key);
+    // call before linking a program that will be stored
+    static void prepare(GLuint program);
+    static void store(const std::string& name, unsigned long long key, GLuint program);
+
+    struct Stats {
+        unsigned int hits = 0;
+        unsigned int misses = 0;   // no file, stale or rejected
+        unsigned int stale = 0;    // sources or driver changed
+        unsigned int rejected = 0; // the driver didn't take the binary back
+        unsigned int stored = 0;
+        double buildMs = 0.0;      // every program built this run, cached or not
+    };
+    static Stats stats;
+
+private:
+    static std::string driver; // vendor, renderer, version
+    static std::string path(const std::string& name);
+};
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "tbo.h"
+
+TBO::TBO(GLenum format, GLenum use)
+    : size(0),
+    format(format),
+    use(use)
+{
+    glGenBuffers(1, &id);
+    glGenTextures(1, &texture);
+
+    // texture buffers can't be empty, give it something to point at
+    GLuint zero[4] = { 0, 0, 0, 0 };
+    upload(zero, sizeof(zero));
+
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, id);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+TBO::~TBO()
+{
+    glDeleteTextures(1, &texture);
+    glDeleteBuffers(1, &id);
+}
+
+void TBO::upload(const void* data, GLsizeiptr sz)
+{
+    glBindBuffer(GL_TEXTURE_BUFFER, id);
+    // orphan the old storage if the size changed so we don't stall on
+    // the gpu still reading last frame's data
+    if ((size_t)sz != size)
+        glBufferData(GL_TEXTURE_BUFFER, sz, data, use);
+    else
+    {
+        glBufferData(GL_TEXTURE_BUFFER, sz, NULL, use);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, sz, data);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    size = sz;
+}
+
+void TBO::bind(GLenum slot)
+{
+    glActiveTexture(slot);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+}
+
+void TBO::unbind()
+{
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <memory>
+
+// texture buffer object, a buffer that shaders can read with texelFetch
+// through a samplerBuffer. Used to get big arrays (light lists etc.) into
+// the shaders without hitting the uniform limits
+class TBO {
+public:
+    GLuint id;
+    GLuint texture;
+    size_t size;
+    const GLenum format;
+    TBO(GLenum format, GLenum use = GL_STREAM_DRAW);
+    ~TBO();
+
+    void upload(const void* data, GLsizeiptr sz);
+    void bind(GLenum slot);
+    void unbind();
+
+private:
+    const GLenum use;
+};
\ No newline at end of file
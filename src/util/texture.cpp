@@ -3,16 +3,39 @@
 #include <glm/gtc/type_ptr.hpp>
 
 Texture::Texture(ImageData image, GLenum type, GLenum scaling, GLenum repeat, glm::vec4 borderColor, std::string name)
-    : type(type),
+    : name(name),
+    type(type),
     scaling(scaling),
     repeat(repeat),
-    name(name)
+    borderColor(borderColor)
 {
     // generate texture
     glGenTextures(1, &ID);
     bind(GL_TEXTURE0);
 
     // set parameters, process texture and generate mipmaps
+    setParameters();
+    glTexImage2D(type, 0, GL_RGBA, image.width, image.height, 0, image.format, image.pixelType, image.data);
+    glGenerateMipmap(type);
+
+    // free original buffer now that opengl has it
+    freeImage(image);
+    unbind();
+}
+
+Texture::Texture(GLenum type, GLenum scaling, GLenum repeat, glm::vec4 borderColor, std::string name)
+    : ID(0),
+    name(name),
+    type(type),
+    scaling(scaling),
+    repeat(repeat),
+    borderColor(borderColor),
+    resident(false)
+{
+}
+
+void Texture::setParameters()
+{
     if (scaling == GL_LINEAR)
         glTexParameteri(type, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     else if (scaling == GL_NEAREST)
@@ -24,15 +47,24 @@ Texture::Texture(ImageData image, GLenum type, GLenum scaling, GLenum repeat, gl
     glTexParameteri(type, GL_TEXTURE_WRAP_T, repeat);
     if (repeat == GL_CLAMP_TO_BORDER)
         glTexParameterfv(type, GL_TEXTURE_BORDER_COLOR, glm::value_ptr(borderColor));
-    glTexImage2D(type, 0, GL_RGBA, image.width, image.height, 0, image.format, image.pixelType, image.data);
-    glGenerateMipmap(type);
+}
 
-    // free original buffer now that opengl has it
-    if (image.free != nullptr)
-        image.free(image.data);
-    else
-        delete (unsigned char*)image.data;
-    unbind();
+GLuint Texture::createStorage(int width, int height)
+{
+    GLuint id;
+    glGenTextures(1, &id);
+    glBindTexture(type, id);
+    setParameters();
+    glTexImage2D(type, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(type, 0);
+    return id;
+}
+
+void Texture::adopt(GLuint id)
+{
+    glDeleteTextures(1, &ID);
+    ID = id;
+    resident = true;
 }
 
 Texture::ImageData Texture::loadFromFile(const char* path, int format)
@@ -40,7 +72,8 @@ Texture::ImageData Texture::loadFromFile(const char* path, int format)
     Texture::ImageData d;
     d.pixelType = GL_UNSIGNED_BYTE;
 
-    stbi_set_flip_vertically_on_load(true);
+    // per thread flag, images can be decoded on job system workers
+    stbi_set_flip_vertically_on_load_thread(true);
     d.data = stbi_load(path, &d.width, &d.height, &d.colorChannels, format);
     if (format == 3)
         d.format = GL_RGB;
@@ -56,9 +89,9 @@ Texture::ImageData Texture::loadFromFile(const char* path, int format)
 
 Texture::Texture(unsigned int width, unsigned int height, GLenum fmt, std::string name)
     : name(name),
+    type(GL_TEXTURE_2D),
     scaling(GL_NEAREST),
-    repeat(GL_CLAMP_TO_BORDER),
-    type(GL_TEXTURE_2D)
+    repeat(GL_CLAMP_TO_BORDER)
 {
     // generate texture
     glGenTextures(1, &ID);
@@ -76,15 +109,91 @@ Texture::Texture(unsigned int width, unsigned int height, GLenum fmt, std::strin
     unbind();
 }
 
+Texture::Texture(unsigned int width, unsigned int height, unsigned int layers, GLenum fmt, std::string name)
+    : name(name),
+    type(GL_TEXTURE_2D_ARRAY),
+    scaling(GL_NEAREST),
+    repeat(GL_CLAMP_TO_BORDER)
+{
+    // generate texture
+    glGenTextures(1, &ID);
+    bind(GL_TEXTURE0);
+
+    // params, same as the single shadow buffer
+    glTexParameteri(type, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(type, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(type, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(type, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float borderColor[] = { 1.0, 1.0, 1.0, 1.0 }; // outside the map is lit
+    glTexParameterfv(type, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+    glTexImage3D(type, 0, fmt, width, height, layers, 0, fmt, GL_FLOAT, NULL);
+    unbind();
+}
+
+Texture::Texture(unsigned int width, unsigned int height, GLenum internalFmt, GLenum fmt, GLenum pixelType, std::string name)
+    : name(name),
+    type(GL_TEXTURE_2D),
+    scaling(GL_NEAREST),
+    repeat(GL_CLAMP_TO_EDGE)
+{
+    // generate texture
+    glGenTextures(1, &ID);
+    bind(GL_TEXTURE0);
+
+    // params, render targets get read back 1:1 so no filtering
+    glTexParameteri(type, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(type, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(type, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(type, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFmt, width, height, 0, fmt, pixelType, NULL);
+    unbind();
+}
+
 Texture::~Texture()
 {
     glDeleteTextures(1, &ID);
 }
 
+void Texture::freeImage(ImageData& image)
+{
+    if (!image.data)
+        return;
+    if (image.free != nullptr)
+        image.free(image.data);
+    else
+        delete (unsigned char*)image.data;
+    image.data = nullptr;
+}
+
+size_t Texture::rowBytes(const ImageData& image)
+{
+    size_t channels = image.format == GL_RGBA ? 4 : image.format == GL_RGB ? 3 : image.format == GL_RG ? 2 : 1;
+    size_t size = image.pixelType == GL_FLOAT ? 4 : 1;
+    return image.width * channels * size;
+}
+
+// 1x1 white, what a streamed texture draws with until it's resident
+static GLuint placeholder()
+{
+    static GLuint id = 0;
+    if (!id)
+    {
+        const unsigned char white[4] = { 255, 255, 255, 255 };
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    }
+    return id;
+}
+
 void Texture::bind(GLenum slot)
 {
     glActiveTexture(slot);
-    glBindTexture(type, ID);
+    glBindTexture(type, resident ? ID : placeholder());
 }
 
 void Texture::unbind()
@@ -16,6 +16,7 @@ public:
     const GLenum type;
     const GLenum scaling;
     const GLenum repeat;
+    glm::vec4 borderColor = glm::vec4(1.0f); // GL_CLAMP_TO_BORDER
 
     struct ImageData {
         int width;
@@ -28,11 +29,26 @@ public:
     };
 
     Texture(ImageData image, GLenum type, GLenum scaling, GLenum repeat, glm::vec4 borderColor = glm::vec4(1.0f), std::string name = "tex");
+    Texture(GLenum type, GLenum scaling, GLenum repeat, glm::vec4 borderColor, std::string name = "tex"); // no pixels yet, streamed in
     Texture(unsigned int width, unsigned int height, GLenum fmt, std::string name = "tex"); // shadow buffer
+    Texture(unsigned int width, unsigned int height, unsigned int layers, GLenum fmt, std::string name = "tex"); // layered shadow buffer
+    Texture(unsigned int width, unsigned int height, GLenum internalFmt, GLenum fmt, GLenum pixelType, std::string name = "tex"); // render target
     ~Texture();
 
+    // streamed textures (see TextureStreamer) are drawn with a placeholder
+    // until their pixels are in. the pixels go into a new texture object
+    // made by createStorage, which takes over (adopt) once it's complete
+    bool resident = true;
+    GLuint createStorage(int width, int height); // our sampling, level 0 allocated
+    void adopt(GLuint id); // the old object is deleted
+
     void bind(GLenum slot);
     void unbind();
 
     static ImageData loadFromFile(const char* path, int format = STBI_rgb);
+    static void freeImage(ImageData& image);
+    static size_t rowBytes(const ImageData& image);
+
+private:
+    void setParameters(); // sampling, on the bound texture
 };
\ No newline at end of file
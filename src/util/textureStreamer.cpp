@@ -0,0 +1,228 @@
+#include "textureStreamer.h"
+
+#include <util/profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = nullptr;
+
+bool TextureStreamer::persistent = false;
+
+bool TextureStreamer::load(GLADloadproc loader)
+{
+    persistent = false;
+    bool core = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4);
+    bool extension = false;
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions && !core && !extension; ++i)
+        extension = strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_buffer_storage") == 0;
+    if (!core && !extension)
+        return false;
+    glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)loader("glBufferStorage");
+    persistent = glad_glBufferStorage != nullptr;
+    return persistent;
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    for (auto& job : jobs)
+        drop(job);
+    for (auto& fence : fences)
+        if (fence)
+            glDeleteSync(fence);
+    if (buffer)
+    {
+        if (mapped)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+void TextureStreamer::drop(Job& job)
+{
+    Texture::freeImage(job.image);
+    if (job.storage)
+        glDeleteTextures(1, &job.storage);
+    job.storage = 0;
+}
+
+void TextureStreamer::upload(std::shared_ptr<Texture> texture, Texture::ImageData image)
+{
+    for (auto it = jobs.begin(); it != jobs.end(); ++it)
+        if (it->texture.lock() == texture)
+        {
+            drop(*it);
+            jobs.erase(it);
+            break;
+        }
+    if (!image.data)
+        return; // nothing decoded, stays as it is
+    jobs.push_back({ texture, image, 0, 0 });
+}
+
+void TextureStreamer::update()
+{
+    uploadedBytes = 0;
+    stallMs = 0.0;
+    if (!jobs.empty())
+    {
+        Profiler::Scope profile("texture upload");
+        step(false);
+    }
+    Profiler::get().count("texture upload bytes", (double)uploadedBytes);
+    Profiler::get().count("texture upload stall ms", stallMs);
+}
+
+void TextureStreamer::finish()
+{
+    while (!jobs.empty())
+        step(true);
+}
+
+bool TextureStreamer::step(bool wait)
+{
+    // (re)make the buffer if the budget changed, nothing can be in flight
+    if (!buffer || slotSize != bytesPerFrame)
+    {
+        for (auto& fence : fences)
+            if (fence)
+            {
+                glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, ~0ull);
+                glDeleteSync(fence);
+                fence = 0;
+            }
+        if (buffer)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+            if (mapped)
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glDeleteBuffers(1, &buffer);
+            mapped = nullptr;
+        }
+        slotSize = bytesPerFrame;
+        slot = 0;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        if (persistent)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, slotSize * SLOTS, nullptr, flags);
+            mapped = (char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, slotSize * SLOTS, flags);
+        }
+        else
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, slotSize * SLOTS, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // the gpu has to be done reading this slot from last time round
+    if (fences[slot])
+    {
+        auto start = std::chrono::steady_clock::now();
+        GLenum status = glClientWaitSync(fences[slot], wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? ~0ull : 0);
+        stallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            Profiler::get().count("texture upload slot busy");
+            return false;
+        }
+        glDeleteSync(fences[slot]);
+        fences[slot] = 0;
+    }
+
+    // work out what fits, rows at a time
+    struct Copy {
+        Job* job;
+        int row, rows;
+        size_t offset;
+    };
+    std::vector<Copy> copies;
+    size_t used = 0;
+    for (auto& job : jobs)
+    {
+        size_t rowBytes = Texture::rowBytes(job.image);
+        int rows = std::min(job.image.height - job.row, (int)((slotSize - used) / rowBytes));
+        if (rows <= 0)
+            break;
+        copies.push_back({ &job, job.row, rows, used });
+        used += rows * rowBytes;
+        if (job.row + rows < job.image.height)
+            break; // slot full
+    }
+
+    if (copies.empty() && !jobs.empty())
+    {
+        // a row bigger than a whole slot, straight from memory instead
+        Job& job = jobs.front();
+        copies.push_back({ &job, job.row, job.image.height - job.row, 0 });
+    }
+
+    // storage first, glTexImage2D would read from a bound unpack buffer
+    for (auto& c : copies)
+    {
+        std::shared_ptr<Texture> texture = c.job->texture.lock();
+        if (texture && !c.job->storage)
+            c.job->storage = texture->createStorage(c.job->image.width, c.job->image.height);
+    }
+
+    size_t base = slot * slotSize;
+    if (used)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        char* dst = mapped ? mapped + base : (char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, base, slotSize,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        for (auto& c : copies)
+        {
+            size_t rowBytes = Texture::rowBytes(c.job->image);
+            memcpy(dst + c.offset, (const char*)c.job->image.data + c.row * rowBytes, c.rows * rowBytes);
+        }
+        if (!mapped)
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+
+    // uploads from the slot, textures finish in queue order
+    size_t finished = 0, bytes = 0;
+    for (auto& c : copies)
+    {
+        Job& job = *c.job;
+        std::shared_ptr<Texture> texture = job.texture.lock();
+        if (texture)
+        {
+            const void* source = used ? (const void*)(base + c.offset)
+                : (const char*)job.image.data + c.row * Texture::rowBytes(job.image);
+            glBindTexture(GL_TEXTURE_2D, job.storage);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, c.row, job.image.width, c.rows, job.image.format, job.image.pixelType, source);
+        }
+        job.row = c.row + c.rows;
+        bytes += c.rows * Texture::rowBytes(job.image);
+        if (job.row == job.image.height)
+        {
+            if (texture)
+            {
+                glGenerateMipmap(GL_TEXTURE_2D);
+                texture->adopt(job.storage);
+                job.storage = 0;
+                completed++;
+            }
+            drop(job);
+            finished++;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    jobs.erase(jobs.begin(), jobs.begin() + finished);
+
+    if (used)
+    {
+        fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot = (slot + 1) % SLOTS;
+    }
+    uploadedBytes += bytes;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <util/texture.h>
+
+#include <glad/glad.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+// buffer storage (GL 4.4 / ARB_buffer_storage) for the persistently mapped
+// upload buffer, loaded by hand like the 4.3 entry points
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+extern PFNGLBUFFERSTORAGEPROC glad_glBufferStorage;
+#define glBufferStorage glad_glBufferStorage
+
+// streamed texture uploads
+// decoded images are copied into a pixel buffer object a few rows at a
+// time, at most bytesPerFrame a frame, and uploaded from it with
+// glTexSubImage2D so the transfer doesn't hold up the main thread. the
+// buffer is split into SLOTS parts used round robin, each fenced once its
+// uploads are issued and only written again after the fence has passed
+// (a slot that isn't free yet skips the frame rather than wait). with
+// buffer storage the buffer stays mapped, otherwise each slot is mapped
+// unsynchronized while it's filled. a texture draws with a placeholder
+// until its last rows are in and its mipmaps are built, one being
+// replaced keeps its old pixels until then
+class TextureStreamer {
+public:
+    // after gladLoadGL, with the context current. false maps per frame
+    static bool load(GLADloadproc loader);
+    static bool persistent;
+
+    ~TextureStreamer();
+
+    size_t bytesPerFrame = 4 << 20;
+    static const int SLOTS = 3;
+
+    // takes the image (freed once it's uploaded). a texture already queued
+    // starts over with the new one
+    void upload(std::shared_ptr<Texture> texture, Texture::ImageData image);
+    // main thread, once a frame
+    void update();
+    // everything queued now, waiting on the gpu when the slots are busy
+    // (benchmarks, anything that needs the pixels this frame)
+    void finish();
+    size_t pending() { return jobs.size(); }
+
+    // last update (finish adds to them)
+    size_t uploadedBytes = 0;
+    double stallMs = 0.0; // waiting on fences
+    unsigned int completed = 0; // textures made resident, ever
+
+private:
+    struct Job {
+        std::weak_ptr<Texture> texture;
+        Texture::ImageData image;
+        GLuint storage;
+        int row; // next one to copy
+    };
+    std::deque<Job> jobs;
+
+    GLuint buffer = 0;
+    size_t slotSize = 0;
+    char* mapped = nullptr; // persistent only
+    GLsync fences[SLOTS] = {};
+    int slot = 0;
+
+    // fills and issues one slot, false if it wasn't free
+    bool step(bool wait);
+    void drop(Job& job);
+};
\ No newline at end of file
@@ -27,4 +27,14 @@ void VBO::bind() {
 
 void VBO::unbind() {
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+std::vector<GLfloat> VBO::read() {
+    // copy read target so no vao's bindings are touched
+    std::vector<GLfloat> data(size / sizeof(GLfloat));
+    glBindBuffer(GL_COPY_READ_BUFFER, id);
+    if (!data.empty())
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, data.size() * sizeof(GLfloat), &data[0]);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return data;
 }
\ No newline at end of file